@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// The benchmark does not use an OpenGL loader, it calls the functions exported by the system
+// OpenGL library directly.
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glcorearb.h>
+
+// Every scenario clears the terminal itself, so the retained scenario can keep its tiles.
+#define RLH_RETAINED_MODE
+
+#ifdef RLH_BENCH_PROFILE_HOOKS
+// Count the profiling zones that are entered, so the cost of the hooks can be compared against a
+// build without them, where they expand to nothing.
+#include <stdint.h>
+uint64_t bench_profile_zones = 0;
+#define RLH_PROFILE_BEGIN(name) bench_profile_zones++
+#define RLH_PROFILE_END(name)
+#endif
+
+#define RLH_IMPLEMENTATION
+#include <rlh/roguelike.h>
@@ -0,0 +1,959 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glcorearb.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <rlh/roguelike.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef RLH_BENCH_PROFILE_HOOKS
+extern uint64_t bench_profile_zones;
+#endif
+#include <string.h>
+#include <time.h>
+
+// The size of the terminal that every scenario draws to.
+#define BENCH_TILES_WIDE 160
+#define BENCH_TILES_TALL 90
+#define BENCH_TILE_SIZE 8
+// The size of the terminal that the resize scenario switches to every other frame.
+#define BENCH_RESIZED_TILES_WIDE 120
+#define BENCH_RESIZED_TILES_TALL 68
+#define BENCH_SPRITE_COUNT 20000
+#define BENCH_RETAINED_EDITS 64
+#define BENCH_RETAINED_RESET_FRAMES 60
+#define BENCH_DEFAULT_FRAMES 300
+#define BENCH_WARMUP_FRAMES 10
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// A small deterministic random number generator so every run pushes the same tiles.
+static uint32_t rng_state = 1;
+
+static uint32_t rng_next(void)
+{
+  rng_state = rng_state * 1664525u + 1013904223u;
+  return rng_state >> 8;
+}
+
+static rlhColor_s rng_color(void)
+{
+  return RLH_COLOR((rng_next() & 0xff) / 255.0f, (rng_next() & 0xff) / 255.0f, (rng_next() & 0xff) / 255.0f, 1.0f);
+}
+
+// An offscreen OpenGL 3.3 core context that does not need a window system.
+static EGLDisplay egl_display = EGL_NO_DISPLAY;
+static EGLContext egl_context = EGL_NO_CONTEXT;
+static GLuint offscreen_framebuffer = 0;
+static GLuint offscreen_renderbuffer = 0;
+
+static int create_offscreen_context(const int width, const int height)
+{
+  PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (get_platform_display != NULL)
+  {
+    egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+  }
+  if (egl_display == EGL_NO_DISPLAY)
+  {
+    egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+  EGLint major, minor;
+  if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor))
+  {
+    printf("failed to initialize EGL!\n");
+    return 0;
+  }
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    printf("EGL does not support OpenGL!\n");
+    return 0;
+  }
+  const EGLint context_attributes[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 3,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+  egl_context = eglCreateContext(egl_display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attributes);
+  if (egl_context == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context))
+  {
+    printf("failed to create a surfaceless OpenGL 3.3 context!\n");
+    return 0;
+  }
+  // there is no default framebuffer without a surface, so render to a renderbuffer instead
+  glGenFramebuffers(1, &offscreen_framebuffer);
+  glGenRenderbuffers(1, &offscreen_renderbuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, offscreen_renderbuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+  glBindFramebuffer(GL_FRAMEBUFFER, offscreen_framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreen_renderbuffer);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+  {
+    printf("failed to create the offscreen framebuffer!\n");
+    return 0;
+  }
+  printf("renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+  return 1;
+}
+
+static void destroy_offscreen_context(void)
+{
+  if (egl_context != EGL_NO_CONTEXT)
+  {
+    glDeleteFramebuffers(1, &offscreen_framebuffer);
+    glDeleteRenderbuffers(1, &offscreen_renderbuffer);
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(egl_display, egl_context);
+  }
+  if (egl_display != EGL_NO_DISPLAY)
+  {
+    eglTerminate(egl_display);
+  }
+}
+
+// A 16x16 glyph atlas with a different pattern in every glyph, so no external image is needed.
+#define ATLAS_GLYPHS_WIDE 16
+#define ATLAS_SIZE (ATLAS_GLYPHS_WIDE * BENCH_TILE_SIZE)
+
+static uint8_t atlas_pixels[ATLAS_SIZE * ATLAS_SIZE * 4];
+static float atlas_stpqp[ATLAS_GLYPHS_WIDE * ATLAS_GLYPHS_WIDE * 5];
+
+static void make_atlas(rlhAtlasCreateInfo_t *atlas_info)
+{
+  for (int y = 0; y < ATLAS_SIZE; y++)
+  {
+    for (int x = 0; x < ATLAS_SIZE; x++)
+    {
+      const int glyph = (y / BENCH_TILE_SIZE) * ATLAS_GLYPHS_WIDE + (x / BENCH_TILE_SIZE);
+      const uint8_t on = ((x * 7 + y * 3 + glyph) % 5) < 2 ? 255 : 0;
+      uint8_t *pixel = &atlas_pixels[(y * ATLAS_SIZE + x) * 4];
+      pixel[0] = pixel[1] = pixel[2] = 255;
+      pixel[3] = on;
+    }
+  }
+  const float uv_tile_size = 1.0f / ATLAS_GLYPHS_WIDE;
+  size_t i = 0;
+  for (int y = 0; y < ATLAS_GLYPHS_WIDE; y++)
+  {
+    for (int x = 0; x < ATLAS_GLYPHS_WIDE; x++)
+    {
+      atlas_stpqp[i++] = uv_tile_size * x;
+      atlas_stpqp[i++] = uv_tile_size * x + uv_tile_size;
+      atlas_stpqp[i++] = uv_tile_size * y;
+      atlas_stpqp[i++] = uv_tile_size * y + uv_tile_size;
+      atlas_stpqp[i++] = 0;
+    }
+  }
+  memset(atlas_info, 0, sizeof(rlhAtlasCreateInfo_t));
+  atlas_info->width = ATLAS_SIZE;
+  atlas_info->height = ATLAS_SIZE;
+  atlas_info->pages = 1;
+  atlas_info->channel_size = 1;
+  atlas_info->color = RLH_COLOR_RGBA;
+  atlas_info->pixel_data = atlas_pixels;
+  atlas_info->glyph_count = ATLAS_GLYPHS_WIDE * ATLAS_GLYPHS_WIDE;
+  atlas_info->glyph_stpqp = atlas_stpqp;
+}
+
+static void make_size_info(rlhTermSizeInfo_t *size_info, const int tiles_wide, const int tiles_tall)
+{
+  memset(size_info, 0, sizeof(rlhTermSizeInfo_t));
+  size_info->width = tiles_wide;
+  size_info->height = tiles_tall;
+  size_info->size_mode = RLH_SIZE_TILES;
+  size_info->pixel_scale = 1;
+  size_info->tile_width = BENCH_TILE_SIZE;
+  size_info->tile_height = BENCH_TILE_SIZE;
+}
+
+// Each scenario pushes the tiles of one frame. Its ns/tile is the time it took divided by the tiles
+// it pushed, culled or masked, as counted by the terminal's stats, so a text or an image pushed with
+// one call is measured per tile.
+typedef void (*scenario_frame_f)(rlhTerm_h term, const int frame);
+
+static void push_full_grid(rlhTerm_h term)
+{
+  int tiles_wide, tiles_tall;
+  rlhTermGetTerminalSize(term, &tiles_wide, &tiles_tall);
+  for (int y = 0; y < tiles_tall; y++)
+  {
+    for (int x = 0; x < tiles_wide; x++)
+    {
+      rlhTermPushGrid(term, x, y, (rlhglyph_t)((x + y) & 0xff), RLH_WHITE, RLH_NAVY);
+    }
+  }
+}
+
+static void scenario_grid(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  rlhTermClearTileData(term);
+  push_full_grid(term);
+}
+
+static void scenario_grid8(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  rlhTermClearTileData(term);
+  int tiles_wide, tiles_tall;
+  rlhTermGetTerminalSize(term, &tiles_wide, &tiles_tall);
+  const rlhColor8_s fg = RLH_COLOR8(255, 255, 255, 255);
+  const rlhColor8_s bg = RLH_COLOR8(0, 0, 128, 255);
+  for (int y = 0; y < tiles_tall; y++)
+  {
+    for (int x = 0; x < tiles_wide; x++)
+    {
+      rlhTermPushGrid8(term, x, y, (rlhglyph_t)((x + y) & 0xff), fg, bg);
+    }
+  }
+}
+
+static rlhGridTile8_s grid_batch[BENCH_TILES_WIDE * BENCH_TILES_TALL];
+
+static void scenario_grid_batch8(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  rlhTermClearTileData(term);
+  size_t i = 0;
+  for (int y = 0; y < BENCH_TILES_TALL; y++)
+  {
+    for (int x = 0; x < BENCH_TILES_WIDE; x++)
+    {
+      grid_batch[i].grid_x = x;
+      grid_batch[i].grid_y = y;
+      grid_batch[i].glyph = (rlhglyph_t)((x + y) & 0xff);
+      grid_batch[i].fg = RLH_COLOR8(255, 255, 255, 255);
+      grid_batch[i].bg = RLH_COLOR8(0, 0, 128, 255);
+      i++;
+    }
+  }
+  rlhTermPushGridBatch8(term, grid_batch, i);
+}
+
+static void scenario_sprites(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  rlhTermClearTileData(term);
+  rng_state = 1;
+  for (int i = 0; i < BENCH_SPRITE_COUNT; i++)
+  {
+    const int x = (int)(rng_next() % (BENCH_TILES_WIDE * BENCH_TILE_SIZE + 32)) - 16;
+    const int y = (int)(rng_next() % (BENCH_TILES_TALL * BENCH_TILE_SIZE + 32)) - 16;
+    const int size = BENCH_TILE_SIZE / 2 + (int)(rng_next() % (BENCH_TILE_SIZE * 3));
+    rlhTermPushFreeSized(term, x, y, size, size, (rlhglyph_t)(rng_next() & 0xff), rng_color(), RLH_TRANSPARENT);
+  }
+}
+
+// The picking scenario pushes the sprites in pick mode, tagging each one, then picks under a mouse
+// that sweeps across the terminal.
+#define BENCH_PICKS_PER_FRAME 1024
+static void scenario_picking(rlhTerm_h term, const int frame)
+{
+  if (frame == 0)
+  {
+    rlhTermSetPickMode(term, RLH_TRUE);
+  }
+  rlhTermClearTileData(term);
+  rng_state = 1;
+  for (int i = 0; i < BENCH_SPRITE_COUNT; i++)
+  {
+    const int x = (int)(rng_next() % (BENCH_TILES_WIDE * BENCH_TILE_SIZE + 32)) - 16;
+    const int y = (int)(rng_next() % (BENCH_TILES_TALL * BENCH_TILE_SIZE + 32)) - 16;
+    const int size = BENCH_TILE_SIZE / 2 + (int)(rng_next() % (BENCH_TILE_SIZE * 3));
+    rlhTermSetPickTag(term, (uint32_t)i);
+    rlhTermPushFreeSized(term, x, y, size, size, (rlhglyph_t)(rng_next() & 0xff), rng_color(), RLH_TRANSPARENT);
+  }
+  for (int i = 0; i < BENCH_PICKS_PER_FRAME; i++)
+  {
+    rlhbool_t found = RLH_FALSE;
+    uint32_t tag = 0;
+    rlhTermPick(term, (frame * 7 + i * 13) % (BENCH_TILES_WIDE * BENCH_TILE_SIZE),
+                (frame * 3 + i * 5) % (BENCH_TILES_TALL * BENCH_TILE_SIZE), &found, NULL, &tag);
+  }
+}
+
+static void scenario_fill_overlays(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  rlhTermClearTileData(term);
+  rng_state = 1;
+  rlhTermPushFill(term, 0, RLH_TRANSPARENT, RLH_BLACK);
+  // a sparse map layer over the background
+  for (int y = 0; y < BENCH_TILES_TALL; y++)
+  {
+    for (int x = 0; x < BENCH_TILES_WIDE; x++)
+    {
+      if ((rng_next() & 7) == 0)
+      {
+        rlhTermPushGrid(term, x, y, (rlhglyph_t)(rng_next() & 0xff), rng_color(), RLH_TRANSPARENT);
+      }
+    }
+  }
+  // panels drawn on top of the map
+  for (int y = 0; y < 20; y++)
+  {
+    for (int x = 0; x < 60; x++)
+    {
+      rlhTermPushGrid(term, x + 4, y + 4, 0xdb, RLH_GRAY, RLH_BLACK);
+    }
+  }
+  for (int i = 0; i < 16; i++)
+  {
+    rlhTermPushGridSized(term, 80 + i * 4, 40, BENCH_TILE_SIZE * 3, BENCH_TILE_SIZE * 3, 1, RLH_YELLOW, RLH_TRANSPARENT);
+  }
+}
+
+// The rect panels scenario is fill_overlays with its panel pushed as one rect.
+static void scenario_rect_panels(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  rlhTermClearTileData(term);
+  rng_state = 1;
+  rlhTermPushFill(term, 0, RLH_TRANSPARENT, RLH_BLACK);
+  for (int y = 0; y < BENCH_TILES_TALL; y++)
+  {
+    for (int x = 0; x < BENCH_TILES_WIDE; x++)
+    {
+      if ((rng_next() & 7) == 0)
+      {
+        rlhTermPushGrid(term, x, y, (rlhglyph_t)(rng_next() & 0xff), rng_color(), RLH_TRANSPARENT);
+      }
+    }
+  }
+  rlhTermPushRect(term, 4, 4, 60, 20, 0xdb, RLH_GRAY, RLH_BLACK);
+  for (int i = 0; i < 16; i++)
+  {
+    rlhTermPushGridSized(term, 80 + i * 4, 40, BENCH_TILE_SIZE * 3, BENCH_TILE_SIZE * 3, 1, RLH_YELLOW, RLH_TRANSPARENT);
+  }
+}
+
+// The text scenario pushes a wrapped dialog box and a column of labels every frame, which are laid
+// out once and then pushed from the text cache.
+static void scenario_text(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  static const char *const DIALOG =
+      "The {fg=ffff00}old wizard{/} looks up from his book. \"You are late. The {fg=ff4040}dragon{/} "
+      "woke at dawn, and the bridge over the {fg=4080ff}river{/} is already burning. Take this "
+      "{bg=404040}scroll{/} and run north until you reach the tower. Do not stop for anything.\"";
+  rlhTermClearTileData(term);
+  rlhTermPushFill(term, 0, RLH_TRANSPARENT, RLH_BLACK);
+  rlhTextInfo_t text_info;
+  memset(&text_info, 0, sizeof(rlhTextInfo_t));
+  text_info.grid_x = 20;
+  text_info.grid_y = 10;
+  text_info.grid_width = 40;
+  text_info.grid_height = 12;
+  text_info.wrap = RLH_TRUE;
+  text_info.halign = RLH_HALIGN_LEFT;
+  text_info.valign = RLH_VALIGN_TOP;
+  text_info.fg = RLH_COLOR8(255, 255, 255, 255);
+  text_info.bg = RLH_COLOR8(0, 0, 128, 255);
+  rlhTermPushText(term, &text_info, DIALOG);
+  static const char *const LABELS[] = {"Health", "Mana", "Stamina", "Gold", "Depth", "Turn"};
+  text_info.grid_x = 2;
+  text_info.grid_width = 12;
+  text_info.grid_height = 1;
+  text_info.halign = RLH_HALIGN_RIGHT;
+  for (int i = 0; i < 6; i++)
+  {
+    text_info.grid_y = 2 + i;
+    rlhTermPushText(term, &text_info, LABELS[i]);
+  }
+}
+
+// The scrollback scenario adds a message every few frames to a log of a few thousand lines, and
+// scrolls back and forth through it.
+static rlhScrollback_h bench_scrollback = NULL;
+
+static void scenario_scrollback(rlhTerm_h term, const int frame)
+{
+  static const char *const MESSAGES[] = {
+      "You hit the {fg=ff8000}goblin{/}.",
+      "The goblin misses you.",
+      "You hear the sound of {fg=4080ff}rushing water{/} somewhere to the east.",
+      "{fg=ff4040}You are bleeding!{/}",
+      "You pick up 12 gold pieces."};
+  if (frame == 0)
+  {
+    rlhScrollbackDestroy(bench_scrollback);
+    bench_scrollback = NULL;
+    rlhScrollbackCreateInfo_t scrollback_info;
+    memset(&scrollback_info, 0, sizeof(rlhScrollbackCreateInfo_t));
+    scrollback_info.line_width = BENCH_TILES_WIDE;
+    scrollback_info.line_capacity = 4096;
+    if (rlhScrollbackCreate(&scrollback_info, &bench_scrollback) != RLH_RESULT_OK)
+    {
+      return;
+    }
+    for (int i = 0; i < 4096; i++)
+    {
+      rlhScrollbackAdd(bench_scrollback, MESSAGES[i % 5], RLH_COLOR8(255, 255, 255, 255), RLH_COLOR8(0, 0, 0, 255));
+    }
+  }
+  if (bench_scrollback == NULL)
+  {
+    return;
+  }
+  rlhTermClearTileData(term);
+  if (frame % 4 == 0)
+  {
+    rlhScrollbackAdd(bench_scrollback, MESSAGES[frame % 5], RLH_COLOR8(255, 255, 255, 255), RLH_COLOR8(0, 0, 0, 255));
+  }
+  const size_t scroll = (size_t)(frame % 240 < 120 ? frame % 120 : 120 - frame % 120);
+  rlhTermPushScrollback(term, bench_scrollback, 0, 0, BENCH_TILES_TALL, scroll);
+}
+
+// The image scenario converts a title screen sized image into quadrant glyphs every frame, which
+// fills the whole terminal with one push.
+#define BENCH_IMAGE_WIDTH (BENCH_TILES_WIDE * 2)
+#define BENCH_IMAGE_HEIGHT (BENCH_TILES_TALL * 2)
+static rlhColor8_s bench_image[BENCH_IMAGE_WIDTH * BENCH_IMAGE_HEIGHT];
+
+static void scenario_image(rlhTerm_h term, const int frame)
+{
+  if (frame == 0)
+  {
+    // gradients with a hard edged disc and stripes, so cells get every kind of split
+    for (int y = 0; y < BENCH_IMAGE_HEIGHT; y++)
+    {
+      for (int x = 0; x < BENCH_IMAGE_WIDTH; x++)
+      {
+        rlhColor8_s *const pixel = &bench_image[y * BENCH_IMAGE_WIDTH + x];
+        const int dx = x - BENCH_IMAGE_WIDTH / 2;
+        const int dy = y - BENCH_IMAGE_HEIGHT / 2;
+        const int inside = dx * dx + dy * dy < (BENCH_IMAGE_HEIGHT / 3) * (BENCH_IMAGE_HEIGHT / 3);
+        pixel->r = (uint8_t)(x * 255 / BENCH_IMAGE_WIDTH);
+        pixel->g = (uint8_t)(y * 255 / BENCH_IMAGE_HEIGHT);
+        pixel->b = inside ? 255 : (uint8_t)((x / 3 + y / 5) % 2 * 160);
+        pixel->a = 255;
+      }
+    }
+  }
+  rlhImageMapping_t mapping;
+  memset(&mapping, 0, sizeof(rlhImageMapping_t));
+  mapping.mode = RLH_IMAGE_QUADRANTS;
+  for (int i = 0; i < 16; i++)
+  {
+    mapping.glyphs[i] = (rlhglyph_t)(176 + i);
+  }
+  rlhTermClearTileData(term);
+  rlhTermPushImage(term, 0, 0, bench_image, BENCH_IMAGE_WIDTH, BENCH_IMAGE_HEIGHT, &mapping);
+}
+
+static void scenario_retained(rlhTerm_h term, const int frame)
+{
+  // rebuild the retained tiles from scratch every so often, otherwise only push the edits
+  if (frame % BENCH_RETAINED_RESET_FRAMES == 0)
+  {
+    rlhTermClearTileData(term);
+    push_full_grid(term);
+    return;
+  }
+  rng_state = (uint32_t)frame;
+  for (int i = 0; i < BENCH_RETAINED_EDITS; i++)
+  {
+    const int x = (int)(rng_next() % BENCH_TILES_WIDE);
+    const int y = (int)(rng_next() % BENCH_TILES_TALL);
+    rlhTermPushGrid(term, x, y, (rlhglyph_t)(rng_next() & 0xff), rng_color(), RLH_BLACK);
+  }
+}
+
+// The palette scenario pushes its tiles once, then fades the whole terminal by editing the palette.
+static rlhColor8_s palette_colors[RLH_PALETTE_SIZE];
+
+static void scenario_palette_fade(rlhTerm_h term, const int frame)
+{
+  if (frame == 0)
+  {
+    rlhTermSetPaletteMode(term, RLH_TRUE);
+    rlhTermClearTileData(term);
+    int tiles_wide, tiles_tall;
+    rlhTermGetTerminalSize(term, &tiles_wide, &tiles_tall);
+    for (int y = 0; y < tiles_tall; y++)
+    {
+      for (int x = 0; x < tiles_wide; x++)
+      {
+        rlhTermPushGrid8(term, x, y, (rlhglyph_t)((x + y) & 0xff), RLH_PALETTE_INDEX((uint8_t)(x + y)), RLH_PALETTE_INDEX(0));
+      }
+    }
+  }
+  const int brightness = 255 - (frame & 0xff);
+  for (int i = 0; i < RLH_PALETTE_SIZE; i++)
+  {
+    palette_colors[i] = RLH_COLOR8((uint8_t)(i * brightness / 255), (uint8_t)brightness, (uint8_t)((255 - i) * brightness / 255), 255);
+  }
+  rlhTermSetPalette(term, 0, RLH_PALETTE_SIZE, palette_colors);
+}
+
+// The animated scenario pushes its tiles once, then only moves the animation time forward.
+static void scenario_animated(rlhTerm_h term, const int frame)
+{
+  if (frame == 0)
+  {
+    rlhAnimationInfo_t animation_info;
+    memset(&animation_info, 0, sizeof(animation_info));
+    animation_info.base_glyph = 176;
+    animation_info.frame_count = 3;
+    animation_info.frame_duration = 0.25f;
+    animation_info.fg = RLH_COLOR8(255, 255, 0, 255);
+    animation_info.bg = RLH_COLOR8(0, 0, 128, 255);
+    animation_info.color_period = 2.0f;
+    rlhTermSetAnimation(term, 1, &animation_info);
+    rlhTermClearTileData(term);
+    int tiles_wide, tiles_tall;
+    rlhTermGetTerminalSize(term, &tiles_wide, &tiles_tall);
+    for (int y = 0; y < tiles_tall; y++)
+    {
+      for (int x = 0; x < tiles_wide; x++)
+      {
+        rlhTermPushGridAnimated8(term, x, y, 1, RLH_COLOR8(255, 255, 255, 255), RLH_COLOR8(0, 0, 0, 255));
+      }
+    }
+  }
+  rlhTermSetAnimationTime(term, frame / 60.0);
+}
+
+// The moving scenario pushes its sprites once per simulation tick, stepping each one a cell, and
+// only moves the motion alpha forward on the frames between ticks.
+#define BENCH_TICK_FRAMES 4
+static void scenario_moving(rlhTerm_h term, const int frame)
+{
+  const int tick = frame / BENCH_TICK_FRAMES;
+  if (frame % BENCH_TICK_FRAMES == 0)
+  {
+    rlhTermClearTileData(term);
+    rng_state = 1;
+    for (int i = 0; i < BENCH_SPRITE_COUNT; i++)
+    {
+      const int start_x = (int)(rng_next() % BENCH_TILES_WIDE);
+      const int y = (int)(rng_next() % BENCH_TILES_TALL);
+      const rlhColor8_s fg = rlhColorToColor8(rng_color());
+      const int x = (start_x + tick) % BENCH_TILES_WIDE;
+      const int from_x = x == 0 ? 0 : x - 1;
+      rlhTermPushGridMoving8(term, from_x, y, x, y, (rlhglyph_t)(rng_next() & 0xff), fg, RLH_COLOR8(0, 0, 0, 0));
+    }
+  }
+  rlhTermSetMotionAlpha(term, (float)(frame % BENCH_TICK_FRAMES + 1) / BENCH_TICK_FRAMES);
+}
+
+// The particles scenario keeps a sparse map and emits sparks from a few points every frame, which
+// the GPU moves and draws without any tiles being pushed for them.
+#define BENCH_PARTICLE_CAPACITY 65536
+#define BENCH_PARTICLES_PER_FRAME 1024
+static void scenario_particles(rlhTerm_h term, const int frame)
+{
+  if (frame == 0)
+  {
+    rlhTermSetParticleCapacity(term, BENCH_PARTICLE_CAPACITY);
+    rlhTermClearTileData(term);
+    rng_state = 1;
+    for (int y = 0; y < BENCH_TILES_TALL; y++)
+    {
+      for (int x = 0; x < BENCH_TILES_WIDE; x++)
+      {
+        rlhTermPushGrid(term, x, y, (rlhglyph_t)(rng_next() & 0xff), rng_color(), RLH_BLACK);
+      }
+    }
+  }
+  rlhParticleEmitInfo_t emit_info;
+  memset(&emit_info, 0, sizeof(emit_info));
+  emit_info.x = (float)((frame * 37) % (BENCH_TILES_WIDE * BENCH_TILE_SIZE));
+  emit_info.y = (float)(BENCH_TILES_TALL * BENCH_TILE_SIZE / 2);
+  emit_info.spread_x = 4.0f;
+  emit_info.spread_y = 4.0f;
+  emit_info.velocity_y = -60.0f;
+  emit_info.velocity_spread_x = 60.0f;
+  emit_info.velocity_spread_y = 60.0f;
+  emit_info.acceleration_y = 90.0f;
+  emit_info.drag = 0.5f;
+  emit_info.lifetime = 1.0f;
+  emit_info.lifetime_spread = 1.0f;
+  emit_info.glyph = '*';
+  emit_info.fg = RLH_COLOR8(255, 255, 128, 255);
+  emit_info.fg_end = RLH_COLOR8(255, 0, 0, 0);
+  rlhTermEmitParticles(term, &emit_info, BENCH_PARTICLES_PER_FRAME);
+  rlhTermAdvanceParticles(term, 1.0f / 60.0f);
+}
+
+// The light map scenario pushes its tiles once, then moves a light around by only changing the light map.
+static rlhColor8_s light_map[BENCH_TILES_WIDE * BENCH_TILES_TALL];
+
+static void scenario_light_map(rlhTerm_h term, const int frame)
+{
+  if (frame == 0)
+  {
+    rlhTermClearTileData(term);
+    push_full_grid(term);
+  }
+  const int light_x = frame % BENCH_TILES_WIDE;
+  const int light_y = BENCH_TILES_TALL / 2;
+  for (int y = 0; y < BENCH_TILES_TALL; y++)
+  {
+    for (int x = 0; x < BENCH_TILES_WIDE; x++)
+    {
+      const int distance = abs(x - light_x) + abs(y - light_y);
+      const uint8_t light = (uint8_t)(distance < 32 ? 255 - distance * 8 : 0);
+      light_map[y * BENCH_TILES_WIDE + x] = distance < 32 ? RLH_LIGHT8(light, light, light) : RLH_LIGHT8_REMEMBERED(64, 64, 64);
+    }
+  }
+  rlhTermSetLightMap(term, light_map);
+}
+
+// The visibility scenario pushes the whole map every frame, but only a circle around the player is visible.
+static uint8_t visibility_mask[RLH_VISIBILITY_MASK_SIZE(BENCH_TILES_WIDE, BENCH_TILES_TALL)];
+
+static void scenario_visibility(rlhTerm_h term, const int frame)
+{
+  const int player_x = frame % BENCH_TILES_WIDE;
+  const int player_y = BENCH_TILES_TALL / 2;
+  memset(visibility_mask, 0, sizeof(visibility_mask));
+  for (int y = 0; y < BENCH_TILES_TALL; y++)
+  {
+    for (int x = 0; x < BENCH_TILES_WIDE; x++)
+    {
+      if ((x - player_x) * (x - player_x) + (y - player_y) * (y - player_y) < 24 * 24)
+      {
+        const size_t cell = (size_t)y * BENCH_TILES_WIDE + (size_t)x;
+        visibility_mask[cell >> 3] |= (uint8_t)(1u << (cell & 7));
+      }
+    }
+  }
+  rlhTermSetVisibilityMask(term, visibility_mask);
+  scenario_grid_batch8(term, frame);
+}
+
+// The idle scenario pushes the same map every frame in cache mode, with one tile blinking twice a second.
+static void scenario_idle(rlhTerm_h term, const int frame)
+{
+  if (frame == 0)
+  {
+    rlhTermSetCacheMode(term, RLH_TRUE);
+  }
+  scenario_grid_batch8(term, frame);
+  if ((frame / 30) & 1)
+  {
+    rlhTermPushGrid8(term, BENCH_TILES_WIDE / 2, BENCH_TILES_TALL / 2, '_', RLH_COLOR8(255, 255, 0, 255), RLH_COLOR8(0, 0, 0, 255));
+  }
+}
+
+static void scenario_resize(rlhTerm_h term, const int frame)
+{
+  rlhTermSizeInfo_t size_info;
+  if (frame & 1)
+  {
+    make_size_info(&size_info, BENCH_RESIZED_TILES_WIDE, BENCH_RESIZED_TILES_TALL);
+  }
+  else
+  {
+    make_size_info(&size_info, BENCH_TILES_WIDE, BENCH_TILES_TALL);
+  }
+  rlhTermSetSize(term, &size_info);
+  rlhTermClearTileData(term);
+  push_full_grid(term);
+}
+
+// The replay scenario plays back a recording given with --replay, starting over when it ends.
+static rlhReplay_h bench_replay = NULL;
+
+static void scenario_replay(rlhTerm_h term, const int frame)
+{
+  (void)frame;
+  rlhbool_t has_frame = RLH_FALSE;
+  if (rlhReplayNextFrame(bench_replay, term, &has_frame) == RLH_RESULT_OK && !has_frame)
+  {
+    rlhReplayRewind(bench_replay, term);
+    rlhReplayNextFrame(bench_replay, term, &has_frame);
+  }
+}
+
+typedef struct scenario_s
+{
+  const char *name;
+  scenario_frame_f frame;
+} scenario_s;
+
+static const scenario_s REPLAY_SCENARIO = {"replay", scenario_replay};
+// The path to record the first scenario run to, given with --record.
+static const char *bench_record_path = NULL;
+
+static const scenario_s SCENARIOS[] = {
+    {"grid", scenario_grid},
+    {"grid8", scenario_grid8},
+    {"grid_batch8", scenario_grid_batch8},
+    {"sprites", scenario_sprites},
+    {"picking", scenario_picking},
+    {"fill_overlays", scenario_fill_overlays},
+    {"rect_panels", scenario_rect_panels},
+    {"text", scenario_text},
+    {"scrollback", scenario_scrollback},
+    {"image", scenario_image},
+    {"retained", scenario_retained},
+    {"palette_fade", scenario_palette_fade},
+    {"animated", scenario_animated},
+    {"moving", scenario_moving},
+    {"particles", scenario_particles},
+    {"light_map", scenario_light_map},
+    {"visibility", scenario_visibility},
+    {"idle", scenario_idle},
+    {"resize", scenario_resize},
+};
+#define SCENARIO_COUNT (sizeof(SCENARIOS) / sizeof(SCENARIOS[0]))
+
+static int compare_u64(const void *a, const void *b)
+{
+  const uint64_t x = *(const uint64_t *)a;
+  const uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int run_scenario(const scenario_s *scenario, const rlhBackend_t *backend, const int frames)
+{
+  rlhAtlasCreateInfo_t atlas_info;
+  make_atlas(&atlas_info);
+  rlhTermSizeInfo_t size_info;
+  make_size_info(&size_info, BENCH_TILES_WIDE, BENCH_TILES_TALL);
+  rlhTermCreateInfo_t term_info;
+  memset(&term_info, 0, sizeof(rlhTermCreateInfo_t));
+  term_info.size_info = &size_info;
+  term_info.atlas_info = &atlas_info;
+  term_info.backend = backend;
+  term_info.record_path = bench_record_path;
+  bench_record_path = NULL;
+  rlhTerm_h term = NULL;
+  rlhresult_t result;
+  if (scenario == &REPLAY_SCENARIO)
+  {
+    result = rlhReplayCreateTerm(bench_replay, &term_info, &term);
+    if (result == RLH_RESULT_OK)
+    {
+      result = rlhReplayRewind(bench_replay, term);
+    }
+  }
+  else
+  {
+    result = rlhTermCreate(&term_info, &term);
+  }
+  if (result != RLH_RESULT_OK)
+  {
+    printf("failed to create terminal: %s\n", RLH_RESULT_DESCRIPTIONS[result]);
+    return 0;
+  }
+  const rlhbool_t gpu = backend != &RLH_BACKEND_NULL;
+  uint64_t *frame_ns = malloc(sizeof(uint64_t) * frames);
+  uint64_t push_ns = 0;
+  uint64_t tiles_drawn = 0;
+  uint64_t total_ns = 0;
+  for (int frame = -BENCH_WARMUP_FRAMES; frame < frames; frame++)
+  {
+    if (frame == 0)
+    {
+      rlhTermResetStats(term);
+#ifdef RLH_BENCH_PROFILE_HOOKS
+      bench_profile_zones = 0;
+#endif
+    }
+    const uint64_t start = now_ns();
+    scenario->frame(term, frame + BENCH_WARMUP_FRAMES);
+    const uint64_t pushed = now_ns();
+    const size_t frame_tiles = (size_t)rlhTermGetTileDataCount(term);
+    int pixel_width, pixel_height;
+    rlhTermGetScaledPixelSize(term, &pixel_width, &pixel_height);
+    if (gpu)
+    {
+      rlhViewport(0, 0, pixel_width, pixel_height);
+      rlhClearColor(RLH_BLACK);
+    }
+    rlhTermDrawAligned(term, pixel_width, pixel_height, RLH_HALIGN_LEFT, RLH_VALIGN_TOP);
+    if (gpu)
+    {
+      // wait for the GPU so the frame time includes the rendering
+      glFinish();
+    }
+    const uint64_t end = now_ns();
+    if (frame < 0)
+      continue;
+    frame_ns[frame] = end - start;
+    push_ns += pushed - start;
+    tiles_drawn += frame_tiles;
+    total_ns += end - start;
+  }
+  rlhTermStats_t stats;
+  rlhTermGetStats(term, &stats);
+  rlhTermDestroy(term);
+  // the stats were reset on the first measured frame, and only pushes count tiles
+  const uint64_t pushes = stats.tiles_pushed + stats.tiles_culled + stats.tiles_masked;
+  qsort(frame_ns, frames, sizeof(uint64_t), compare_u64);
+  const double total_seconds = total_ns / 1e9;
+  char gpu_ms[16] = "-";
+  if (stats.gpu_timed_draws > 0)
+  {
+    snprintf(gpu_ms, sizeof(gpu_ms), "%.3f", stats.gpu_ns / 1e6 / stats.gpu_timed_draws);
+  }
+  printf("%-14s %-7s %11.0f %12.0f %8.2f %13.0f %8.3f %8.3f %8.3f %8.3f %8s\n",
+         scenario->name,
+         backend->name,
+         (double)tiles_drawn / frames,
+         tiles_drawn / total_seconds,
+         pushes ? (double)push_ns / pushes : 0.0,
+         (double)stats.bytes_uploaded / frames,
+         total_ns / 1e6 / frames,
+         frame_ns[frames / 2] / 1e6,
+         frame_ns[(frames * 99) / 100] / 1e6,
+         frame_ns[frames - 1] / 1e6,
+         gpu_ms);
+#ifdef RLH_BENCH_PROFILE_HOOKS
+  printf("%-14s %-7s %11.0f profile zones/frame\n", "", "", (double)bench_profile_zones / frames);
+#endif
+  free(frame_ns);
+  return 1;
+}
+
+static void print_usage(void)
+{
+  printf("usage: rlh_bench [--backend gl33|null|all] [--scenario NAME|all] [--frames N] [--record FILE] [--replay FILE]\n");
+  printf("scenarios:");
+  for (size_t i = 0; i < SCENARIO_COUNT; i++)
+  {
+    printf(" %s", SCENARIOS[i].name);
+  }
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  const char *backend_name = "all";
+  const char *scenario_name = "all";
+  int frames = BENCH_DEFAULT_FRAMES;
+  const char *replay_path = NULL;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc)
+    {
+      backend_name = argv[++i];
+    }
+    else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+    {
+      scenario_name = argv[++i];
+    }
+    else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+    {
+      frames = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+    {
+      bench_record_path = argv[++i];
+    }
+    else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+    {
+      replay_path = argv[++i];
+    }
+    else
+    {
+      print_usage();
+      return 1;
+    }
+  }
+  if (frames <= 0)
+  {
+    print_usage();
+    return 1;
+  }
+  const int run_null = strcmp(backend_name, "all") == 0 || strcmp(backend_name, "null") == 0;
+  int run_gl33 = strcmp(backend_name, "all") == 0 || strcmp(backend_name, "gl33") == 0;
+  if (!run_null && !run_gl33)
+  {
+    print_usage();
+    return 1;
+  }
+  if (replay_path != NULL)
+  {
+    const rlhresult_t result = rlhReplayOpen(replay_path, NULL, &bench_replay);
+    if (result != RLH_RESULT_OK)
+    {
+      printf("failed to open replay: %s\n", RLH_RESULT_DESCRIPTIONS[result]);
+      return 1;
+    }
+  }
+  if (run_gl33 && !create_offscreen_context(BENCH_TILES_WIDE * BENCH_TILE_SIZE, BENCH_TILES_TALL * BENCH_TILE_SIZE))
+  {
+    if (!run_null)
+    {
+      return 2;
+    }
+    printf("skipping the gl33 backend\n");
+    run_gl33 = 0;
+  }
+  if (bench_replay != NULL)
+  {
+    printf("%d frames of the recording %s\n", frames, replay_path);
+  }
+  else
+  {
+    printf("%d frames of a %dx%d terminal with %dx%d tiles\n", frames, BENCH_TILES_WIDE, BENCH_TILES_TALL, BENCH_TILE_SIZE, BENCH_TILE_SIZE);
+  }
+#ifdef RLH_BENCH_PROFILE_HOOKS
+  printf("profile hooks: counting\n");
+#else
+  printf("profile hooks: none\n");
+#endif
+  printf("%-14s %-7s %11s %12s %8s %13s %8s %8s %8s %8s %8s\n",
+         "scenario", "backend", "tiles/frame", "tiles/sec", "ns/tile", "upload B/frame",
+         "avg ms", "p50 ms", "p99 ms", "max ms", "gpu ms");
+  int ran = 0;
+  if (bench_replay != NULL)
+  {
+    ran = 1;
+    if (run_null && !run_scenario(&REPLAY_SCENARIO, &RLH_BACKEND_NULL, frames))
+      return 3;
+    if (run_gl33 && !run_scenario(&REPLAY_SCENARIO, &RLH_BACKEND_GL33, frames))
+      return 3;
+  }
+  for (size_t i = 0; bench_replay == NULL && i < SCENARIO_COUNT; i++)
+  {
+    if (strcmp(scenario_name, "all") != 0 && strcmp(scenario_name, SCENARIOS[i].name) != 0)
+      continue;
+    ran = 1;
+    if (run_null && !run_scenario(&SCENARIOS[i], &RLH_BACKEND_NULL, frames))
+      return 3;
+    if (run_gl33 && !run_scenario(&SCENARIOS[i], &RLH_BACKEND_GL33, frames))
+      return 3;
+  }
+  destroy_offscreen_context();
+  rlhReplayClose(bench_replay);
+  if (!ran)
+  {
+    print_usage();
+    return 1;
+  }
+  return 0;
+}
@@ -201,6 +201,7 @@ int main()
   size_info.tile_height = i_height / sheet_sprite_dimensions;
   // create the term info
   rlhTermCreateInfo_t term_info;
+  memset(&term_info, 0, sizeof(rlhTermCreateInfo_t));
   term_info.atlas_info = &atlas_info;
   term_info.size_info = &size_info;
   // create the terminal
@@ -259,22 +260,17 @@ int main()
 
     // print some text to the screen
     // this is easy to do because CP437 glyphs for characters collide with ascii character codes
-    const size_t label_x = 18;
-    const char *label_1 = "roguelike.h";
-    const size_t label_1_y = 20;
-    const size_t label_1_length = strlen(label_1);
-    for (size_t x = 0; x < label_1_length; x++)
-    {
-      rlhTermPushGrid(t, x + label_x, label_1_y, label_1[x], RLH_NAVY, RLH_YELLOW);
-    }
-
-    const char *label_2 = "by journeyman";
-    const size_t label_2_y = label_1_y + 1;
-    const size_t label_2_length = strlen(label_2);
-    for (size_t x = 0; x < label_2_length; x++)
-    {
-      rlhTermPushGrid(t, x + label_x, label_2_y, label_2[x], RLH_RED, RLH_GREEN);
-    }
+    rlhTextInfo_t label_info;
+    memset(&label_info, 0, sizeof(rlhTextInfo_t));
+    label_info.grid_x = 18;
+    label_info.grid_y = 20;
+    label_info.grid_width = 13;
+    label_info.grid_height = 2;
+    label_info.halign = RLH_HALIGN_LEFT;
+    label_info.valign = RLH_VALIGN_TOP;
+    label_info.fg = rlhColorToColor8(RLH_NAVY);
+    label_info.bg = rlhColorToColor8(RLH_YELLOW);
+    rlhTermPushText(t, &label_info, "roguelike.h\n{fg=ff0000}{bg=008000}by journeyman");
 
     // get the current window size
     glfwGetFramebufferSize(window, &w_width, &w_height);
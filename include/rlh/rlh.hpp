@@ -0,0 +1,524 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+    rlh.hpp
+    C++17 wrapper for roguelike.h.
+
+    This header only declares inline wrappers around the C functions of roguelike.h, so the
+    implementation still has to be compiled once, by defining RLH_IMPLEMENTATION before including
+    roguelike.h in one C or C++ source file, like the "HOW TO SETUP" section of roguelike.h explains.
+
+    rlh::Terminal<> owns a terminal handle and destroys it when it goes out of scope. It can be moved
+    but not copied. Like the C functions, its functions return result codes instead of throwing, so
+    it can be used in projects that disable exceptions:
+
+        rlh::Terminal<> term;
+        rlhresult_t result = rlh::Terminal<>::create(term_info, term);
+
+    If every terminal of a project uses the same tile size and pixel scale, give them as template
+    arguments, like rlh::Terminal<8, 8, 2>. Creating the terminal or setting its size then fails with
+    RLH_RESULT_ERROR_INVALID_VALUE if the size info asks for anything else, and free pushes without a
+    size are pushed with that tile size. Every push still calls the C functions of roguelike.h, which
+    do the pixel math, bounds checks and visibility mask at run time, so the template arguments do
+    not make pushes any faster.
+
+    rlh::makeGridStpqp() builds the glyph coordinates of an atlas made of a uniform grid of glyphs at
+    compile time:
+
+        static constexpr auto stpqp = rlh::makeGridStpqp<16, 16>();
+        atlas_info.glyph_stpqp = stpqp.data();
+        atlas_info.glyph_count = rlh::GRID_GLYPH_COUNT<16, 16>;
+
+    When compiled as C++20, the batch push and palette functions also take std::span.
+*/
+
+#ifndef RLH_HPP
+#define RLH_HPP
+#include "roguelike.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define RLH_HPP_SPAN
+#endif
+
+namespace rlh
+{
+  // The amount of floats that describe where one glyph is in an atlas.
+  inline constexpr std::size_t COORDINATES_PER_GLYPH = 5;
+
+  // The amount of glyphs in an atlas that is a grid of glyphs_wide by glyphs_tall glyphs on each page.
+  template <int GlyphsWide, int GlyphsTall, int Pages = 1>
+  inline constexpr int GRID_GLYPH_COUNT = GlyphsWide * GlyphsTall * Pages;
+
+  // Make the stpqp coordinates of an atlas that is a grid of glyphs_wide by glyphs_tall glyphs on
+  // each page. Glyphs are ordered left to right, then top to bottom, then page by page.
+  template <int GlyphsWide, int GlyphsTall, int Pages = 1>
+  constexpr std::array<float, GRID_GLYPH_COUNT<GlyphsWide, GlyphsTall, Pages> * COORDINATES_PER_GLYPH> makeGridStpqp() noexcept
+  {
+    static_assert(GlyphsWide > 0 && GlyphsTall > 0 && Pages > 0, "an atlas grid needs at least one glyph");
+    std::array<float, GRID_GLYPH_COUNT<GlyphsWide, GlyphsTall, Pages> * COORDINATES_PER_GLYPH> stpqp{};
+    std::size_t i = 0;
+    for (int page = 0; page < Pages; page++)
+    {
+      for (int y = 0; y < GlyphsTall; y++)
+      {
+        for (int x = 0; x < GlyphsWide; x++)
+        {
+          stpqp[i++] = (float)x / (float)GlyphsWide;       // the s coordinate (left x)
+          stpqp[i++] = (float)(x + 1) / (float)GlyphsWide; // the t coordinate (right x)
+          stpqp[i++] = (float)y / (float)GlyphsTall;       // the p coordinate (top y)
+          stpqp[i++] = (float)(y + 1) / (float)GlyphsTall; // the q coordinate (bottom y)
+          stpqp[i++] = (float)page;                        // the 2nd p coordinate (texture page id)
+        }
+      }
+    }
+    return stpqp;
+  }
+
+  // A terminal that destroys itself when it goes out of scope. When the template arguments are not
+  // 0, the terminal always has tiles of that size and that pixel scale.
+  template <int TileWidth = 0, int TileHeight = 0, int PixelScale = 0>
+  class Terminal
+  {
+    static_assert(TileWidth >= 0 && TileHeight >= 0 && PixelScale >= 0, "tile sizes and pixel scales can not be negative");
+    static_assert((TileWidth == 0) == (TileHeight == 0) && (TileWidth == 0) == (PixelScale == 0),
+                  "give either all of the tile width, tile height and pixel scale, or none of them");
+
+  public:
+    // If the tile size and pixel scale are constants.
+    static constexpr bool IS_FIXED = TileWidth != 0;
+
+    Terminal() noexcept = default;
+    // Take ownership of a terminal handle.
+    explicit Terminal(rlhTerm_h const term) noexcept
+        : term(term)
+    {
+    }
+    Terminal(const Terminal &) = delete;
+    Terminal &operator=(const Terminal &) = delete;
+    Terminal(Terminal &&other) noexcept
+        : term(std::exchange(other.term, nullptr))
+    {
+    }
+    Terminal &operator=(Terminal &&other) noexcept
+    {
+      if (this != &other)
+      {
+        reset(std::exchange(other.term, nullptr));
+      }
+      return *this;
+    }
+    ~Terminal()
+    {
+      reset();
+    }
+
+    // Create a terminal and give it to terminal, destroying the terminal it had before.
+    static rlhresult_t create(rlhTermCreateInfo_t &term_info, Terminal &terminal) noexcept
+    {
+      if constexpr (IS_FIXED)
+      {
+        if (term_info.size_info == nullptr)
+        {
+          return RLH_RESULT_ERROR_NULL_ARGUMENT;
+        }
+        if (!isFixedSize(*term_info.size_info))
+        {
+          return RLH_RESULT_ERROR_INVALID_VALUE;
+        }
+      }
+      rlhTerm_h created_term = nullptr;
+      const rlhresult_t result = rlhTermCreate(&term_info, &created_term);
+      if (result == RLH_RESULT_OK)
+      {
+        terminal.reset(created_term);
+      }
+      return result;
+    }
+
+    // Get the handle of the terminal, which is still owned by this object.
+    rlhTerm_h get() const noexcept
+    {
+      return term;
+    }
+    // Give up ownership of the terminal handle without destroying it.
+    rlhTerm_h release() noexcept
+    {
+      return std::exchange(term, nullptr);
+    }
+    // Destroy the terminal and take ownership of another terminal handle, which can be null.
+    void reset(rlhTerm_h const new_term = nullptr) noexcept
+    {
+      rlhTerm_h const old_term = std::exchange(term, new_term);
+      if (old_term != nullptr)
+      {
+        rlhTermDestroy(old_term);
+      }
+    }
+    explicit operator bool() const noexcept
+    {
+      return term != nullptr;
+    }
+
+    rlhresult_t setAtlas(rlhAtlasCreateInfo_t &atlas_info) noexcept
+    {
+      return rlhTermSetAtlas(term, &atlas_info);
+    }
+    rlhresult_t setSize(rlhTermSizeInfo_t &size_info) noexcept
+    {
+      if constexpr (IS_FIXED)
+      {
+        if (!isFixedSize(size_info))
+        {
+          return RLH_RESULT_ERROR_INVALID_VALUE;
+        }
+      }
+      return rlhTermSetSize(term, &size_info);
+    }
+    rlhresult_t beginAtlasUpload(const rlhAtlasCreateInfo_t &atlas_info, const int pages_per_draw, void *&pixel_data) noexcept
+    {
+      return rlhTermBeginAtlasUpload(term, &atlas_info, pages_per_draw, &pixel_data);
+    }
+    rlhresult_t endAtlasUpload() noexcept
+    {
+      return rlhTermEndAtlasUpload(term);
+    }
+    rlhatlasupload_t getAtlasUploadState() const noexcept
+    {
+      return rlhTermGetAtlasUploadState(term);
+    }
+    int getGlyphCount() const noexcept
+    {
+      return rlhTermGetGlyphCount(term);
+    }
+    float getPixelScale() const noexcept
+    {
+      if constexpr (IS_FIXED)
+      {
+        return (float)PixelScale;
+      }
+      else
+      {
+        return rlhTermGetPixelScale(term);
+      }
+    }
+    void getTerminalSize(int &tiles_wide, int &tiles_tall) const noexcept
+    {
+      rlhTermGetTerminalSize(term, &tiles_wide, &tiles_tall);
+    }
+    void getScaledPixelSize(int &pixel_width, int &pixel_height) const noexcept
+    {
+      rlhTermGetScaledPixelSize(term, &pixel_width, &pixel_height);
+    }
+    void getUnscaledPixelSize(int &pixel_width, int &pixel_height) const noexcept
+    {
+      rlhTermGetUnscaledPixelSize(term, &pixel_width, &pixel_height);
+    }
+    void getTileSize(int &tile_width, int &tile_height) const noexcept
+    {
+      if constexpr (IS_FIXED)
+      {
+        tile_width = TileWidth;
+        tile_height = TileHeight;
+      }
+      else
+      {
+        rlhTermGetTileSize(term, &tile_width, &tile_height);
+      }
+    }
+    rlhresult_t clearTileData() noexcept
+    {
+      return rlhTermClearTileData(term);
+    }
+    int getTileDataCount() const noexcept
+    {
+      return rlhTermGetTileDataCount(term);
+    }
+
+    rlhresult_t pushFill(const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushFill8(term, glyph, fg, bg);
+    }
+    rlhresult_t pushFill(const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg) noexcept
+    {
+      return pushFill(glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+    }
+    rlhresult_t pushGrid(const int grid_x, const int grid_y, const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushGrid8(term, grid_x, grid_y, glyph, fg, bg);
+    }
+    rlhresult_t pushGrid(const int grid_x, const int grid_y, const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg) noexcept
+    {
+      return pushGrid(grid_x, grid_y, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+    }
+    rlhresult_t pushGridSized(const int grid_x, const int grid_y, const int tile_pixel_width, const int tile_pixel_height,
+                              const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushGridSized8(term, grid_x, grid_y, tile_pixel_width, tile_pixel_height, glyph, fg, bg);
+    }
+    rlhresult_t pushGridSized(const int grid_x, const int grid_y, const int tile_pixel_width, const int tile_pixel_height,
+                              const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg) noexcept
+    {
+      return pushGridSized(grid_x, grid_y, tile_pixel_width, tile_pixel_height, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+    }
+    rlhresult_t pushFree(const int screen_pixel_x, const int screen_pixel_y, const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      if constexpr (IS_FIXED)
+      {
+        return rlhTermPushFreeSized8(term, screen_pixel_x, screen_pixel_y, TileWidth, TileHeight, glyph, fg, bg);
+      }
+      else
+      {
+        return rlhTermPushFree8(term, screen_pixel_x, screen_pixel_y, glyph, fg, bg);
+      }
+    }
+    rlhresult_t pushFree(const int screen_pixel_x, const int screen_pixel_y, const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg) noexcept
+    {
+      return pushFree(screen_pixel_x, screen_pixel_y, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+    }
+    rlhresult_t pushFreeSized(const int screen_pixel_x, const int screen_pixel_y, const int tile_pixel_width, const int tile_pixel_height,
+                              const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushFreeSized8(term, screen_pixel_x, screen_pixel_y, tile_pixel_width, tile_pixel_height, glyph, fg, bg);
+    }
+    rlhresult_t pushFreeSized(const int screen_pixel_x, const int screen_pixel_y, const int tile_pixel_width, const int tile_pixel_height,
+                              const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg) noexcept
+    {
+      return pushFreeSized(screen_pixel_x, screen_pixel_y, tile_pixel_width, tile_pixel_height, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+    }
+    // Push tiles to the terminal grid straight from the given memory. Space for every tile is
+    // reserved up front, so if it does not fit none of the tiles are pushed.
+    rlhresult_t pushGridBatch(const rlhGridTile8_s *const tiles, const std::size_t tile_count) noexcept
+    {
+      return rlhTermPushGridBatch8(term, tiles, tile_count);
+    }
+#ifdef RLH_HPP_SPAN
+    rlhresult_t pushGridBatch(const std::span<const rlhGridTile8_s> tiles) noexcept
+    {
+      return rlhTermPushGridBatch8(term, tiles.data(), tiles.size());
+    }
+#endif
+    // Fill a rect of grid cells with one glyph. Where it can, the whole rect is drawn as one tile.
+    rlhresult_t pushRect(const int grid_x, const int grid_y, const int grid_width, const int grid_height,
+                         const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushRect8(term, grid_x, grid_y, grid_width, grid_height, glyph, fg, bg);
+    }
+    rlhresult_t pushRect(const int grid_x, const int grid_y, const int grid_width, const int grid_height,
+                         const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg) noexcept
+    {
+      return pushRect(grid_x, grid_y, grid_width, grid_height, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+    }
+    // Push a text laid out in the rect of text_info, with the markup described above rlhTermPushText().
+    rlhresult_t pushText(const rlhTextInfo_t &text_info, const char *const text) noexcept
+    {
+      return rlhTermPushText(term, &text_info, text);
+    }
+    // Push the lines of a scrollback that fit in grid_height rows, scrolled up by scroll lines.
+    rlhresult_t pushScrollback(rlhScrollback_h const scrollback, const int grid_x, const int grid_y, const int grid_height,
+                               const std::size_t scroll = 0) noexcept
+    {
+      return rlhTermPushScrollback(term, scrollback, grid_x, grid_y, grid_height, scroll);
+    }
+    // Push an image of width by height RGBA pixels as block glyphs, with its top left cell at a grid cell.
+    rlhresult_t pushImage(const int grid_x, const int grid_y, const rlhColor8_s *const pixels, const int width, const int height,
+                          const rlhImageMapping_t &mapping) noexcept
+    {
+      return rlhTermPushImage(term, grid_x, grid_y, pixels, width, height, &mapping);
+    }
+    rlhresult_t pushGridAnimated(const int grid_x, const int grid_y, const std::uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushGridAnimated8(term, grid_x, grid_y, animation, fg, bg);
+    }
+
+    // Pass nullptr to stop an animation.
+    rlhresult_t setAnimation(const std::uint16_t animation, const rlhAnimationInfo_t *const animation_info) noexcept
+    {
+      return rlhTermSetAnimation(term, animation, animation_info);
+    }
+    rlhresult_t setAnimation(const std::uint16_t animation, const rlhAnimationInfo_t &animation_info) noexcept
+    {
+      return rlhTermSetAnimation(term, animation, &animation_info);
+    }
+    rlhresult_t setAnimationTime(const double seconds) noexcept
+    {
+      return rlhTermSetAnimationTime(term, seconds);
+    }
+    // Push a tile that moved from one grid cell to another since the previous tick.
+    rlhresult_t pushGridMoving(const int from_grid_x, const int from_grid_y, const int grid_x, const int grid_y, const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushGridMoving8(term, from_grid_x, from_grid_y, grid_x, grid_y, glyph, fg, bg);
+    }
+    rlhresult_t pushFreeMoving(const int from_pixel_x, const int from_pixel_y, const int screen_pixel_x, const int screen_pixel_y, const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg) noexcept
+    {
+      return rlhTermPushFreeMoving8(term, from_pixel_x, from_pixel_y, screen_pixel_x, screen_pixel_y, glyph, fg, bg);
+    }
+    // How far between ticks to draw moving tiles, from 0.0 to 1.0.
+    rlhresult_t setMotionAlpha(const float alpha) noexcept
+    {
+      return rlhTermSetMotionAlpha(term, alpha);
+    }
+    // Pass 0 to free the particles.
+    rlhresult_t setParticleCapacity(const std::size_t capacity) noexcept
+    {
+      return rlhTermSetParticleCapacity(term, capacity);
+    }
+    rlhresult_t emitParticles(const rlhParticleEmitInfo_t &emit_info, const int count) noexcept
+    {
+      return rlhTermEmitParticles(term, &emit_info, count);
+    }
+    rlhresult_t advanceParticles(const float seconds) noexcept
+    {
+      return rlhTermAdvanceParticles(term, seconds);
+    }
+    rlhresult_t setPickMode(const bool enabled) noexcept
+    {
+      return rlhTermSetPickMode(term, enabled ? RLH_TRUE : RLH_FALSE);
+    }
+    rlhresult_t setPickTag(const std::uint32_t tag) noexcept
+    {
+      return rlhTermSetPickTag(term, tag);
+    }
+    rlhresult_t pick(const int pixel_x, const int pixel_y, bool &found, std::size_t *const tile_index = nullptr,
+                     std::uint32_t *const tag = nullptr) const noexcept
+    {
+      rlhbool_t c_found = RLH_FALSE;
+      const rlhresult_t result = rlhTermPick(term, pixel_x, pixel_y, &c_found, tile_index, tag);
+      found = c_found != RLH_FALSE;
+      return result;
+    }
+    // Pass nullptr to turn the light map off.
+    rlhresult_t setLightMap(const rlhColor8_s *const light_map) noexcept
+    {
+      return rlhTermSetLightMap(term, light_map);
+    }
+#ifdef RLH_HPP_SPAN
+    // Returns RLH_RESULT_ERROR_INVALID_VALUE if the span does not have a cell for every grid cell.
+    rlhresult_t setLightMap(const std::span<const rlhColor8_s> light_map) noexcept
+    {
+      int tiles_wide = 0, tiles_tall = 0;
+      rlhTermGetTerminalSize(term, &tiles_wide, &tiles_tall);
+      if (light_map.size() != static_cast<std::size_t>(tiles_wide) * static_cast<std::size_t>(tiles_tall))
+      {
+        return RLH_RESULT_ERROR_INVALID_VALUE;
+      }
+      return rlhTermSetLightMap(term, light_map.data());
+    }
+#endif
+    // Pass nullptr to remove the visibility mask.
+    rlhresult_t setVisibilityMask(const std::uint8_t *const mask) noexcept
+    {
+      return rlhTermSetVisibilityMask(term, mask);
+    }
+    rlhresult_t setCellVisible(const int grid_x, const int grid_y, const bool visible) noexcept
+    {
+      return rlhTermSetCellVisible(term, grid_x, grid_y, visible ? RLH_TRUE : RLH_FALSE);
+    }
+
+    rlhresult_t setCacheMode(const bool enabled) noexcept
+    {
+      return rlhTermSetCacheMode(term, enabled ? RLH_TRUE : RLH_FALSE);
+    }
+    rlhresult_t setLowResMode(const bool enabled) noexcept
+    {
+      return rlhTermSetLowResMode(term, enabled ? RLH_TRUE : RLH_FALSE);
+    }
+    rlhresult_t setHandoffMode(const bool enabled) noexcept
+    {
+      return rlhTermSetHandoffMode(term, enabled ? RLH_TRUE : RLH_FALSE);
+    }
+    rlhresult_t publishFrame() noexcept
+    {
+      return rlhTermPublishFrame(term);
+    }
+
+    rlhresult_t setPaletteMode(const bool enabled) noexcept
+    {
+      return rlhTermSetPaletteMode(term, enabled ? RLH_TRUE : RLH_FALSE);
+    }
+    rlhresult_t setPalette(const std::size_t first_index, const rlhColor8_s *const colors, const std::size_t color_count) noexcept
+    {
+      return rlhTermSetPalette(term, first_index, color_count, colors);
+    }
+#ifdef RLH_HPP_SPAN
+    rlhresult_t setPalette(const std::size_t first_index, const std::span<const rlhColor8_s> colors) noexcept
+    {
+      return rlhTermSetPalette(term, first_index, colors.size(), colors.data());
+    }
+#endif
+
+    rlhresult_t getStats(rlhTermStats_t &stats) const noexcept
+    {
+      return rlhTermGetStats(term, &stats);
+    }
+    rlhresult_t resetStats() noexcept
+    {
+      return rlhTermResetStats(term);
+    }
+    rlhresult_t stopRecording() noexcept
+    {
+      return rlhTermStopRecording(term);
+    }
+
+    rlhresult_t draw() noexcept
+    {
+      return rlhTermDraw(term);
+    }
+    rlhresult_t drawAligned(const int viewport_width, const int viewport_height, const rlhtermhalign_t h_align, const rlhtermvalign_t v_align) noexcept
+    {
+      return rlhTermDrawAligned(term, viewport_width, viewport_height, h_align, v_align);
+    }
+    rlhresult_t drawTranslated(const int translate_x, const int translate_y, const int viewport_width, const int viewport_height) noexcept
+    {
+      return rlhTermDrawTranslated(term, translate_x, translate_y, viewport_width, viewport_height);
+    }
+    rlhresult_t drawTransformed(const int translate_x, const int translate_y, const float scale_x, const float scale_y,
+                                const int viewport_width, const int viewport_height) noexcept
+    {
+      return rlhTermDrawTransformed(term, translate_x, translate_y, scale_x, scale_y, viewport_width, viewport_height);
+    }
+    rlhresult_t drawMatrix(const float *const matrix_4x4) noexcept
+    {
+      return rlhTermDrawMatrix(term, matrix_4x4);
+    }
+    // Pass 0 to draw into the texture of the terminal itself.
+    rlhresult_t drawToTexture(const std::uint32_t texture, std::uint32_t *const drawn_texture = nullptr) noexcept
+    {
+      return rlhTermDrawToTexture(term, texture, drawn_texture);
+    }
+
+  private:
+    static constexpr bool isFixedSize(const rlhTermSizeInfo_t &size_info) noexcept
+    {
+      return size_info.tile_width == TileWidth &&
+             size_info.tile_height == TileHeight &&
+             size_info.pixel_scale == PixelScale;
+    }
+
+    rlhTerm_h term = nullptr;
+  };
+}
+#endif
@@ -21,7 +21,7 @@
 */
 
 /*
-    roguelike.h version v2.0.0
+    roguelike.h version v2.1.0
     Header only roguelike rendering library.
     The source for this library can be found on GitHub:
     https://github.com/Journeyman-dev/roguelike.h
@@ -79,6 +79,115 @@
     be very careful! If you forget to clear the tile buffer and keep adding tiles to it over time,
     this can result in a nasty memory leak.
 
+    HOW TO MANAGE MEMORY
+    By default roguelike.h allocates memory with malloc(), realloc() and free(). To use your own
+    allocator, define all three of the macros RLH_MALLOC(size, user_data),
+    RLH_REALLOC(ptr, size, user_data) and RLH_FREE(ptr, user_data) before implementing roguelike.h.
+    The user_data argument is the allocator_user_data property of the rlhTermCreateInfo_t the
+    terminal was created with, so each terminal can allocate from a different place. Allocations made
+    by the built in backends are given a NULL user_data.
+    The tile buffer of a terminal doubles in size whenever it is full. If you set the
+    shrink_interval property of rlhTermCreateInfo_t, the terminal also remembers the most tiles it
+    held between clears, and every shrink_interval clears it gives memory back if that high water
+    mark used less than a quarter of the tile buffer. This keeps a single frame with a lot of tiles
+    from holding on to memory forever.
+    If you want the tile buffer to never allocate after the terminal is created, set the
+    tile_arena_size property of rlhTermCreateInfo_t. The tile buffer is then a fixed region that is
+    reset every time the tile data is cleared, and pushes that do not fit in it return
+    RLH_RESULT_ERROR_OUT_OF_MEMORY. The region can be memory you own, like a block of a frame
+    allocator, by setting the tile_arena property, or it is allocated once when the terminal is
+    created.
+
+    HOW TO PUSH TILES FROM ANOTHER THREAD
+    A terminal normally expects tiles to be pushed and drawn on the same thread. If your game runs
+    on one thread and draws on another, call rlhTermSetHandoffMode() to give the terminal three tile
+    buffers. The game thread pushes tiles into its own buffer as usual and calls
+    rlhTermPublishFrame() when a frame is complete, which hands the buffer over with a single atomic
+    swap. The draw functions on the render thread then draw the latest published frame, and keep
+    drawing it until a newer one is published. Neither thread ever waits for the other, and frames
+    that are published faster than they are drawn are skipped. Only tiles are handed over, so set the
+    palette, light map and animations of the terminal on the render thread, and the visibility mask
+    on the game thread. Every push reads the size and the glyphs of the atlas, so only call
+    rlhTermSetSize() and rlhTermSetAtlas() while the game thread is not pushing, like between levels
+    while it waits for the render thread. An asynchronous atlas upload switches atlases in the
+    middle of a draw, so rlhTermBeginAtlasUpload() is rejected in handoff mode. Do not use handoff
+    mode with a tile arena or while recording either. Get and reset the stats of the terminal on the
+    game thread, which gets the counters of the draws with every frame it publishes, so they are a
+    frame or two behind. The swap uses GCC style atomic builtins, or Interlocked functions with MSVC,
+    unless you define RLH_ATOMIC_LOAD(pointer) and RLH_ATOMIC_EXCHANGE(pointer, value) yourself
+    before implementing roguelike.h.
+
+    HOW TO USE A DIFFERENT BACKEND
+    Building tiles and submitting them to the GPU are separated by a renderer backend interface. Each
+    terminal is created with a backend, which is chosen with the backend property of
+    rlhTermCreateInfo_t. If the property is NULL, the OpenGL 3.3 backend RLH_BACKEND_GL33 is used.
+    roguelike.h also provides RLH_BACKEND_NULL, which does all of the tile building work of a terminal
+    but never submits anything to a graphics API. The null backend is useful for measuring the cost of
+    pushing tiles on its own, and for running code that uses roguelike.h on machines without a GPU.
+    If you only want to use the null backend, define RLH_NO_OPENGL before implementing roguelike.h
+    and it will not require OpenGL headers at all.
+    You can also write your own backend by filling out a rlhBackend_t struct with function pointers.
+    Look at the comments above the declaration of rlhBackend_t for the details of each function.
+    Each terminal of the OpenGL 3.3 backend remembers the program, vertex array, array buffer,
+    textures, blending and scissor it last set, and skips setting any of them again to the same
+    values, which saves most of the state changes of drawing it frame after frame. The scissor test
+    is still turned off after every draw. A terminal sets everything again when another terminal set
+    any state after it, so terminals that share a context, or contexts that are made current in
+    turns, need nothing else. If you change any of that state with your own OpenGL calls between
+    drawing terminals, call rlhInvalidateGlState(NULL) before the next draw.
+
+    HOW TO MEASURE PERFORMANCE
+    Every terminal keeps counters of the work it does, which you can get with rlhTermGetStats(). The
+    counters include the amount of tiles pushed and culled, the bytes uploaded to the backend, the
+    amount of times the tile buffer was reallocated and the amount of draw calls. The counters add up
+    until you reset them with rlhTermResetStats(), so to get the cost of a single frame, get the stats
+    and then reset them after each frame.
+    Reading the clock is not free, so the CPU time spent pushing tiles and drawing and the GPU time
+    spent drawing are only measured if you define RLH_STATS_TIMERS before implementing roguelike.h.
+    Where the C library has no monotonic clock, as in strict C99, CPU times are measured with clock()
+    instead. GPU times are measured with timer queries that are read back a few frames later so that
+    they never stall the pipeline, which means that the GPU time of a frame shows up in the stats of a
+    later frame.
+    If you use an instrumenting profiler, roguelike.h can also mark the hot paths of a terminal as
+    profiler zones. Define the macros RLH_PROFILE_BEGIN(name) and RLH_PROFILE_END(name) before
+    implementing roguelike.h, and each zone will be wrapped with them. The name argument is a plain
+    identifier (rlh_push, rlh_reserve, rlh_append_elements, rlh_upload_vertices,
+    rlh_upload_elements, rlh_create_atlas, rlh_step_atlas_upload or rlh_draw), and a BEGIN is always
+    followed by its END in the same scope, so the macros are free to declare local variables. This is
+    an example that uses the C API of the Tracy profiler:
+
+        #define RLH_PROFILE_BEGIN(name) TracyCZoneN(name, #name, 1)
+        #define RLH_PROFILE_END(name) TracyCZoneEnd(name)
+        #define RLH_IMPLEMENTATION
+        #include <rlh/roguelike.h>
+
+    If the macros are not defined, they expand to nothing and cost nothing.
+
+    HOW TO RECORD AND REPLAY
+    A terminal can record everything that is done to it into a binary file, so the exact tiles of a
+    bug report or a slow frame can be played back later. Set the record_path property of
+    rlhTermCreateInfo_t to a file path, and every push, clear, resize and atlas change is written to
+    the file, with a frame marker for every draw. Pushes are stored as differences from the previous
+    push, so a grid of tiles takes only a few bytes per tile. The recording is finished when you call
+    rlhTermStopRecording() or destroy the terminal.
+    To play a recording back, open it with rlhReplayOpen() and create a terminal from it with
+    rlhReplayCreateTerm(). Then every call to rlhReplayNextFrame() pushes the tiles of the next frame
+    into the terminal, and you draw the terminal like normal. The file is memory mapped where the
+    platform supports it, so large recordings do not have to fit in memory, and the atlases stored in
+    it are used without copying them. Recordings use the byte order of the machine that made them.
+
+        rlhReplay_h replay = NULL;
+        rlhReplayOpen("frames.rlhrec", NULL, &replay);
+        rlhTerm_h term = NULL;
+        rlhReplayCreateTerm(replay, NULL, &term);
+        rlhbool_t has_frame = RLH_TRUE;
+        while (rlhReplayNextFrame(replay, term, &has_frame) == RLH_RESULT_OK && has_frame)
+        {
+            rlhTermDraw(term);
+        }
+        rlhTermDestroy(term);
+        rlhReplayClose(replay);
+
     HOW TO DEBUG
     Many functions in roguelike.h return an enum value of type rlhresult_t. Result codes with
     names that start with RLH_RESULT_ERROR_ are returned if an error occured in the function's
@@ -107,6 +216,28 @@
 
         rlmhColor_s my_color = RLH_COLOR(0.5f, 0.2f, 1.0f);
 
+    Tiles store their colors packed into 8 bits per channel, in structs of type rlhColor8_s, which
+    the GPU turns back into values between 0.0f and 1.0f. If your colors are already stored as 8 bit
+    RGBA, push them with the functions that end in 8, like rlhTermPushGrid8(), so they are never
+    converted. You can create packed colors with the RLH_COLOR8() macro, which takes values between
+    0 and 255, or pack a floating point color with rlhColorToColor8(). To push a lot of grid tiles at
+    once, fill an array of rlhGridTile8_s structs and push it with rlhTermPushGridBatch8().
+
+    A terminal can also color its tiles from a palette of RLH_PALETTE_SIZE colors that lives on the
+    GPU. Set the colors with rlhTermSetPalette() and turn the mode on with rlhTermSetPaletteMode(),
+    then push packed colors made with RLH_PALETTE_INDEX(), which stores the index in the red channel.
+    Changing a palette color recolors every tile that uses it on the next draw, without pushing any
+    tiles again, which makes palette flashes and fades cheap in retained mode. Palette mode applies
+    to every tile of a terminal, and it needs a backend that supports palettes. Tiles in palette mode
+    still upload full packed colors, with the other channels unused, so palette mode does not make
+    tiles any smaller to upload. What it saves is pushing tiles again to change their colors.
+
+    HOW TO USE FROM C++
+    roguelike.h can be included from C++ as it is. The rlh.hpp header next to it adds C++17
+    wrappers: rlh::Terminal, which destroys its terminal when it goes out of scope and can enforce a
+    fixed tile size, and rlh::makeGridStpqp(), which builds the glyph coordinates of a grid atlas at
+    compile time. The top of rlh.hpp explains how to use them.
+
     HOW TO USE
     To use roguelike.h, you must bind it to an OpenGL context. There are many open source platform
     libraries for creating a window for rendering, including GLFW (https://www.glfw.org/) and SDL
@@ -144,6 +275,103 @@
     For a detailed example of how to set up an atlas for a 16x16 glyph codepage atlas, look at the
     example on the roguelike.h GitHub repository.
 
+    Replacing a large atlas with rlhTermSetAtlas() uploads all of its pages at once, which can stall
+    a frame. To avoid that, start the upload with rlhTermBeginAtlasUpload() and decode the image
+    straight into the memory it gives you, possibly on a loader thread, then call
+    rlhTermEndAtlasUpload(). Every draw after that copies a few pages to the GPU, and the terminal
+    keeps drawing with its old atlas until rlhTermGetAtlasUploadState() returns
+    RLH_ATLAS_UPLOAD_NONE again.
+
+    Lighting and fog of war do not have to be baked into the colors of every tile. Give a terminal a
+    light map with rlhTermSetLightMap(), one rlhColor8_s per grid cell, and the GPU multiplies the
+    colors drawn in each cell by its light. Make cells with RLH_LIGHT8(), or RLH_LIGHT8_REMEMBERED()
+    for cells the player has seen before but can not see now, which are also drawn in gray. When the
+    light changes, set the light map again and keep the tiles as they are. The light map is a small
+    texture upload that happens once per draw.
+
+    Most roguelikes already know which cells the player can see. Give a terminal a visibility mask
+    with rlhTermSetVisibilityMask(), one bit per grid cell, or change single cells with
+    rlhTermSetCellVisible(), and grid pushes to hidden cells are skipped before they cost anything.
+    The game can then push its whole map every frame. Skipped tiles are counted in the
+    tiles_masked stat. Pushes that are not on the grid, like rlhTermPushFree(), ignore the mask.
+
+    Panel backgrounds, floors and other areas that show one glyph in many cells can be pushed with
+    rlhTermPushRect(), which takes a grid cell position and a size in grid cells. The whole rectangle
+    is a single tile that repeats its glyph in every cell on the GPU, so a 60 by 20 panel costs as
+    much to upload as one tile instead of 1200.
+
+    Labels, dialog and tooltips can be pushed with rlhTermPushText(), which lays a string out in a
+    rectangle of grid cells described by a rlhTextInfo_t, with word wrap and alignment. Every byte of
+    the string is a glyph, "\n" starts a new line, and markup like "{fg=ff0000}" changes the colors
+    of the glyphs after it. A terminal remembers the tiles of the last RLH_TEXT_CACHE_SIZE texts it
+    laid out, so pushing the same text again, even somewhere else, only copies those tiles. Pushes
+    that were remembered are counted in the text_cache_hits stat.
+
+    A message log can keep thousands of lines without pushing them as text every frame. Create a
+    rlhScrollback_h with rlhScrollbackCreate(), add messages to it with rlhScrollbackAdd(), which
+    takes the same markup as rlhTermPushText(), and push the lines in view with
+    rlhTermPushScrollback(). Messages are wrapped and turned into tiles once when they are added, and
+    kept in a ring of line_capacity lines that forgets the oldest line when a new one does not fit,
+    so scrolling only changes which of the ready lines are pushed.
+
+    Portraits, minimaps and title art can be pushed as images with rlhTermPushImage(), which turns
+    RGBA pixels into cells of block glyphs. Fill out a rlhImageMapping_t with the glyphs of your atlas
+    to use. In half block mode every cell shows two pixels stacked on top of each other, with an upper
+    half block in the color of the top pixel over the color of the bottom pixel. In quadrant mode
+    every cell shows 2 by 2 pixels, with the quadrant glyph and the two colors that fit them best.
+
+    Turn based games often draw the same screen for many frames in a row while they wait for input.
+    Turn on cache mode with rlhTermSetCacheMode() and a terminal draws its tiles into an image of its
+    own the first time, then only draws that image while the tiles, palette, light map and animation
+    time stay the same. Tiles can still be pushed again every frame, because pushing exactly the same
+    tiles as the last draw is noticed and does not count as a change. Draws that use the cached image
+    are counted in the cached_draws stat.
+
+    A terminal can also be drawn into a texture with rlhTermDrawToTexture(), to use as a minimap, a
+    screen inside a 3D world or a panel that many things draw. Give it a texture of your own, or 0
+    to draw into the texture of the terminal itself, which is the same image that cache mode keeps.
+    The texture only changes when you draw into it again, so it can be drawn from as often as you
+    like. Its colors have premultiplied alpha, so blend it with a source factor of one.
+
+    With a large pixel scale most of the work of drawing a terminal is shading the same terminal
+    pixel many times over. Turn on low res mode with rlhTermSetLowResMode() and the tiles are drawn
+    once at the unscaled pixel size of the terminal, then that image is scaled up without filtering
+    as the terminal is drawn. This looks the same as long as tiles are pushed at whole unscaled pixel
+    positions, and at a pixel scale of 4 it shades 16 times fewer pixels. Low res mode works together
+    with cache mode.
+
+    Tiles that animate, like water, torches or a blinking cursor, do not have to be pushed again
+    every frame. Describe the animation with a rlhAnimationInfo_t, which can cycle through a row of
+    glyphs and fade the tile colors back and forth, and give it an id from 1 to
+    RLH_ANIMATION_COUNT - 1 with rlhTermSetAnimation(). Push tiles with rlhTermPushGridAnimated8(),
+    or set the animation property of rlhGridTile8_s, then call rlhTermSetAnimationTime() once a
+    frame. The GPU works out the glyph and colors of every animated tile from the time, so in
+    retained mode an animated screen costs no uploads at all. An animation can cycle through at most
+    RLH_ANIMATION_MAX_FRAMES glyphs, and animations need a backend that supports them.
+
+    Games that simulate at a fixed tick rate can still move things smoothly at any frame rate.
+    Push each thing that moved this tick with rlhTermPushGridMoving8() or rlhTermPushFreeMoving8(),
+    giving both where it was on the previous tick and where it is now, then call
+    rlhTermSetMotionAlpha() every frame with how far the frame is between the two ticks, from 0.0 to
+    1.0. The GPU draws every moving tile that far along its way, so in retained mode the tiles are
+    only pushed once per tick, and the frames in between cost no uploads at all.
+
+    Sparks, blood and rain can be thousands of glyph particles that live on the GPU. Make room for
+    them with rlhTermSetParticleCapacity(), emit them with rlhTermEmitParticles(), which spreads them
+    out at random around the position, velocity and lifetime of a rlhParticleEmitInfo_t, and call
+    rlhTermAdvanceParticles() with the seconds since the last frame. Every draw moves the particles
+    on the GPU and draws them over the tiles with their colors fading to their end colors, so only
+    emitting them costs any CPU time. Once there is no room, new particles replace the oldest ones.
+    Particles are not drawn into textures, and in handoff mode they belong to the drawing thread.
+
+    To find out what is under the mouse, turn on pick mode with rlhTermSetPickMode(). Every tile
+    pushed from then on is put into buckets by the cells it covers, and rlhTermPick() looks in the
+    bucket of an unscaled pixel position for the last pushed tile that covers it, so it takes about
+    the same time however many tiles there are. Set a tag with rlhTermSetPickTag() before pushing
+    the tiles of a monster, an item or a button, and picking any of them gives back that tag. Tiles
+    that are cleared can still be picked until the next push, so the tiles that were drawn last
+    frame can be picked while handling input for the next one.
+
     The second property of rlhTermCreateInfo_s is a pointer to a rlhSizeInfo_s, which contains
     properties that define how a terminal should be sized. With the pixel scale property, it is
     possible to scale every pixel within the terminal so that they take up multiple screen pixels.
@@ -195,6 +423,66 @@
     declarations further down in this header file.
 
     CHANGELOG
+    - Version 2.1
+        Features
+            - Moved all OpenGL calls behind a renderer backend interface, rlhBackend_t.
+            - Added RLH_BACKEND_NULL, a backend that builds tiles without submitting them to a GPU.
+            - Added option macro RLH_NO_OPENGL to implement roguelike.h without the OpenGL backend.
+            - Added the rlh_bench benchmark project.
+            - Added rlhTermGetStats() and rlhTermResetStats() for per terminal performance counters.
+            - Added option macro RLH_STATS_TIMERS to measure push and draw CPU time and draw GPU time.
+            - Added profiling zone macros RLH_PROFILE_BEGIN and RLH_PROFILE_END around hot paths.
+            - Added allocation macros RLH_MALLOC, RLH_REALLOC and RLH_FREE with a user data pointer.
+            - Added fixed size tile arenas and a high water mark shrink policy for the tile buffer.
+            - Added binary recording of terminals and memory mapped replay of recordings.
+            - Added the packed color type rlhColor8_s, push functions that take it, and
+              rlhTermPushGridBatch8(). Tile colors are now uploaded as 8 bit normalized attributes.
+            - Added palette mode, with rlhTermSetPalette(), rlhTermSetPaletteMode() and RLH_PALETTE_INDEX().
+            - Added the rlh.hpp C++ header, with the RAII terminal class rlh::Terminal and compile time
+              grid atlas coordinates from rlh::makeGridStpqp().
+            - The pixel_data and glyph_stpqp properties of rlhAtlasCreateInfo_t are now const pointers.
+            - Added asynchronous atlas uploads with rlhTermBeginAtlasUpload() and rlhTermEndAtlasUpload().
+            - Added GPU evaluated tile animations, with rlhTermSetAnimation(), rlhTermSetAnimationTime()
+              and rlhTermPushGridAnimated8().
+            - Added per cell light maps with rlhTermSetLightMap(), RLH_LIGHT8() and RLH_LIGHT8_REMEMBERED().
+            - Added visibility masks that skip grid pushes to hidden cells, with rlhTermSetVisibilityMask()
+              and rlhTermSetCellVisible().
+            - Added cache mode, which draws unchanged frames from an image of the last draw, with
+              rlhTermSetCacheMode().
+            - Added rlhTermDrawToTexture() to draw a terminal into a texture instead of the framebuffer.
+            - Added low res mode, which draws tiles at the unscaled pixel size and scales them up in one
+              pass, with rlhTermSetLowResMode().
+            - Added handoff mode for pushing tiles on one thread and drawing them on another, with
+              rlhTermSetHandoffMode() and rlhTermPublishFrame().
+            - Added rlhTermPushRect() and rlhTermPushRect8(), which fill a rectangle of grid cells with
+              one glyph using a single tile.
+            - Added rlhTermPushText(), which lays out text with word wrap, alignment and color markup,
+              and remembers the tiles of recently laid out texts.
+            - Added scrollbacks, message logs of ready to push lines, with rlhScrollbackCreate(),
+              rlhScrollbackAdd() and rlhTermPushScrollback().
+            - Each OpenGL terminal now skips binds and state changes that it already set, and
+              rlhInvalidateGlState() makes terminals set them all again after outside OpenGL calls.
+            - Added rlhTermPushImage(), which turns RGBA images into half block or quadrant glyph cells.
+            - Added moving tiles that the GPU draws between their previous and current positions, with
+              rlhTermPushGridMoving8(), rlhTermPushFreeMoving8() and rlhTermSetMotionAlpha().
+            - Added glyph particles that are moved by transform feedback and drawn on the GPU, with
+              rlhTermSetParticleCapacity(), rlhTermEmitParticles() and rlhTermAdvanceParticles().
+            - Added pick mode, which finds the tile at a pixel position and its tag, with
+              rlhTermSetPickMode(), rlhTermSetPickTag() and rlhTermPick().
+        Upgrading
+            - rlhTermCreateInfo_t has new optional properties after size_info and atlas_info. Zero
+              initialize it, with = {0} or memset(), before setting the properties you use, so the
+              new ones keep their defaults.
+            - New optional functions are added to rlhBackend_t in the middle as well as at the end.
+              Fill it in by name, with designated initializers in C, instead of by position, and
+              leave the functions you do not implement NULL.
+        Bugfixes
+            - Fixed pixel scale being applied twice to pushed tile positions and sizes.
+            - Fixed the scissor rectangle of translated draws using the x translation for its y position.
+            - Fixed memory leaks when terminal creation fails.
+            - Fixed rlhTermSetSize not returning a result when it succeeds.
+            - Fixed tiles with a glyph equal to the glyph count reading past the end of the atlas.
+            - Fixed the vertex shader relying on the driver to assign attribute locations in order.
     - Version 2.0
         Features
             - Depreciated rlhAtlas_s, and all atlas manipulation is done directly with rlhTerminal_s.
@@ -259,8 +547,41 @@ extern "C"
     float a;
   } rlhColor_s;
 
+  // A color packed into 8 bits per channel, which is how colors are stored in the tile buffer.
+  typedef struct rlhColor8_s
+  {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+  } rlhColor8_s;
+
 // custom color macros
 #define RLH_COLOR(red, green, blue, alpha) ((rlhColor_s){(red), (green), (blue), (alpha)})
+#define RLH_COLOR8(red, green, blue, alpha) ((rlhColor8_s){(red), (green), (blue), (alpha)})
+// In palette mode, the color of a tile is the palette entry at its red channel.
+#define RLH_PALETTE_INDEX(index) ((rlhColor8_s){(index), 0, 0, 0})
+
+// The amount of colors in the palette of a terminal.
+#define RLH_PALETTE_SIZE 256
+
+// The amount of animations a terminal can have, including RLH_NO_ANIMATION.
+#define RLH_ANIMATION_COUNT 256
+// The most glyphs an animation can cycle through.
+#define RLH_ANIMATION_MAX_FRAMES 16
+// The animation of tiles that are not animated.
+#define RLH_NO_ANIMATION 0
+
+// A light map cell that multiplies the colors under it by the given light.
+#define RLH_LIGHT8(red, green, blue) ((rlhColor8_s){(red), (green), (blue), 0})
+// A light map cell that is remembered but not seen, which also drains the colors under it to gray.
+#define RLH_LIGHT8_REMEMBERED(red, green, blue) ((rlhColor8_s){(red), (green), (blue), 255})
+
+// The size in bytes of a visibility mask, which has one bit per grid cell.
+#define RLH_VISIBILITY_MASK_SIZE(tiles_wide, tiles_tall) ((((size_t)(tiles_wide) * (size_t)(tiles_tall)) + 7) / 8)
+
+// The amount of laid out texts a terminal remembers for rlhTermPushText().
+#define RLH_TEXT_CACHE_SIZE 64
 
 // standard color macros
 #define RLH_RED ((rlhColor_s){(1.0f), (0.0f), (0.0f), (1.0f)})
@@ -290,6 +611,8 @@ extern "C"
   typedef uint16_t rlhglyph_t;
 
   typedef struct rlhTerm_s *rlhTerm_h;
+  typedef struct rlhReplay_s *rlhReplay_h;
+  typedef struct rlhScrollback_s *rlhScrollback_h;
 
   typedef enum rlhresult_t
   {
@@ -297,6 +620,7 @@ extern "C"
     RLH_RESULT_ERROR_NULL_ARGUMENT = 1,
     RLH_RESULT_ERROR_INVALID_VALUE = 2,
     RLH_RESULT_ERROR_OUT_OF_MEMORY = 3,
+    RLH_RESULT_ERROR_IO = 4,
     RLH_RESULT_COUNT
   } rlhresult_t;
 
@@ -337,6 +661,26 @@ extern "C"
     RLH_VALIGN_COUNT
   } rlhtermvalign_t;
 
+  typedef enum rlhatlasupload_t
+  {
+    // No atlas upload is pending.
+    RLH_ATLAS_UPLOAD_NONE,
+    // Waiting for the pixels of the new atlas to be written.
+    RLH_ATLAS_UPLOAD_WRITING,
+    // The pages of the new atlas are being copied to the GPU. The old atlas is still drawn.
+    RLH_ATLAS_UPLOAD_TRANSFERRING,
+    RLH_ATLAS_UPLOAD_COUNT
+  } rlhatlasupload_t;
+
+  typedef enum rlhimagemode_t
+  {
+    // Each cell shows 1 by 2 pixels of the image, with an upper half block glyph.
+    RLH_IMAGE_HALF_BLOCKS,
+    // Each cell shows 2 by 2 pixels of the image, with the quadrant glyph that fits them best.
+    RLH_IMAGE_QUADRANTS,
+    RLH_IMAGE_MODE_COUNT
+  } rlhimagemode_t;
+
   typedef struct rlhAtlasCreateInfo_t
   {
     int width;
@@ -344,9 +688,9 @@ extern "C"
     int pages;
     int channel_size;
     rlhcolortype_t color;
-    uint8_t *pixel_data;
+    const uint8_t *pixel_data;
     int glyph_count;
-    float *glyph_stpqp;
+    const float *glyph_stpqp;
   } rlhAtlasCreateInfo_t;
 
   typedef struct rlhTermSizeInfo_t
@@ -360,22 +704,344 @@ extern "C"
     int tile_height;
   } rlhTermSizeInfo_t;
 
+  // A scissor rectangle in viewport pixels, with (0,0) in the upper left corner of the viewport.
+  typedef struct rlhScissor_t
+  {
+    int x;
+    int y;
+    int width;
+    int height;
+    int viewport_height;
+  } rlhScissor_t;
+
+  // A vertex of a tile. The x and y position goes from (0,0) in the upper left corner of the terminal
+  // to (1,1) in the bottom right corner, and s, t and page are the atlas texture coordinates.
+  // animation is the animation of the tile, or RLH_NO_ANIMATION, and its highest bit is set if the
+  // tile repeats its glyph in every grid cell it covers. Such a tile has the index of its glyph in s
+  // instead, and 0 in t.
+  typedef struct rlhVertex_s
+  {
+    float x;
+    float y;
+    float s;
+    float t;
+    uint16_t page;
+    uint16_t animation;
+    rlhColor8_s fg;
+    rlhColor8_s bg;
+    // How far the tile moved from its previous position in unscaled pixels, or 0 if it did not move.
+    // The tile is drawn this far back times 1 minus the motion alpha of the terminal.
+    int16_t motion_x;
+    int16_t motion_y;
+  } rlhVertex_s;
+
+  // A particle as it is handed to the backend. The x and y position of its top left corner, width
+  // and height are in unscaled pixels, velocity is in pixels per second and acceleration is in
+  // pixels per second per second. s, t, p, q and page are the atlas coordinates of its glyph, like
+  // in glyph_stpqp. Its colors fade from fg and bg to fg_end and bg_end over its lifetime.
+  typedef struct rlhParticle_s
+  {
+    float x;
+    float y;
+    float velocity_x;
+    float velocity_y;
+    float age;
+    float lifetime;
+    float acceleration_x;
+    float acceleration_y;
+    float drag;
+    float width;
+    float height;
+    float s;
+    float t;
+    float p;
+    float q;
+    uint32_t page;
+    rlhColor8_s fg;
+    rlhColor8_s bg;
+    rlhColor8_s fg_end;
+    rlhColor8_s bg_end;
+  } rlhParticle_s;
+
+  // Particles to emit with rlhTermEmitParticles(). Every spread is how far a particle can be from
+  // the value before it in either direction, picked at random for each particle.
+  typedef struct rlhParticleEmitInfo_t
+  {
+    // Where the top left corner of the particles starts, in unscaled pixels.
+    float x;
+    float y;
+    float spread_x;
+    float spread_y;
+    // Pixels per second.
+    float velocity_x;
+    float velocity_y;
+    float velocity_spread_x;
+    float velocity_spread_y;
+    // Pixels per second per second, like gravity.
+    float acceleration_x;
+    float acceleration_y;
+    // How quickly the particles slow down. Their velocity is multiplied by exp(-drag) every second.
+    float drag;
+    // Seconds the particles live, and up to how many more seconds they can live.
+    float lifetime;
+    float lifetime_spread;
+    rlhglyph_t glyph;
+    // The pixel size of the particles, where 0 is the tile width or height of the terminal.
+    int width;
+    int height;
+    // The colors the particles start with, and fade to until they die.
+    rlhColor8_s fg;
+    rlhColor8_s bg;
+    rlhColor8_s fg_end;
+    rlhColor8_s bg_end;
+  } rlhParticleEmitInfo_t;
+
+  // An animation that the backend plays on every tile that uses it, without the tiles being pushed again.
+  typedef struct rlhAnimationInfo_t
+  {
+    // Cycle through frame_count glyphs in a row, starting with base_glyph, showing each one for
+    // frame_duration seconds. A frame_count of 0 or 1 always shows base_glyph.
+    rlhglyph_t base_glyph;
+    int frame_count;
+    float frame_duration;
+    // Fade the colors of the tile to fg and bg and back again every color_period seconds. A
+    // color_period of 0 keeps the colors of the tile.
+    rlhColor8_s fg;
+    rlhColor8_s bg;
+    float color_period;
+  } rlhAnimationInfo_t;
+
+  // A renderer backend. Terminals build their tiles on the CPU and hand them to their backend to be
+  // submitted to a graphics API. Fill it in by name rather than by position, because new optional
+  // functions can be added anywhere in it, and leave the ones you do not implement NULL.
+  // Vertex data is tightly packed rlhVertex_s structs, with 4 vertices per tile.
+  // Element data is uint32_t vertex indices, with 6 per tile that make two triangles.
+  typedef struct rlhBackend_t
+  {
+    // The name of the backend.
+    const char *name;
+    // Passed as the first argument to create.
+    void *user_data;
+    // Create the backend resources of a terminal. The pointer written to backend_data is passed to
+    // every other function of the backend.
+    rlhresult_t (*create)(void *user_data, void **backend_data);
+    // Destroy the backend resources of a terminal.
+    void (*destroy)(void *backend_data);
+    // Create the atlas of a terminal, replacing the previous atlas if there is one.
+    rlhresult_t (*create_atlas)(void *backend_data, const rlhAtlasCreateInfo_t *atlas_info);
+    // Upload the vertex data of every tile in the terminal.
+    rlhresult_t (*upload_vertices)(void *backend_data, const rlhVertex_s *vertex_data, size_t vertex_data_size);
+    // Upload element data. This is only called when the amount of elements grows.
+    rlhresult_t (*upload_elements)(void *backend_data, const uint32_t *element_data, size_t element_data_size);
+    // Draw element_count elements of the uploaded data transformed by a 4x4 row major matrix.
+    // If scissor is not NULL, drawing is clipped to the scissor rectangle.
+    rlhresult_t (*draw)(void *backend_data, const float *matrix_4x4, size_t element_count, const rlhScissor_t *scissor);
+    // Optional. Read the GPU time of the oldest draw that has finished and has not been read yet.
+    // Returns RLH_FALSE if there is none. This must never wait for the GPU.
+    rlhbool_t (*read_gpu_time)(void *backend_data, uint64_t *gpu_ns);
+    // Optional. Turn on palette mode with the given RLH_PALETTE_SIZE colors, or turn it off if
+    // palette is NULL. In palette mode the red channels of the tile colors are palette indices.
+    rlhresult_t (*set_palette)(void *backend_data, const rlhColor8_s *palette);
+    // Optional. Start uploading a new atlas without replacing the current one, and write where its
+    // pixels go to pixel_data. The pixel_data property of atlas_info is not used.
+    rlhresult_t (*begin_atlas_upload)(void *backend_data, const rlhAtlasCreateInfo_t *atlas_info, void **pixel_data);
+    // Optional, but required with begin_atlas_upload. Called once the pixels have been written.
+    rlhresult_t (*end_atlas_upload)(void *backend_data);
+    // Optional, but required with begin_atlas_upload. Copy up to page_count more pages of the new
+    // atlas to the GPU. Once the new atlas can be drawn, replace the current atlas with it and write
+    // RLH_TRUE to resident. This must never wait for the GPU.
+    rlhresult_t (*step_atlas_upload)(void *backend_data, int page_count, rlhbool_t *resident);
+    // Optional. Set an animation, which is never RLH_NO_ANIMATION. glyph_stpqp is the atlas
+    // coordinates of the frame_count glyphs of the animation, or NULL if the glyphs do not cycle.
+    rlhresult_t (*set_animation)(void *backend_data, uint16_t animation, const rlhAnimationInfo_t *animation_info, const float *glyph_stpqp);
+    // Optional, but required with set_animation. Set the time in seconds that animations are drawn at.
+    rlhresult_t (*set_animation_time)(void *backend_data, float seconds);
+    // Optional. Set the light map, width by height cells, or turn it off if light_map is NULL.
+    // cells_wide and cells_tall are how many cells cover the terminal, which can be a fraction more
+    // than width and height when the terminal is not a whole amount of tiles.
+    rlhresult_t (*set_light_map)(void *backend_data, const rlhColor8_s *light_map, int width, int height, float cells_wide, float cells_tall);
+    // Optional. Draw like draw, but through an image of the terminal that is cache_width by
+    // cache_height pixels. The tiles are only drawn into the image if redraw is RLH_TRUE, otherwise
+    // the image from the last draw is drawn again.
+    rlhresult_t (*draw_cached)(void *backend_data, const float *matrix_4x4, size_t element_count, const rlhScissor_t *scissor, int cache_width, int cache_height, rlhbool_t redraw);
+    // Optional. Draw the tiles into all of a texture of the graphics api, with premultiplied alpha.
+    // If texture is 0, draw into the texture of the terminal, made or resized to width by height
+    // pixels. drawn_texture is set to the texture that was drawn into.
+    rlhresult_t (*draw_to_texture)(void *backend_data, size_t element_count, uint32_t texture, int width, int height, uint32_t *drawn_texture);
+    // Optional. Set how many grid cells cover the terminal, which can be a fraction more than its
+    // tiles wide and tall. Without it, tiles that repeat their glyph are never pushed. A tile repeats
+    // when the highest bit of its animation is set. Its vertices then have the index of its glyph
+    // in the atlas in s, and it draws the glyph again in every grid cell, counting from the top left
+    // of the terminal.
+    rlhresult_t (*set_cells)(void *backend_data, float cells_wide, float cells_tall);
+    // Optional. Set how far between their previous and current positions moving tiles are drawn,
+    // from 0.0 at the previous position to 1.0 at the current one. pixels_wide and pixels_tall are
+    // the unscaled pixel size of the terminal, which the motion of vertices is measured in. Without
+    // it, tiles that move are never pushed.
+    rlhresult_t (*set_motion)(void *backend_data, float alpha, float pixels_wide, float pixels_tall);
+    // Optional. Make room for capacity particles, which removes every particle, or free them if
+    // capacity is 0. Without it, particles are never emitted.
+    rlhresult_t (*set_particle_capacity)(void *backend_data, size_t capacity);
+    // Optional, but required with set_particle_capacity. Move every particle seconds forward, then
+    // add count new particles in place of the oldest ones.
+    rlhresult_t (*update_particles)(void *backend_data, float seconds, const rlhParticle_s *particles, size_t count);
+    // Optional, but required with set_particle_capacity. Draw the particles like draw draws tiles.
+    // pixels_wide and pixels_tall are the unscaled pixel size of the terminal.
+    rlhresult_t (*draw_particles)(void *backend_data, const float *matrix_4x4, const rlhScissor_t *scissor, float pixels_wide, float pixels_tall);
+  } rlhBackend_t;
+
+  // A backend that builds tiles but never submits anything to a graphics API.
+  extern const rlhBackend_t RLH_BACKEND_NULL;
+#ifndef RLH_NO_OPENGL
+  // The OpenGL 3.3 core backend.
+  extern const rlhBackend_t RLH_BACKEND_GL33;
+#endif
+
+  // Zero initialize it before setting its properties, so optional properties that are added later
+  // keep their defaults.
   typedef struct rlhTermCreateInfo_t
   {
     rlhTermSizeInfo_t *size_info;
     rlhAtlasCreateInfo_t *atlas_info;
+    // The backend to render with. If NULL, RLH_BACKEND_GL33 is used, or RLH_BACKEND_NULL if
+    // RLH_NO_OPENGL is defined.
+    const rlhBackend_t *backend;
+    // Optional. Passed to the RLH_MALLOC, RLH_REALLOC and RLH_FREE macros for every allocation the
+    // terminal makes.
+    void *allocator_user_data;
+    // Optional. If tile_arena_size is not 0, the tile buffer is a fixed region of this many bytes
+    // that is reset when the tile data is cleared and never grows. Pushes that do not fit in it
+    // return RLH_RESULT_ERROR_OUT_OF_MEMORY. If tile_arena is NULL the region is allocated once,
+    // otherwise tile_arena is used, which must be aligned to a float and outlive the terminal.
+    void *tile_arena;
+    size_t tile_arena_size;
+    // Optional. If not 0, each time the tile data has been cleared this many times, the tile buffer
+    // shrinks if the most tiles it held since the last check use less than a quarter of it.
+    // Ignored if a tile arena is used.
+    size_t shrink_interval;
+    // Optional. If not NULL, everything done to the terminal is recorded into a new file at this
+    // path, until rlhTermStopRecording() is called or the terminal is destroyed.
+    const char *record_path;
   } rlhTermCreateInfo_t;
 
+  // A tile of a batch pushed with rlhTermPushGridBatch8().
+  typedef struct rlhGridTile8_s
+  {
+    int grid_x;
+    int grid_y;
+    rlhglyph_t glyph;
+    rlhColor8_s fg;
+    rlhColor8_s bg;
+    // The animation of the tile, or RLH_NO_ANIMATION.
+    uint16_t animation;
+  } rlhGridTile8_s;
+
+  // How a text pushed with rlhTermPushText() is laid out.
+  typedef struct rlhTextInfo_t
+  {
+    // The rectangle of grid cells that the text is laid out in. Glyphs outside of it are not pushed.
+    int grid_x;
+    int grid_y;
+    int grid_width;
+    int grid_height;
+    // If RLH_TRUE, lines wider than the rectangle are broken at the last space that fits, or in the
+    // middle of a word that is wider than the rectangle.
+    rlhbool_t wrap;
+    rlhtermhalign_t halign;
+    rlhtermvalign_t valign;
+    // The colors of the glyphs until markup changes them.
+    rlhColor8_s fg;
+    rlhColor8_s bg;
+  } rlhTextInfo_t;
+
+  // How an image pushed with rlhTermPushImage() is turned into cells.
+  typedef struct rlhImageMapping_t
+  {
+    rlhimagemode_t mode;
+    // The glyph that shows the foreground color in the quarters of a cell whose bits are set in its
+    // index, and the background color in the rest: 1 is top left, 2 is top right, 4 is bottom left
+    // and 8 is bottom right. Half block mode only uses glyphs[3], the upper half block. Quadrant mode
+    // uses the glyphs with odd indices, which have the top left quarter in the foreground color.
+    rlhglyph_t glyphs[16];
+  } rlhImageMapping_t;
+
+  typedef struct rlhScrollbackCreateInfo_t
+  {
+    // How many grid cells wide each line is. Messages wider than this are wrapped onto more lines.
+    int line_width;
+    // The most lines the scrollback keeps. Adding a line when it is full forgets the oldest line.
+    int line_capacity;
+    // Passed to RLH_MALLOC, RLH_REALLOC and RLH_FREE for the memory of the scrollback.
+    void *allocator_user_data;
+  } rlhScrollbackCreateInfo_t;
+
+  // Performance counters of a terminal, added up since it was created or since its stats were last reset.
+  typedef struct rlhTermStats_t
+  {
+    // Tiles that were added to the tile buffer.
+    uint64_t tiles_pushed;
+    // Tiles that were rejected because they were outside of the terminal or had an invalid glyph.
+    uint64_t tiles_culled;
+    // Grid tiles that were skipped because their cell is hidden by the visibility mask.
+    uint64_t tiles_masked;
+    // Bytes of vertex and element data given to the backend.
+    uint64_t bytes_uploaded;
+    // Times the tile buffer had to be reallocated to fit more tiles.
+    uint64_t vertex_data_reallocations;
+    // Times the tile buffer was shrunk by the shrink policy.
+    uint64_t vertex_data_shrinks;
+    // Draws submitted to the backend.
+    uint64_t draw_calls;
+    // Draws in cache mode that drew the cached image of the terminal instead of its tiles.
+    uint64_t cached_draws;
+    // Texts pushed with rlhTermPushText() that were already laid out.
+    uint64_t text_cache_hits;
+    // Particles given to the backend. Particles that were replaced before a draw are not counted.
+    uint64_t particles_emitted;
+    // CPU time spent pushing tiles. Only measured if RLH_STATS_TIMERS is defined.
+    uint64_t push_cpu_ns;
+    // CPU time spent in draw functions. Only measured if RLH_STATS_TIMERS is defined.
+    uint64_t draw_cpu_ns;
+    // GPU time of the draws that were read back. Only measured if RLH_STATS_TIMERS is defined and the
+    // backend supports it.
+    uint64_t gpu_ns;
+    // Draws that gpu_ns was measured from.
+    uint64_t gpu_timed_draws;
+    // GPU time of the most recent draw that was read back.
+    uint64_t gpu_last_draw_ns;
+  } rlhTermStats_t;
+
+#ifndef RLH_NO_OPENGL
   // Clear the color of the console area with a solid color.
   void rlhClearColor(const rlhColor_s color);
   // Set viewport area to draw to.
   void rlhViewport(int x, int y, int width, int height);
+  // Forget the OpenGL state that a terminal last set, so it sets all of it again on its next draw, or
+  // forget the state of every terminal if term is NULL. Call this with NULL after changing the bound
+  // program, vertex array, array buffer, textures, active texture, blending or scissor with your own
+  // OpenGL calls. Terminals that do not use the OpenGL 3.3 backend are ignored.
+  void rlhInvalidateGlState(rlhTerm_h const term);
+#endif
   // Create a terminal.
   rlhresult_t rlhTermCreate(rlhTermCreateInfo_t *term_info, rlhTerm_h *term);
   // Destroy a term object and free all of its resources.
   void rlhTermDestroy(rlhTerm_h const term);
   // Set the atlas of a terminal.
   rlhresult_t rlhTermSetAtlas(rlhTerm_h const term, rlhAtlasCreateInfo_t *atlas_info);
+  // Start replacing the atlas of a terminal without stalling. Write the pixels of the new atlas to
+  // the memory written to pixel_data, which is the size of the pixel data of atlas_info, then call
+  // rlhTermEndAtlasUpload(). The pixel_data property of atlas_info is not used. The pixels can be
+  // written by another thread, but every rlh function must still be called from the thread of the
+  // graphics context. Returns RLH_RESULT_ERROR_INVALID_VALUE if an upload is already pending, the
+  // terminal is in handoff mode, or the backend of the terminal can not upload atlases
+  // asynchronously.
+  rlhresult_t rlhTermBeginAtlasUpload(rlhTerm_h const term, const rlhAtlasCreateInfo_t *const atlas_info, const int pages_per_draw, void **pixel_data);
+  // Finish writing the pixels of an atlas upload. After this, every draw copies up to
+  // pages_per_draw pages of it to the GPU, and the terminal switches to the new atlas on the first
+  // draw after the GPU has finished copying all of them.
+  rlhresult_t rlhTermEndAtlasUpload(rlhTerm_h const term);
+  // Get how far along the atlas upload of a terminal is.
+  rlhatlasupload_t rlhTermGetAtlasUploadState(rlhTerm_h const term);
   // Get the amount of glyphs in a terminal's atlas.
   int rlhTermGetGlyphCount(rlhTerm_h const term);
   // Get the size ratio of a terminal pixel per screen pixel.
@@ -394,6 +1060,18 @@ extern "C"
   rlhresult_t rlhTermClearTileData(rlhTerm_h const term);
   // Get how many tiles have been set since the last clear.
   int rlhTermGetTileDataCount(rlhTerm_h const term);
+  // Turn handoff mode on or off for a terminal. In handoff mode tiles are pushed into a buffer that
+  // is handed to the draw functions by rlhTermPublishFrame(), so pushing and drawing can happen on
+  // two threads without blocking each other. Turn it on or off while no other thread is using the
+  // terminal. The size and atlas of a terminal in handoff mode must only be set while no tiles are
+  // being pushed to it. Returns RLH_RESULT_ERROR_INVALID_VALUE if the terminal uses a tile arena, is
+  // recording, or has an atlas upload pending.
+  rlhresult_t rlhTermSetHandoffMode(rlhTerm_h const term, const rlhbool_t enabled);
+  // Hand the tiles pushed since the last publish over to the draw functions, which draw them until
+  // the next frame is published. Pushing starts over with no tiles, or with a copy of the published
+  // tiles in RLH_RETAINED_MODE. Returns RLH_RESULT_ERROR_INVALID_VALUE if the terminal is not in
+  // handoff mode.
+  rlhresult_t rlhTermPublishFrame(rlhTerm_h const term);
   // Push a tile to the terminal that is stretched over the entire terminal area.
   rlhresult_t rlhTermPushFill(rlhTerm_h const term, const uint16_t glyph, const rlhColor_s fg, const rlhColor_s bg);
   // Push a tile to a terminal in a grid cell position with default pixel width and pixel height.
@@ -404,6 +1082,162 @@ extern "C"
   rlhresult_t rlhTermPushFree(rlhTerm_h const term, const int screen_pixel_x, const int screen_pixel_y, const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg);
   // Push a tile to a terminal in a pixel position with a custom pixel width and pixel height.
   rlhresult_t rlhTermPushFreeSized(rlhTerm_h const term, const int screen_pixel_x, const int screen_pixel_y, const int tile_pixel_width, const int tile_pixel_height, const rlhglyph_t glyph, const rlhColor_s fg, const rlhColor_s bg);
+  // Push a tile with packed colors to the terminal that is stretched over the entire terminal area.
+  rlhresult_t rlhTermPushFill8(rlhTerm_h const term, const uint16_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push a tile with packed colors to a terminal in a grid cell position with default pixel width and pixel height.
+  rlhresult_t rlhTermPushGrid8(rlhTerm_h const term, const int grid_x, const int grid_y, const uint16_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push a tile with packed colors to a terminal in a grid cell position with a custom pixel width and pixel height.
+  rlhresult_t rlhTermPushGridSized8(rlhTerm_h const term, const int grid_x, const int grid_y, const int tile_pixel_width, const int tile_pixel_height, const uint16_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push a tile with packed colors to a terminal in a pixel position with a default pixel width and pixel height.
+  rlhresult_t rlhTermPushFree8(rlhTerm_h const term, const int screen_pixel_x, const int screen_pixel_y, const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push a tile with packed colors to a terminal in a pixel position with a custom pixel width and pixel height.
+  rlhresult_t rlhTermPushFreeSized8(rlhTerm_h const term, const int screen_pixel_x, const int screen_pixel_y, const int tile_pixel_width, const int tile_pixel_height, const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push many tiles with packed colors to a terminal in grid cell positions with default pixel width
+  // and pixel height. Space for every tile is reserved up front, so if it does not fit none of the
+  // tiles are pushed.
+  rlhresult_t rlhTermPushGridBatch8(rlhTerm_h const term, const rlhGridTile8_s *const tiles, const size_t tile_count);
+  // Push a rectangle of grid cells that all show the same glyph to a terminal, from a grid cell
+  // position and grid_width by grid_height cells in size. The rectangle is a single tile that repeats
+  // its glyph in every cell, unless the backend can not repeat glyphs or some of the cells are hidden
+  // by the visibility mask, in which case a tile is pushed for each cell instead.
+  rlhresult_t rlhTermPushRect(rlhTerm_h const term, const int grid_x, const int grid_y, const int grid_width, const int grid_height, const uint16_t glyph, const rlhColor_s fg, const rlhColor_s bg);
+  // Push a rectangle of grid cells that all show the same glyph with packed colors to a terminal.
+  rlhresult_t rlhTermPushRect8(rlhTerm_h const term, const int grid_x, const int grid_y, const int grid_width, const int grid_height, const uint16_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push a text to a terminal, laid out in the rectangle of text_info. Every byte of the text is a
+  // glyph, except that "\n" starts a new line and "{" starts markup: "{fg=RRGGBB}" and "{bg=RRGGBB}"
+  // change the colors of the glyphs after them, with two more hex digits for alpha if needed, "{/}"
+  // changes both back to the colors of text_info, and "{{" is a "{" glyph. Returns
+  // RLH_RESULT_ERROR_INVALID_VALUE if the markup is not valid.
+  rlhresult_t rlhTermPushText(rlhTerm_h const term, const rlhTextInfo_t *const text_info, const char *const text);
+  // Create a scrollback, which keeps the last lines of the messages added to it as tiles that are
+  // ready to push. Returns RLH_RESULT_ERROR_INVALID_VALUE if line_width or line_capacity is not
+  // above 0.
+  rlhresult_t rlhScrollbackCreate(const rlhScrollbackCreateInfo_t *const scrollback_info, rlhScrollback_h *scrollback);
+  // Destroy a scrollback and free all of its resources.
+  void rlhScrollbackDestroy(rlhScrollback_h const scrollback);
+  // Add a message to the end of a scrollback, in fg and bg colors unless its markup changes them.
+  // The markup is the same as for rlhTermPushText(), and the message is word wrapped to the line
+  // width. Returns RLH_RESULT_ERROR_INVALID_VALUE if the markup is not valid.
+  rlhresult_t rlhScrollbackAdd(rlhScrollback_h const scrollback, const char *const text, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Forget every line of a scrollback.
+  rlhresult_t rlhScrollbackClear(rlhScrollback_h const scrollback);
+  // Get how many lines a scrollback has, which is at most its line_capacity.
+  rlhresult_t rlhScrollbackGetLineCount(rlhScrollback_h const scrollback, size_t *const line_count);
+  // Push the lines of a scrollback that fit in grid_height rows to a terminal, with the newest line
+  // that is shown on the bottom row. scroll is how many of the newest lines to scroll past, and it
+  // stops at the oldest line being on the top row.
+  rlhresult_t rlhTermPushScrollback(rlhTerm_h const term, rlhScrollback_h const scrollback, const int grid_x, const int grid_y, const int grid_height, const size_t scroll);
+  // Push an image of width by height RGBA pixels to a terminal as block glyphs, with the top left cell
+  // in a grid cell position. Each cell gets the glyph of mapping and the two colors that best fit the
+  // pixels it covers. Pixels past the edges of the image are transparent, and cells outside of the
+  // terminal are skipped before they are fit. Returns RLH_RESULT_ERROR_INVALID_VALUE if the size is
+  // below 0 or the mode is not valid.
+  rlhresult_t rlhTermPushImage(rlhTerm_h const term, const int grid_x, const int grid_y, const rlhColor8_s *const pixels, const int width, const int height, const rlhImageMapping_t *const mapping);
+  // Turn palette mode on or off for a terminal. Returns RLH_RESULT_ERROR_INVALID_VALUE if the
+  // backend of the terminal does not support palettes.
+  rlhresult_t rlhTermSetPaletteMode(rlhTerm_h const term, const rlhbool_t enabled);
+  // Set color_count palette colors of a terminal, starting at first_index.
+  rlhresult_t rlhTermSetPalette(rlhTerm_h const term, const size_t first_index, const size_t color_count, const rlhColor8_s *const colors);
+  // Set an animation of a terminal, or stop it if animation_info is NULL. Tiles pushed with the
+  // animation play it without being pushed again. Returns RLH_RESULT_ERROR_INVALID_VALUE if
+  // animation is RLH_NO_ANIMATION or not less than RLH_ANIMATION_COUNT, if the glyphs of the
+  // animation are not in the atlas, or if the backend of the terminal does not support animations.
+  rlhresult_t rlhTermSetAnimation(rlhTerm_h const term, const uint16_t animation, const rlhAnimationInfo_t *const animation_info);
+  // Set the time in seconds that the animations of a terminal are drawn at.
+  rlhresult_t rlhTermSetAnimationTime(rlhTerm_h const term, const double seconds);
+  // Set the light map of a terminal, one cell per grid cell row by row from the top left, or turn it
+  // off if light_map is NULL. The rgb of a cell multiplies the colors drawn in the cell, and its alpha
+  // is how much to desaturate them. Changing the size of the terminal to a different amount of tiles
+  // turns the light map off. Returns RLH_RESULT_ERROR_INVALID_VALUE if the terminal has no grid cells
+  // or if its backend does not support light maps.
+  rlhresult_t rlhTermSetLightMap(rlhTerm_h const term, const rlhColor8_s *const light_map);
+  // Set the visibility mask of a terminal, or remove it if mask is NULL. The mask has one bit per
+  // grid cell, row by row from the top left and starting at the lowest bit of each byte, and is
+  // RLH_VISIBILITY_MASK_SIZE() bytes. Grid pushes to cells with a 0 bit are skipped before any other
+  // work. Changing the size of the terminal to a different amount of tiles removes the mask. Returns
+  // RLH_RESULT_ERROR_INVALID_VALUE if the terminal has no grid cells.
+  rlhresult_t rlhTermSetVisibilityMask(rlhTerm_h const term, const uint8_t *const mask);
+  // Show or hide one grid cell of the visibility mask of a terminal. If the terminal has no mask yet,
+  // one with every cell visible is made first.
+  rlhresult_t rlhTermSetCellVisible(rlhTerm_h const term, const int grid_x, const int grid_y, const rlhbool_t visible);
+  // Turn cache mode on or off for a terminal. In cache mode a terminal draws its tiles into an image
+  // of its own, and draws that image again without drawing any tiles while nothing pushed or set has
+  // changed since. Returns RLH_RESULT_ERROR_INVALID_VALUE if the backend of the terminal does not
+  // support cache mode.
+  rlhresult_t rlhTermSetCacheMode(rlhTerm_h const term, const rlhbool_t enabled);
+  // Turn low res mode on or off for a terminal. In low res mode a terminal draws its tiles once at
+  // its unscaled pixel size, then scales that image up by its pixel scale when it is drawn, so each
+  // terminal pixel is only shaded once. Returns RLH_RESULT_ERROR_INVALID_VALUE if the backend of the
+  // terminal does not support drawing through an image.
+  rlhresult_t rlhTermSetLowResMode(rlhTerm_h const term, const rlhbool_t enabled);
+  // Push a tile that plays an animation to a terminal in a grid cell position, starting with the
+  // base glyph of the animation.
+  rlhresult_t rlhTermPushGridAnimated8(rlhTerm_h const term, const int grid_x, const int grid_y, const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push a tile that plays an animation to a terminal in a pixel position with a custom pixel width
+  // and pixel height, starting with the base glyph of the animation.
+  rlhresult_t rlhTermPushFreeSizedAnimated8(rlhTerm_h const term, const int screen_pixel_x, const int screen_pixel_y, const int tile_pixel_width, const int tile_pixel_height, const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Set how far between their previous and current positions the moving tiles of a terminal are
+  // drawn, from 0.0 at the previous position to 1.0 at the current one, which is the default. Values
+  // outside of that range draw the tiles past their positions. Returns
+  // RLH_RESULT_ERROR_INVALID_VALUE if the backend of the terminal does not support moving tiles.
+  rlhresult_t rlhTermSetMotionAlpha(rlhTerm_h const term, const float alpha);
+  // Push a tile that moved from a previous grid cell position to a grid cell position to a terminal,
+  // which is drawn between the two at the motion alpha of the terminal. Returns
+  // RLH_RESULT_ERROR_INVALID_VALUE if it moved more than 32767 pixels in either direction or if the
+  // backend of the terminal does not support moving tiles.
+  rlhresult_t rlhTermPushGridMoving8(rlhTerm_h const term, const int from_grid_x, const int from_grid_y, const int grid_x, const int grid_y, const uint16_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Push a tile that moved from a previous pixel position to a pixel position to a terminal, with a
+  // default pixel width and pixel height.
+  rlhresult_t rlhTermPushFreeMoving8(rlhTerm_h const term, const int from_pixel_x, const int from_pixel_y, const int screen_pixel_x, const int screen_pixel_y, const rlhglyph_t glyph, const rlhColor8_s fg, const rlhColor8_s bg);
+  // Make room for capacity particles in a terminal, which removes every particle, or free them if
+  // capacity is 0. Returns RLH_RESULT_ERROR_INVALID_VALUE if the backend of the terminal does not
+  // support particles.
+  rlhresult_t rlhTermSetParticleCapacity(rlhTerm_h const term, const size_t capacity);
+  // Emit count particles in a terminal, which replace the oldest particles once there is no room.
+  // Returns RLH_RESULT_ERROR_INVALID_VALUE if the terminal has no room for particles.
+  rlhresult_t rlhTermEmitParticles(rlhTerm_h const term, const rlhParticleEmitInfo_t *const emit_info, const int count);
+  // Move the particles of a terminal seconds forward when it is next drawn.
+  rlhresult_t rlhTermAdvanceParticles(rlhTerm_h const term, const float seconds);
+  // Turn pick mode on or off for a terminal. In pick mode every tile that is pushed is also put in
+  // buckets by the cells it covers, so rlhTermPick() can find the tile at a position without looking
+  // at every tile.
+  rlhresult_t rlhTermSetPickMode(rlhTerm_h const term, const rlhbool_t enabled);
+  // Set the tag that tiles pushed to a terminal from now on carry in pick mode, which is 0 until it
+  // is set.
+  rlhresult_t rlhTermSetPickTag(rlhTerm_h const term, const uint32_t tag);
+  // Find the last pushed tile of a terminal in pick mode that covers an unscaled pixel position.
+  // found is set to RLH_FALSE if there is none. Otherwise tile_index is set to how many tiles were
+  // pushed before it since the tile data was cleared, and tag is set to its tag. tile_index and tag
+  // can be NULL. Until the first push after the tile data is cleared, this finds the tiles that
+  // were cleared, which are the ones that were last drawn. Returns RLH_RESULT_ERROR_INVALID_VALUE if
+  // the terminal is not in pick mode.
+  rlhresult_t rlhTermPick(rlhTerm_h const term, const int pixel_x, const int pixel_y, rlhbool_t *const found, size_t *const tile_index, uint32_t *const tag);
+  // Pack a floating point color into 8 bits per channel.
+  rlhColor8_s rlhColorToColor8(const rlhColor_s color);
+  // Get the performance counters of a terminal. In handoff mode, only call it from the thread that
+  // pushes tiles. The counters of the draw functions are then the ones the drawing thread had when it
+  // last took a published frame.
+  rlhresult_t rlhTermGetStats(rlhTerm_h const term, rlhTermStats_t *const stats);
+  // Reset the performance counters of a terminal to 0. In handoff mode, only call it from the thread
+  // that pushes tiles.
+  rlhresult_t rlhTermResetStats(rlhTerm_h const term);
+  // Finish the recording of a terminal that was created with a record_path. Returns
+  // RLH_RESULT_ERROR_IO if any part of the recording could not be written.
+  rlhresult_t rlhTermStopRecording(rlhTerm_h const term);
+  // Open a recording file for replay. allocator_user_data is passed to RLH_MALLOC and RLH_FREE for
+  // the memory of the replay, and is the default allocator_user_data of terminals created from it.
+  rlhresult_t rlhReplayOpen(const char *const path, void *const allocator_user_data, rlhReplay_h *replay);
+  // Close a replay and free all of its resources. Terminals created from it must be destroyed first.
+  void rlhReplayClose(rlhReplay_h const replay);
+  // Create a terminal with the size and atlas that a recording started with. term_info is optional,
+  // and its size_info and atlas_info properties are ignored.
+  rlhresult_t rlhReplayCreateTerm(rlhReplay_h const replay, const rlhTermCreateInfo_t *const term_info, rlhTerm_h *term);
+  // Apply everything that was recorded up to the next draw to a terminal. has_frame is set to
+  // RLH_FALSE once the end of the recording is reached.
+  rlhresult_t rlhReplayNextFrame(rlhReplay_h const replay, rlhTerm_h const term, rlhbool_t *const has_frame);
+  // Go back to the first frame of a replay, and give the terminal back the size and atlas the
+  // recording started with.
+  rlhresult_t rlhReplayRewind(rlhReplay_h const replay, rlhTerm_h const term);
   // Draw a terminal to the current bound framebuffer of the current graphics context. Draws it to fit the viewport, which might distort pixels.
   rlhresult_t rlhTermDraw(rlhTerm_h const term);
   // Draw a terminal pixel perfect, centered in the viewport.
@@ -414,6 +1248,15 @@ extern "C"
   rlhresult_t rlhTermDrawTransformed(rlhTerm_h const term, const int translate_x, const int translate_y, const float scale_x, const float scale_y, const int viewport_width, const int viewport_height);
   // Draw a terminal transformed by a matrix 4x4 (with 16 floats)
   rlhresult_t rlhTermDrawMatrix(rlhTerm_h const term, const float *const matrix_4x4);
+  // Draw a terminal into all of a texture instead of the bound framebuffer. For the opengl backend
+  // texture must be the name of a GL_TEXTURE_2D with a color renderable format, and textures of other
+  // targets like GL_TEXTURE_2D_ARRAY are rejected. If texture is 0 the
+  // terminal draws into a texture of its own that is its scaled pixel size, or its unscaled pixel
+  // size in low res mode, which is shared with cache mode and not drawn again while cache mode sees
+  // no changes. The texture has premultiplied alpha. drawn_texture can be NULL, otherwise it is set
+  // to the texture drawn into. Returns RLH_RESULT_ERROR_INVALID_VALUE if the backend can not draw to
+  // textures or can not draw to this one.
+  rlhresult_t rlhTermDrawToTexture(rlhTerm_h const term, const uint32_t texture, uint32_t *const drawn_texture);
 
 #ifdef RLH_IMPLEMENTATION
 
@@ -421,92 +1264,120 @@ extern "C"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RLH_REPLAY_MMAP
+#endif
 
 #ifndef MAX
-#define MAX(x, y) ((x) > (y)) ? (x) : y
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+#endif
+#ifndef MIN
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+
+// If the profiling zone macros are not defined, define them to nothing so they cost nothing.
+#ifndef RLH_PROFILE_BEGIN
+#define RLH_PROFILE_BEGIN(name)
+#endif
+#ifndef RLH_PROFILE_END
+#define RLH_PROFILE_END(name)
+#endif
+
+// If the allocation macros are not defined, use the C standard library. They must all be defined
+// together. The user_data argument is the allocator_user_data of the terminal.
+#if defined(RLH_MALLOC) && defined(RLH_REALLOC) && defined(RLH_FREE)
+#elif !defined(RLH_MALLOC) && !defined(RLH_REALLOC) && !defined(RLH_FREE)
+#define RLH_MALLOC(size, user_data) ((void)(user_data), malloc(size))
+#define RLH_REALLOC(ptr, size, user_data) ((void)(user_data), realloc(ptr, size))
+#define RLH_FREE(ptr, user_data) ((void)(user_data), free(ptr))
+#else
+#error "RLH_MALLOC, RLH_REALLOC and RLH_FREE must be defined together"
+#endif
+
+// If the atomic macros are not defined, use the builtins of the compiler. They must both be defined
+// together, work on a volatile long, and be full barriers or at least acquire and release.
+#if defined(RLH_ATOMIC_LOAD) && defined(RLH_ATOMIC_EXCHANGE)
+#elif !defined(RLH_ATOMIC_LOAD) && !defined(RLH_ATOMIC_EXCHANGE)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RLH_ATOMIC_LOAD(pointer) _InterlockedOr((pointer), 0)
+#define RLH_ATOMIC_EXCHANGE(pointer, value) _InterlockedExchange((pointer), (value))
+#else
+#define RLH_ATOMIC_LOAD(pointer) __atomic_load_n((pointer), __ATOMIC_ACQUIRE)
+#define RLH_ATOMIC_EXCHANGE(pointer, value) __atomic_exchange_n((pointer), (value), __ATOMIC_ACQ_REL)
+#endif
+#else
+#error "RLH_ATOMIC_LOAD and RLH_ATOMIC_EXCHANGE must be defined together"
 #endif
 
   const char *const RLH_RESULT_DESCRIPTIONS[RLH_RESULT_COUNT] = {
       "no errors occured", "unexpected null argument",
-      "unexpected argument value", "out of memory"};
+      "unexpected argument value", "out of memory",
+      "file input or output failed"};
 
   const float RLH_OPENGL_SCREEN_MATRIX[4 * 4] = {2.0f, 0.0f, 0.0f, -1.0f, 0.0f, -2.0f, 0.0f, 1.0f,
                                                  0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
 
-  const char *RLH_VERTEX_SOURCE =
-      "#version 330 core\n"
-      "in vec2 a_pos;\n"
-      "in vec3 a_uvp;\n"
-      "in vec4 a_fg;\n"
-      "in vec4 a_bg;\n"
-      "out vec3 v_uvp;\n"
-      "out vec4 v_fg;\n"
-      "out vec4 v_bg;"
-      "uniform mat4 u_matrix;\n"
-      "void main()\n"
-      "{\n"
-      "  gl_Position = u_matrix * vec4(a_pos, 0.0, 1.0);\n"
-      "  v_uvp = a_uvp;\n"
-      "  v_fg = a_fg;\n"
-      "  v_bg = a_bg;"
-      "}";
+  const size_t RLH_FONTMAP_COORDINATES_PER_GLYPH = 5;
+  const size_t RLH_VERTICES_PER_TILE = 4;
+  const size_t RLH_ELEMENTS_PER_TILE = 6;
+  const size_t RLH_MATRIX_FLOAT_COUNT = 16;
+  // Set in the animation of a tile that repeats its glyph in every grid cell it covers.
+  const uint16_t RLH_ANIMATION_REPEAT = 0x8000;
+  // The amount of tile buffers of a terminal in handoff mode, one each for pushing, drawing, and
+  // the latest published frame in between.
+#define RLH_HANDOFF_BUFFER_COUNT 3
+  // Set in the published buffer index when the buffer has not been drawn yet.
+  const long RLH_HANDOFF_NEW = 0x4;
 
-  const char *RLH_FRAGMENT_ALPHA_BG_SOURCE =
-      "#version 330 core\n"
-      "in vec3 v_uvp;\n"
-      "in vec4 v_fg;\n"
-      "in vec4 v_bg;\n"
-      "out vec4 f_color;\n"
-      "uniform sampler2DArray u_atlas;\n"
-      "void main()\n"
-      "{\n"
-      "  vec4 tex_color = texture(u_atlas, v_uvp);\n"
-      "  vec4 actual_tex_color = vec4(tex_color.rgb, 1.0);\n"
-      "  f_color = mix(v_bg, v_fg * actual_tex_color, tex_color.a);\n"
-      "}";
+  typedef struct rlhHandoffBuffer_s
+  {
+    rlhVertex_s *vertex_data;
+    size_t tile_count;
+    size_t tile_capacity;
+    // The counters of the draw functions when the drawing thread handed the buffer back, and how
+    // many buffers it had handed back by then.
+    rlhTermStats_t draw_stats;
+    uint64_t draw_stats_sequence;
+  } rlhHandoffBuffer_s;
 
-  const char *RLH_FRAGMENT_GREEN_BG_SOURCE =
-      "#version 330 core\n"
-      "in vec3 v_uvp;\n"
-      "in vec4 v_fg;\n"
-      "in vec4 v_bg;\n"
-      "out vec4 f_color;\n"
-      "uniform sampler2DArray u_atlas;\n"
-      "void main()\n"
-      "{\n"
-      "  vec4 tex_color = texture(u_atlas, v_uvp);\n"
-      "  vec4 actual_tex_color = vec4(tex_color.r, tex_color.r, tex_color.r, 1.0);\n"
-      "  f_color = mix(v_bg, v_fg * actual_tex_color, tex_color.g);\n"
-      "}";
+  // A text laid out by rlhTermPushText(), with the grid tiles it was laid out into.
+  typedef struct rlhTextRun_s
+  {
+    uint64_t hash;
+    char *text;
+    size_t text_length;
+    rlhTextInfo_t text_info;
+    rlhGridTile8_s *tiles;
+    size_t tile_count;
+  } rlhTextRun_s;
 
-  const char *RLH_FRAGMENT_STENCIL_SOURCE =
-      "#version 330 core\n"
-      "in vec3 v_uvp;\n"
-      "in vec4 v_fg;\n"
-      "in vec4 v_bg;\n"
-      "out vec4 f_color;\n"
-      "uniform sampler2DArray u_atlas;\n"
-      "void main()\n"
-      "{\n"
-      "  vec4 tex_color = texture(u_atlas, v_uvp);\n"
-      "  f_color = mix(v_bg, v_fg, tex_color.r);\n"
-      "}";
+  // A tile that was pushed in pick mode.
+  typedef struct rlhPickRect_s
+  {
+    int x;
+    int y;
+    int width;
+    int height;
+    uint32_t tile_index;
+    uint32_t tag;
+  } rlhPickRect_s;
 
-  typedef enum rlhfragmenttype_t
+  // A tile in the list of a pick bucket.
+  typedef struct rlhPickNode_s
   {
-    RLH_FRAGMENT_NONE,
-    RLH_FRAGMENT_STENCIL,
-    RLH_FRAGMENT_GREEN_BG,
-    RLH_FRAGMENT_ALPHA_BG,
-    RLH_FRAGMENT_COUNT
-  } rlhfragmenttype_t;
+    uint32_t rect;
+    uint32_t next;
+  } rlhPickNode_s;
 
-  const size_t RLH_VERTEX_DATA_ATTRIBUTES_PER_VERTEX = 13;
-  const size_t RLH_FONTMAP_COORDINATES_PER_GLYPH = 5;
-  const size_t RLH_VERTICES_PER_TILE = 4;
-  const size_t RLH_ELEMENTS_PER_TILE = 6;
-  const size_t RLH_MATRIX_FLOAT_COUNT = 16;
-  GLint RLH_ATLAS_TEXTURE_SLOT = 0;
+  // Tiles that cover more pick buckets than this are kept in one list instead, so a fill or a large
+  // rect is not put in every bucket.
+#define RLH_PICK_MAX_BUCKETS 64
 
   typedef struct rlhTerm_s
   {
@@ -521,138 +1392,141 @@ extern "C"
     size_t tile_height;
     size_t vertex_data_tile_capacity;
     size_t vertex_data_tile_count;
-    float *vertex_data;
+    rlhVertex_s *vertex_data;
     rlhbool_t vertex_data_changed;
-    size_t atlas_width;
-    size_t atlas_height;
-    size_t atlas_pages;
+    // Memory
+    void *allocator_user_data;
+    rlhbool_t vertex_data_is_arena;
+    rlhbool_t vertex_data_is_owned;
+    size_t shrink_interval;
+    size_t shrink_clear_count;
+    size_t vertex_data_high_water;
+    struct rlhRecorder_s *recorder;
+    // Palette
+    rlhbool_t palette_mode;
+    rlhbool_t palette_changed;
+    rlhColor8_s palette[RLH_PALETTE_SIZE];
+    // Asynchronous atlas upload
+    rlhatlasupload_t atlas_upload_state;
+    int atlas_upload_pages_per_draw;
+    rlhAtlasCreateInfo_t atlas_upload_info;
+    float *atlas_upload_stpqp;
+    uint8_t *atlas_upload_record_pixels;
+    // Animations
+    rlhAnimationInfo_t animations[RLH_ANIMATION_COUNT];
+    rlhbool_t animation_is_set[RLH_ANIMATION_COUNT];
+    rlhbool_t animations_used;
+    rlhbool_t animation_time_changed;
+    double animation_time;
+    // Light map
+    rlhColor8_s *light_map;
+    rlhbool_t light_map_changed;
+    // Rects
+    rlhbool_t cells_changed;
+    // Moving tiles
+    float motion_alpha;
+    rlhbool_t motion_changed;
+    rlhbool_t motions_used;
+    // Particles, with the ones emitted since the last draw and the seconds to move them by
+    size_t particle_capacity;
+    rlhParticle_s *particles;
+    size_t particle_count;
+    size_t particle_array_capacity;
+    float particle_seconds;
+    uint32_t particle_random;
+    // Pick mode, with the rects of the pushed tiles and the lists of the ones in each bucket. The
+    // lists are 1 based indices into the nodes, newest first, and tiles that cover too many buckets
+    // are in a list of their own. The index is stale from when the tile data is cleared until the
+    // next push starts it over.
+    rlhbool_t pick_mode;
+    rlhbool_t pick_stale;
+    rlhbool_t pick_failed;
+    uint32_t pick_tag;
+    rlhPickRect_s *pick_rects;
+    size_t pick_rect_count;
+    size_t pick_rect_capacity;
+    rlhPickNode_s *pick_nodes;
+    size_t pick_node_count;
+    size_t pick_node_capacity;
+    uint32_t *pick_buckets;
+    int pick_buckets_wide;
+    int pick_buckets_tall;
+    int pick_bucket_width;
+    int pick_bucket_height;
+    uint32_t pick_large;
+    // Visibility mask
+    uint8_t *visibility_mask;
+    // Cache mode
+    rlhbool_t cache_mode;
+    rlhbool_t low_res_mode;
+    rlhbool_t cache_valid;
+    uint64_t cache_hash;
+    size_t cache_tile_count;
+    // The texture of the terminal itself from rlhTermDrawToTexture(), or 0 before it has one.
+    uint32_t texture;
+    // Handoff mode. The pushing thread owns the write buffer, which is vertex_data while it is
+    // pushed to, and the drawing thread owns the read buffer. They swap buffers with the published
+    // one through handoff_published.
+    rlhbool_t handoff_mode;
+    rlhHandoffBuffer_s handoff_buffers[RLH_HANDOFF_BUFFER_COUNT];
+    long handoff_write;
+    long handoff_read;
+    volatile long handoff_published;
+    rlhbool_t handoff_frame_changed;
+    // Text
+    rlhTextRun_s text_runs[RLH_TEXT_CACHE_SIZE];
     size_t glyph_count;
     float *glyph_stpqp;
     size_t element_glyph_count;
-    GLuint *element_data;
-    rlhcolortype_t atlas_color;
-    rlhfragmenttype_t fragment_type;
-
-    // OpenGL
-    GLuint gl_program;
-    GLuint gl_vertex_array;
-    GLuint gl_vertex_buffer;
-    GLuint gl_element_buffer;
-    GLuint gl_matrix_uniform_location;
-    GLuint gl_atlas_texture_2d_array;
-  } rlhTerm_s;
-
-  static inline GLenum _rlhColorTypeToGlFormat(const rlhcolortype_t color)
-  {
-    switch (color)
-    {
-    case RLH_COLOR_G:
-      return GL_RED;
-    case RLH_COLOR_GA:
-      return GL_RG;
-    case RLH_COLOR_RGBA:
-      return GL_RGBA;
-    case RLH_COLOR_BGRA:
-      return GL_BGRA;
-    default:
-      return GL_NONE;
-    }
-  }
+    uint32_t *element_data;
 
-  static inline GLenum _rlhColorTypeToGlInternalFormat(const rlhcolortype_t color)
-  {
-    switch (color)
-    {
-    case RLH_COLOR_G:
-      return GL_R8;
-    case RLH_COLOR_GA:
-      return GL_RG;
-    case RLH_COLOR_RGBA:
-    case RLH_COLOR_BGRA:
-      return GL_RGBA;
-    default:
-      return GL_NONE;
-    }
-  }
-
-  static inline GLenum _rlhChannelSizeToType(const size_t channel_size)
-  {
-    switch (channel_size)
-    {
-    case 1:
-      return GL_UNSIGNED_BYTE;
-    case 2:
-      return GL_UNSIGNED_SHORT;
-    case 4:
-      return GL_UNSIGNED_INT;
-    default:
-      return GL_NONE;
-    }
-  }
+    // Backend
+    const rlhBackend_t *backend;
+    void *backend_data;
 
-  static inline rlhresult_t _rlhCreateGlTextureArray(const rlhAtlasCreateInfo_t *const atlas_info, GLint *const gl_texture_2d_array)
-  {
-    *gl_texture_2d_array = GL_NONE;
-    const GLenum format = _rlhColorTypeToGlFormat(atlas_info->color);
-    const GLenum internal_format = _rlhColorTypeToGlInternalFormat(atlas_info->color);
-    const GLenum pixel_type = _rlhChannelSizeToType(atlas_info->channel_size);
-    if (internal_format == GL_NONE || format == GL_NONE)
-    {
-      return RLH_RESULT_ERROR_INVALID_VALUE;
-    }
-    GLD_START();
-    GLD_CALL(glGenTextures(1, gl_texture_2d_array));
-    GLD_CALL(glBindTexture(GL_TEXTURE_2D_ARRAY, *gl_texture_2d_array));
-    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0));
-    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0));
-    GLD_CALL(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internal_format, atlas_info->width, atlas_info->height, atlas_info->pages, 0, format, pixel_type, atlas_info->pixel_data));
-    return RLH_RESULT_OK;
-  }
+    // The draw functions count into draw_stats, and everything else into stats. In handoff mode the
+    // pushing thread only reads draw_stats through the copy in handoff_draw_stats, the newest one
+    // handed back with a buffer. Resetting the stats remembers the draw counters in draw_stats_base
+    // instead of clearing them, because they can belong to the other thread.
+    rlhTermStats_t stats;
+    rlhTermStats_t draw_stats;
+    rlhTermStats_t draw_stats_base;
+    uint64_t draw_stats_sequence;
+    rlhTermStats_t handoff_draw_stats;
+    uint64_t handoff_draw_stats_sequence;
+  } rlhTerm_s;
 
-  static inline GLuint _rlhCreateGlProgram(const char *vertex_source, const char *fragment_source)
+#ifdef RLH_STATS_TIMERS
+  // Get a monotonic time in nanoseconds for measuring durations. Strict C99 has neither
+  // clock_gettime() nor timespec_get(), so it falls back to the processor time of clock().
+  static inline uint64_t _rlhNowNs(void)
   {
-    GLint gl_program, gl_vertex_shader, gl_fragment_shader;
-    GLD_CALL(gl_vertex_shader = glCreateShader(GL_VERTEX_SHADER));
-    GLD_CALL(glShaderSource(gl_vertex_shader, 1, &vertex_source, NULL));
-    GLD_COMPILE(gl_vertex_shader, "rlh vertex shader");
-    GLD_CALL(gl_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER));
-    GLD_CALL(glShaderSource(gl_fragment_shader, 1, &fragment_source, NULL));
-    GLD_COMPILE(gl_fragment_shader, "rlh fragment shader");
-    GLD_CALL(gl_program = glCreateProgram());
-    GLD_CALL(glAttachShader(gl_program, gl_vertex_shader));
-    GLD_CALL(glAttachShader(gl_program, gl_fragment_shader));
-    GLD_LINK(gl_program, "rlh shader program");
-    GLD_CALL(glDetachShader(gl_program, gl_vertex_shader));
-    GLD_CALL(glDetachShader(gl_program, gl_fragment_shader));
-    GLD_CALL(glDeleteShader(gl_vertex_shader));
-    GLD_CALL(glDeleteShader(gl_fragment_shader));
-    return gl_program;
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#elif defined(TIME_UTC) && (defined(__cplusplus) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L))
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#else
+    return (uint64_t)((double)clock() * (1000000000.0 / CLOCKS_PER_SEC));
+#endif
   }
+#endif
 
   static inline size_t _rlhGetVertexDataSize(size_t tile_count)
   {
     return tile_count *
-           RLH_VERTEX_DATA_ATTRIBUTES_PER_VERTEX *
            RLH_VERTICES_PER_TILE *
-           sizeof(float);
-  }
-
-  static inline size_t _rlhGetVertexAttributeCount(size_t tile_count)
-  {
-    return tile_count *
-           RLH_VERTEX_DATA_ATTRIBUTES_PER_VERTEX *
-           RLH_VERTICES_PER_TILE;
+           sizeof(rlhVertex_s);
   }
 
   static inline size_t _rlhGetElementDataSize(size_t tile_count)
   {
     return tile_count *
            RLH_ELEMENTS_PER_TILE *
-           sizeof(GLuint);
+           sizeof(uint32_t);
   }
 
   static inline size_t _rlhGetElementCount(size_t tile_count)
@@ -661,19 +1535,19 @@ extern "C"
            RLH_ELEMENTS_PER_TILE;
   }
 
-  static inline rlhresult_t _rlhTermTryAppendElements(rlhTerm_h const term)
+  static inline rlhresult_t _rlhTermTryAppendElements(rlhTerm_h const term, const size_t tile_count)
   {
-    if (term->element_glyph_count >= term->vertex_data_tile_count)
+    if (term->element_glyph_count >= tile_count)
       return RLH_RESULT_OK;
-    unsigned int *new_element_data = realloc(term->element_data, _rlhGetElementDataSize(term->vertex_data_tile_count));
+    uint32_t *new_element_data = (uint32_t *)RLH_REALLOC(term->element_data, _rlhGetElementDataSize(tile_count), term->allocator_user_data);
     if (new_element_data == NULL)
     {
       return RLH_RESULT_ERROR_OUT_OF_MEMORY;
     }
     term->element_data = new_element_data;
-    for (; term->element_glyph_count < term->vertex_data_tile_count; term->element_glyph_count++)
+    for (; term->element_glyph_count < tile_count; term->element_glyph_count++)
     {
-      const GLuint vert0 = term->element_glyph_count * RLH_VERTICES_PER_TILE;
+      const uint32_t vert0 = term->element_glyph_count * RLH_VERTICES_PER_TILE;
       size_t element_data_i = term->element_glyph_count * RLH_ELEMENTS_PER_TILE;
       term->element_data[element_data_i++] = vert0;
       term->element_data[element_data_i++] = vert0 + 1;
@@ -685,43 +1559,56 @@ extern "C"
     return RLH_RESULT_OK;
   }
 
-  static inline rlhfragmenttype_t _rlhColorTypeToFragmentType(rlhcolortype_t color)
+  static inline rlhresult_t _rlhSizeInfoCheck(rlhTermSizeInfo_t *size_info)
   {
-    switch (color)
+    if (size_info == NULL)
     {
-    case RLH_COLOR_G:
-      return RLH_FRAGMENT_STENCIL;
-    case RLH_COLOR_GA:
-      return RLH_FRAGMENT_GREEN_BG;
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
     }
-    return RLH_FRAGMENT_ALPHA_BG;
+    if (
+        size_info->width <= 0 ||
+        size_info->height <= 0 ||
+        size_info->size_mode < RLH_SIZE_TILES ||
+        size_info->size_mode >= RLH_SIZE_MODE_COUNT ||
+        size_info->tile_width <= 0 ||
+        size_info->tile_height <= 0)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    return RLH_RESULT_OK;
   }
 
-  static inline const char *_rlhFragmentSourceFromFragmentType(rlhfragmenttype_t fragment)
+  static inline size_t _rlhGetColorChannelCount(const rlhcolortype_t color)
   {
-    switch (fragment)
+    switch (color)
     {
-    case RLH_FRAGMENT_STENCIL:
-      return RLH_FRAGMENT_STENCIL_SOURCE;
-    case RLH_FRAGMENT_GREEN_BG:
-      return RLH_FRAGMENT_GREEN_BG_SOURCE;
+    case RLH_COLOR_G:
+      return 1;
+    case RLH_COLOR_GA:
+      return 2;
+    default:
+      return 4;
     }
-    return RLH_FRAGMENT_ALPHA_BG_SOURCE;
   }
 
-  static inline rlhresult_t _rlhSizeInfoCheck(rlhTermSizeInfo_t *size_info)
+  static inline uint64_t _rlhGetAtlasPixelDataSize(const rlhAtlasCreateInfo_t *const atlas_info)
+  {
+    return (uint64_t)atlas_info->width *
+           (uint64_t)atlas_info->height *
+           (uint64_t)atlas_info->pages *
+           _rlhGetColorChannelCount(atlas_info->color) *
+           (uint64_t)atlas_info->channel_size;
+  }
+
+  static inline rlhresult_t _rlhAtlasLayoutCheck(const rlhAtlasCreateInfo_t *const atlas_info)
   {
-    if (size_info == NULL)
-    {
-      return RLH_RESULT_ERROR_NULL_ARGUMENT;
-    }
     if (
-        size_info->width <= 0 ||
-        size_info->height <= 0 ||
-        size_info->size_mode < RLH_SIZE_TILES ||
-        size_info->size_mode >= RLH_SIZE_MODE_COUNT ||
-        size_info->tile_width <= 0 ||
-        size_info->tile_height <= 0)
+        atlas_info->width <= 0 ||
+        atlas_info->height <= 0 ||
+        atlas_info->pages <= 0 ||
+        atlas_info->color < RLH_COLOR_G ||
+        atlas_info->color >= RLH_COLOR_TYPE_COUNT ||
+        atlas_info->glyph_count <= 0)
     {
       return RLH_RESULT_ERROR_INVALID_VALUE;
     }
@@ -736,17 +1623,7 @@ extern "C"
     {
       return RLH_RESULT_ERROR_NULL_ARGUMENT;
     }
-    if (
-        atlas_info->width <= 0 ||
-        atlas_info->height <= 0 ||
-        atlas_info->pages <= 0 ||
-        atlas_info->color < RLH_COLOR_G ||
-        atlas_info->color >= RLH_COLOR_TYPE_COUNT ||
-        atlas_info->glyph_count <= 0)
-    {
-      return RLH_RESULT_ERROR_INVALID_VALUE;
-    }
-    return RLH_RESULT_OK;
+    return _rlhAtlasLayoutCheck(atlas_info);
   }
 
   static inline rlhresult_t _rlhTermInfoCheck(rlhTermCreateInfo_t *term_info)
@@ -761,7 +1638,19 @@ extern "C"
     {
       return result;
     }
-    return _rlhAtlasInfoCheck(term_info->atlas_info);
+    result = _rlhAtlasInfoCheck(term_info->atlas_info);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    if (
+        term_info->tile_arena_size != 0 &&
+        (term_info->tile_arena_size < _rlhGetVertexDataSize(1) ||
+         (uintptr_t)term_info->tile_arena % sizeof(float) != 0))
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    return RLH_RESULT_OK;
   }
 
   static inline void _rlhTermSetPixelSize(rlhTerm_h term, rlhTermSizeInfo_t *size_info)
@@ -781,8 +1670,8 @@ extern "C"
       term->unscaled_pixel_height = term->scaled_pixel_height / size_info->pixel_scale;
       if (size_info->floor_pixels_to_tiles)
       {
-        term->unscaled_pixel_width -= term->unscaled_pixel_width % (size_info->tile_width * size_info->pixel_scale);
-        term->unscaled_pixel_height -= term->unscaled_pixel_height % (size_info->tile_height * size_info->pixel_scale);
+        term->unscaled_pixel_width -= term->unscaled_pixel_width % size_info->tile_width;
+        term->unscaled_pixel_height -= term->unscaled_pixel_height % size_info->tile_height;
       }
       // cut off pixels in situations the given width and height is not perfectly divisible by pixel scale.
       term->scaled_pixel_width = term->unscaled_pixel_width * size_info->pixel_scale;
@@ -794,8 +1683,8 @@ extern "C"
       term->unscaled_pixel_height = size_info->height;
       if (size_info->floor_pixels_to_tiles)
       {
-        term->unscaled_pixel_width -= term->unscaled_pixel_width % (size_info->tile_width * size_info->pixel_scale);
-        term->unscaled_pixel_height -= term->unscaled_pixel_height % (size_info->tile_height * size_info->pixel_scale);
+        term->unscaled_pixel_width -= term->unscaled_pixel_width % size_info->tile_width;
+        term->unscaled_pixel_height -= term->unscaled_pixel_height % size_info->tile_height;
       }
       term->scaled_pixel_width = term->unscaled_pixel_width * size_info->pixel_scale;
       term->scaled_pixel_height = term->unscaled_pixel_height * size_info->pixel_scale;
@@ -805,304 +1694,3353 @@ extern "C"
     term->tile_height = size_info->tile_height;
     term->tiles_wide = term->unscaled_pixel_width / size_info->tile_width;
     term->tiles_tall = term->unscaled_pixel_height / size_info->tile_height;
+    term->cells_changed = RLH_TRUE;
+    term->motion_changed = RLH_TRUE;
   }
 
-  static inline rlhresult_t _rlhTermSetAtlas(rlhTerm_h term, rlhAtlasCreateInfo_t *atlas_info)
+  static rlhresult_t _rlhNullCreate(void *user_data, void **backend_data)
   {
-    const size_t stpqp_size = atlas_info->glyph_count * RLH_FONTMAP_COORDINATES_PER_GLYPH * sizeof(float);
-    float *glyph_stpqp = realloc(term->glyph_stpqp, stpqp_size);
-    if (glyph_stpqp == NULL)
-    {
-      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
-    }
-    term->glyph_stpqp = glyph_stpqp;
-    GLD_START();
-    GLint gl_atlas_texture_2d_array = GL_NONE;
-    rlhresult_t result = _rlhCreateGlTextureArray(atlas_info, &gl_atlas_texture_2d_array);
-    if (result != RLH_RESULT_OK)
-    {
-      return result;
-    }
-    rlhfragmenttype_t fragment_type = _rlhColorTypeToFragmentType(atlas_info->color);
-    if (fragment_type != term->fragment_type)
-    {
-      if (term->gl_program != GL_NONE)
-      {
-        GLD_CALL(glDeleteProgram(term->gl_program));
-        term->gl_program = GL_NONE;
-      }
-      const char *fragment_source = _rlhFragmentSourceFromFragmentType(fragment_type);
-      term->gl_program = _rlhCreateGlProgram(RLH_VERTEX_SOURCE, fragment_source);
-      GLD_CALL(glUseProgram(term->gl_program));
-      term->gl_matrix_uniform_location = GLD_CALL(glGetUniformLocation(term->gl_program, "u_matrix"));
-      GLuint atlas_slot_uniform = GLD_CALL(glGetUniformLocation(term->gl_program, "u_atlas"));
-      GLD_CALL(glUniform1i(atlas_slot_uniform, RLH_ATLAS_TEXTURE_SLOT));
-    }
-    term->fragment_type = fragment_type;
-    if (term->gl_atlas_texture_2d_array != GL_NONE)
-    {
-      GLD_CALL(glDeleteTextures(1, &term->gl_atlas_texture_2d_array));
-      term->gl_atlas_texture_2d_array = GL_NONE;
-    }
-    term->gl_atlas_texture_2d_array = gl_atlas_texture_2d_array;
-    memcpy(term->glyph_stpqp, atlas_info->glyph_stpqp, stpqp_size);
-    term->glyph_count = atlas_info->glyph_count;
+    (void)user_data;
+    *backend_data = NULL;
     return RLH_RESULT_OK;
   }
 
-  void rlhClearColor(const rlhColor_s color)
-  {
-    GLD_START();
-    GLD_CALL(glClearColor(color.r, color.g, color.b, color.a));
-    GLD_CALL(glClear(GL_COLOR_BUFFER_BIT));
-  }
-
-  void rlhViewport(const int x, const int y, const int width, const int height)
+  static void _rlhNullDestroy(void *backend_data)
   {
-    GLD_START();
-    GLD_CALL(glViewport(x, y, width, height));
+    (void)backend_data;
   }
 
-  rlhresult_t rlhTermCreate(rlhTermCreateInfo_t *term_info, rlhTerm_h *term)
+  static rlhresult_t _rlhNullCreateAtlas(void *backend_data, const rlhAtlasCreateInfo_t *atlas_info)
   {
-    if (term == NULL)
-    {
-      return RLH_RESULT_ERROR_NULL_ARGUMENT;
-    }
-    rlhresult_t result = _rlhTermInfoCheck(term_info);
-    if (result != RLH_RESULT_OK)
-    {
-      return result;
-    }
-    rlhTerm_h term_h = (rlhTerm_h)malloc(sizeof(rlhTerm_s));
-    if (term_h == NULL)
+    (void)backend_data;
+    if (atlas_info->channel_size != 1 && atlas_info->channel_size != 2 && atlas_info->channel_size != 4)
     {
-      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      return RLH_RESULT_ERROR_INVALID_VALUE;
     }
+    return RLH_RESULT_OK;
+  }
 
-    memset(term_h, 0, sizeof(rlhTerm_s));
-    _rlhTermSetPixelSize(
-        term_h,
-        term_info->size_info);
-    term_h->vertex_data_tile_capacity = term_h->tiles_wide * term_h->tiles_tall;
-    const size_t vertex_data_size = _rlhGetVertexDataSize(term_h->vertex_data_tile_capacity);
-    term_h->vertex_data = malloc(vertex_data_size);
-    if (term_h->vertex_data == NULL)
-    {
-      free(term_h);
-      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
-    }
-    result = _rlhTermSetAtlas(term_h, term_info->atlas_info);
-    if (result != RLH_RESULT_OK)
-    {
-      free(term_h);
-      return result;
-    }
-    *term = term_h;
+  static rlhresult_t _rlhNullUploadVertices(void *backend_data, const rlhVertex_s *vertex_data, size_t vertex_data_size)
+  {
+    (void)backend_data;
+    (void)vertex_data;
+    (void)vertex_data_size;
     return RLH_RESULT_OK;
   }
 
-  void rlhTermDestroy(rlhTerm_h const term)
+  static rlhresult_t _rlhNullUploadElements(void *backend_data, const uint32_t *element_data, size_t element_data_size)
   {
-    if (term == NULL)
-      return;
-    free(term->vertex_data);
-    term->vertex_data = NULL;
-    free(term->glyph_stpqp);
-    term->glyph_stpqp = NULL;
-    free(term->element_data);
-    term->element_data = NULL;
-    GLD_START();
-    if (term->gl_vertex_array != GL_NONE)
-    {
-      GLD_CALL(glDeleteVertexArrays(1, &term->gl_vertex_array));
-      term->gl_vertex_array = GL_NONE;
-    }
-    if (term->gl_vertex_buffer != GL_NONE)
-    {
-      GLD_CALL(glDeleteBuffers(1, &term->gl_vertex_buffer));
-      term->gl_vertex_buffer = GL_NONE;
-    }
-    if (term->gl_element_buffer != GL_NONE)
-    {
-      GLD_CALL(glDeleteBuffers(1, &term->gl_element_buffer));
-      term->gl_element_buffer = GL_NONE;
-    }
-    if (term->gl_program != GL_NONE)
-    {
-      GLD_CALL(glDeleteProgram(term->gl_program));
-    }
-    if (term->gl_atlas_texture_2d_array != GL_NONE)
-    {
-      GLD_CALL(glDeleteTextures(1, &term->gl_atlas_texture_2d_array));
-      term->gl_atlas_texture_2d_array = GL_NONE;
-    }
-    free(term);
+    (void)backend_data;
+    (void)element_data;
+    (void)element_data_size;
+    return RLH_RESULT_OK;
   }
 
-  rlhresult_t rlhTermSetAtlas(rlhTerm_h const term, rlhAtlasCreateInfo_t *atlas_info)
+  static rlhresult_t _rlhNullDraw(void *backend_data, const float *matrix_4x4, size_t element_count, const rlhScissor_t *scissor)
   {
-    if (term == NULL)
-    {
-      return RLH_RESULT_ERROR_NULL_ARGUMENT;
-    }
-    rlhresult_t result = _rlhAtlasInfoCheck(atlas_info);
-    if (result != RLH_RESULT_OK)
-    {
-      return result;
-    }
-    return _rlhTermSetAtlas(term, atlas_info);
+    (void)backend_data;
+    (void)matrix_4x4;
+    (void)element_count;
+    (void)scissor;
+    return RLH_RESULT_OK;
   }
 
-  int rlhTermGetGlyphCount(rlhTerm_h const term)
+  static rlhresult_t _rlhNullSetPalette(void *backend_data, const rlhColor8_s *palette)
   {
-    if (term == NULL)
-    {
-      return 0;
-    }
-    return (int)term->glyph_count;
+    (void)backend_data;
+    (void)palette;
+    return RLH_RESULT_OK;
   }
 
-  float rlhTermGetPixelScale(rlhTerm_h const term)
+  static rlhresult_t _rlhNullSetAnimation(void *backend_data, uint16_t animation, const rlhAnimationInfo_t *animation_info, const float *glyph_stpqp)
   {
-    if (term == NULL)
-    {
-      return 0.0f;
-    }
-    return term->pixel_scale;
+    (void)backend_data;
+    (void)animation;
+    (void)animation_info;
+    (void)glyph_stpqp;
+    return RLH_RESULT_OK;
   }
 
-  void rlhTermGetTerminalSize(rlhTerm_h const term, int *const tiles_wide, int *const tiles_tall)
+  static rlhresult_t _rlhNullSetAnimationTime(void *backend_data, float seconds)
   {
-    if (term == NULL)
-    {
-      return;
-    }
-    if (tiles_wide != NULL)
-    {
-      *tiles_wide = (int)term->tiles_wide;
-    }
-    if (tiles_tall != NULL)
-    {
-      *tiles_tall = (int)term->tiles_tall;
-    }
+    (void)backend_data;
+    (void)seconds;
+    return RLH_RESULT_OK;
   }
 
-  void rlhTermGetScaledPixelSize(rlhTerm_h const term, int *const pixel_width, int *const pixel_height)
+  static rlhresult_t _rlhNullSetLightMap(void *backend_data, const rlhColor8_s *light_map, int width, int height, float cells_wide, float cells_tall)
   {
-    if (term == NULL)
-    {
-      return;
-    }
-    if (pixel_width != NULL)
-    {
-      *pixel_width = (int)term->scaled_pixel_width;
-    }
-    if (pixel_height != NULL)
-    {
-      *pixel_height = (int)term->scaled_pixel_height;
-    }
+    (void)backend_data;
+    (void)light_map;
+    (void)width;
+    (void)height;
+    (void)cells_wide;
+    (void)cells_tall;
+    return RLH_RESULT_OK;
   }
 
-  void rlhTermGetUnscaledPixelSize(rlhTerm_h const term, int *const pixel_width, int *const pixel_height)
+  static rlhresult_t _rlhNullDrawCached(void *backend_data, const float *matrix_4x4, size_t element_count, const rlhScissor_t *scissor, int cache_width, int cache_height, rlhbool_t redraw)
   {
-    if (term == NULL)
-    {
-      return;
-    }
-    if (pixel_width != NULL)
-    {
-      *pixel_width = (int)term->unscaled_pixel_width;
-    }
-    if (pixel_height != NULL)
-    {
-      *pixel_height = (int)term->unscaled_pixel_height;
-    }
+    (void)backend_data;
+    (void)matrix_4x4;
+    (void)element_count;
+    (void)scissor;
+    (void)cache_width;
+    (void)cache_height;
+    (void)redraw;
+    return RLH_RESULT_OK;
   }
 
-  void rlhTermGetTileSize(rlhTerm_h const term, int *const tile_width, int *const tile_height)
+  static rlhresult_t _rlhNullDrawToTexture(void *backend_data, size_t element_count, uint32_t texture, int width, int height, uint32_t *drawn_texture)
   {
-    if (term == NULL)
-    {
-      return;
-    }
-    if (tile_width != NULL)
-    {
-      *tile_width = (int)term->tile_width;
-    }
-    if (tile_height != NULL)
-    {
-      *tile_height = (int)term->tile_height;
-    }
+    (void)backend_data;
+    (void)element_count;
+    (void)width;
+    (void)height;
+    *drawn_texture = texture;
+    return RLH_RESULT_OK;
   }
 
-  rlhresult_t rlhTermSetSize(rlhTerm_h const term, rlhTermSizeInfo_t *const size_info)
+  static rlhresult_t _rlhNullSetCells(void *backend_data, float cells_wide, float cells_tall)
   {
-    if (term == NULL || size_info == NULL)
-    {
-      return RLH_RESULT_ERROR_NULL_ARGUMENT;
-    }
-    rlhresult_t result = _rlhSizeInfoCheck(size_info);
-    if (result != RLH_RESULT_OK)
-    {
-      return result;
-    }
-    _rlhTermSetPixelSize(
-        term,
-        size_info);
+    (void)backend_data;
+    (void)cells_wide;
+    (void)cells_tall;
+    return RLH_RESULT_OK;
   }
 
-  rlhresult_t rlhTermClearTileData(rlhTerm_h term)
+  static rlhresult_t _rlhNullSetMotion(void *backend_data, float alpha, float pixels_wide, float pixels_tall)
   {
-    if (term == NULL)
-    {
-      return RLH_RESULT_ERROR_NULL_ARGUMENT;
-    }
-    term->vertex_data_tile_count = 0;
+    (void)backend_data;
+    (void)alpha;
+    (void)pixels_wide;
+    (void)pixels_tall;
     return RLH_RESULT_OK;
   }
 
-  int rlhTermGetTileDataCount(rlhTerm_h const term)
+  static rlhresult_t _rlhNullSetParticleCapacity(void *backend_data, size_t capacity)
   {
-    if (term == NULL)
-    {
-      return 0;
-    }
-    return (int)term->vertex_data_tile_count;
+    (void)backend_data;
+    (void)capacity;
+    return RLH_RESULT_OK;
   }
 
-  static inline rlhbool_t _rlhTermTryReserveVertexData(rlhTerm_h const term)
+  static rlhresult_t _rlhNullUpdateParticles(void *backend_data, float seconds, const rlhParticle_s *particles, size_t count)
   {
-    // If we hit the reserved tile count, double the amount of reserved space.
-    if (term->vertex_data_tile_count < term->vertex_data_tile_capacity)
-      return RLH_TRUE;
-    size_t new_capacity = (term->vertex_data_tile_capacity == 0) ? 8 : term->vertex_data_tile_capacity * 2;
-    float *new_vertex_data = (float *)realloc(
-        term->vertex_data,
-        _rlhGetVertexDataSize(new_capacity));
-    if (new_vertex_data == NULL)
-    {
-      return RLH_FALSE; // out of memory
-    }
-    term->vertex_data = new_vertex_data;
-    term->vertex_data_tile_capacity = new_capacity;
-    return RLH_TRUE;
+    (void)backend_data;
+    (void)seconds;
+    (void)particles;
+    (void)count;
+    return RLH_RESULT_OK;
   }
 
-  static inline void _rlhTermPushTile(rlhTerm_h const term, const int pixel_x, const int pixel_y,
-                                      const int pixel_w, const int pixel_h, const uint16_t glyph,
-                                      const rlhColor_s fg, const rlhColor_s bg)
+  static rlhresult_t _rlhNullDrawParticles(void *backend_data, const float *matrix_4x4, const rlhScissor_t *scissor, float pixels_wide, float pixels_tall)
   {
-    if (glyph > term->glyph_count)
-      return;
-    if (!(
-            pixel_x + pixel_w > 0 &&
-            pixel_x < term->unscaled_pixel_width &&
-            pixel_y + pixel_h > 0 &&
-            pixel_y < term->unscaled_pixel_height))
-    {
-      return;
-    }
+    (void)backend_data;
+    (void)matrix_4x4;
+    (void)scissor;
+    (void)pixels_wide;
+    (void)pixels_tall;
+    return RLH_RESULT_OK;
+  }
+
+  const rlhBackend_t RLH_BACKEND_NULL = {
+      "null",
+      NULL,
+      _rlhNullCreate,
+      _rlhNullDestroy,
+      _rlhNullCreateAtlas,
+      _rlhNullUploadVertices,
+      _rlhNullUploadElements,
+      _rlhNullDraw,
+      NULL,
+      _rlhNullSetPalette,
+      NULL,
+      NULL,
+      NULL,
+      _rlhNullSetAnimation,
+      _rlhNullSetAnimationTime,
+      _rlhNullSetLightMap,
+      _rlhNullDrawCached,
+      _rlhNullDrawToTexture,
+      _rlhNullSetCells,
+      _rlhNullSetMotion,
+      _rlhNullSetParticleCapacity,
+      _rlhNullUpdateParticles,
+      _rlhNullDrawParticles};
+
+#ifndef RLH_NO_OPENGL
+  const char *RLH_VERTEX_SOURCE =
+      "#version 330 core\n"
+      "layout(location = 0) in vec2 a_pos;\n"
+      "layout(location = 1) in vec2 a_uv;\n"
+      "layout(location = 2) in vec4 a_fg;\n"
+      "layout(location = 3) in vec4 a_bg;\n"
+      "layout(location = 4) in uvec2 a_page_animation;\n"
+      "layout(location = 5) in vec2 a_motion;\n"
+      "out vec2 v_pos;\n"
+      "out vec3 v_uvp;\n"
+      "out vec4 v_fg;\n"
+      "out vec4 v_bg;\n"
+      "flat out int v_repeat;\n"
+      "flat out vec4 v_glyph;\n"
+      "uniform mat4 u_matrix;\n"
+      "uniform bool u_palette_mode;\n"
+      "uniform sampler2D u_palette;\n"
+      "uniform sampler2D u_animations;\n"
+      "uniform sampler2D u_glyphs;\n"
+      "uniform float u_time;\n"
+      "uniform float u_motion_alpha;\n"
+      "uniform vec2 u_motion_scale;\n"
+      "vec4 palette_color(float index)\n"
+      "{\n"
+      "  return texelFetch(u_palette, ivec2(int(index * 255.0 + 0.5), 0), 0);\n"
+      "}\n"
+      "vec4 tile_color(vec4 color)\n"
+      "{\n"
+      "  return u_palette_mode ? palette_color(color.r) : color;\n"
+      "}\n"
+      "void main()\n"
+      "{\n"
+      "  // moving tiles are drawn between their previous and current positions\n"
+      "  vec2 pos = a_pos - a_motion * u_motion_scale * (1.0 - u_motion_alpha);\n"
+      "  gl_Position = u_matrix * vec4(pos, 0.0, 1.0);\n"
+      "  v_pos = pos;\n"
+      "  v_uvp = vec3(a_uv, float(a_page_animation.x));\n"
+      "  v_fg = tile_color(a_fg);\n"
+      "  v_bg = tile_color(a_bg);\n"
+      "  v_repeat = int(a_page_animation.y >> 15);\n"
+      "  // a tile that repeats has the index of its glyph in s, and looks up where the glyph is\n"
+      "  int glyph = int(a_uv.x);\n"
+      "  int glyphs_wide = textureSize(u_glyphs, 0).x;\n"
+      "  v_glyph = v_repeat == 0 ? vec4(0.0) : texelFetch(u_glyphs, ivec2(glyph % glyphs_wide, glyph / glyphs_wide), 0);\n"
+      "  uint animation = a_page_animation.y & 0x7fffu;\n"
+      "  if (animation != 0u)\n"
+      "  {\n"
+      "    int row = int(animation);\n"
+      "    // frame count, frame duration and color period\n"
+      "    vec4 timing = texelFetch(u_animations, ivec2(0, row), 0);\n"
+      "    if (timing.x > 1.0)\n"
+      "    {\n"
+      "      int frame = int(mod(floor(u_time / timing.y), timing.x));\n"
+      "      vec4 stpq = texelFetch(u_animations, ivec2(3 + frame * 2, row), 0);\n"
+      "      float page = texelFetch(u_animations, ivec2(4 + frame * 2, row), 0).x;\n"
+      "      // every tile is 4 vertices, in the order top left, top right, bottom left, bottom right\n"
+      "      int corner = gl_VertexID % 4;\n"
+      "      v_uvp = vec3((corner & 1) == 0 ? stpq.x : stpq.y, (corner & 2) == 0 ? stpq.z : stpq.w, page);\n"
+      "      v_glyph = stpq;\n"
+      "    }\n"
+      "    if (timing.z > 0.0)\n"
+      "    {\n"
+      "      float weight = 0.5 - 0.5 * cos(6.28318531 * u_time / timing.z);\n"
+      "      v_fg = mix(v_fg, tile_color(texelFetch(u_animations, ivec2(1, row), 0)), weight);\n"
+      "      v_bg = mix(v_bg, tile_color(texelFetch(u_animations, ivec2(2, row), 0)), weight);\n"
+      "    }\n"
+      "  }\n"
+      "}";
+
+  // Shared by every fragment shader, which pass their final color through light().
+#define RLH_FRAGMENT_LIGHT_SOURCE                                                         \
+  "in vec2 v_pos;\n"                                                                     \
+  "uniform bool u_light_map_mode;\n"                                                     \
+  "uniform sampler2D u_light_map;\n"                                                     \
+  "uniform vec2 u_light_map_cells;\n"                                                    \
+  "vec4 light(vec4 color)\n"                                                             \
+  "{\n"                                                                                  \
+  "  if (!u_light_map_mode)\n"                                                           \
+  "    return color;\n"                                                                  \
+  "  ivec2 cell = min(ivec2(v_pos * u_light_map_cells), textureSize(u_light_map, 0) - 1);\n" \
+  "  vec4 cell_light = texelFetch(u_light_map, cell, 0);\n"                              \
+  "  vec3 gray = vec3(dot(color.rgb, vec3(0.299, 0.587, 0.114)));\n"                     \
+  "  return vec4(mix(color.rgb, gray, cell_light.a) * cell_light.rgb, color.a);\n"       \
+  "}\n"
+
+  // Shared by every fragment shader, which read the atlas through atlas_color(). A tile that repeats
+  // gets the stpq of its glyph from the vertex shader, and starts the glyph again in every cell.
+#define RLH_FRAGMENT_ATLAS_SOURCE                                                  \
+  "in vec3 v_uvp;\n"                                                               \
+  "flat in int v_repeat;\n"                                                        \
+  "flat in vec4 v_glyph;\n"                                                        \
+  "uniform sampler2DArray u_atlas;\n"                                              \
+  "uniform vec2 u_cells;\n"                                                        \
+  "vec4 atlas_color()\n"                                                           \
+  "{\n"                                                                            \
+  "  if (v_repeat == 0)\n"                                                         \
+  "    return texture(u_atlas, v_uvp);\n"                                          \
+  "  vec2 cell = fract(v_pos * u_cells);\n"                                        \
+  "  return texture(u_atlas, vec3(mix(v_glyph.xz, v_glyph.yw, cell), v_uvp.z));\n" \
+  "}\n"
+
+  const char *RLH_FRAGMENT_ALPHA_BG_SOURCE =
+      "#version 330 core\n"
+      "in vec4 v_fg;\n"
+      "in vec4 v_bg;\n"
+      "out vec4 f_color;\n"
+      RLH_FRAGMENT_LIGHT_SOURCE
+      RLH_FRAGMENT_ATLAS_SOURCE
+      "void main()\n"
+      "{\n"
+      "  vec4 tex_color = atlas_color();\n"
+      "  vec4 actual_tex_color = vec4(tex_color.rgb, 1.0);\n"
+      "  f_color = light(mix(v_bg, v_fg * actual_tex_color, tex_color.a));\n"
+      "}";
+
+  const char *RLH_FRAGMENT_GREEN_BG_SOURCE =
+      "#version 330 core\n"
+      "in vec4 v_fg;\n"
+      "in vec4 v_bg;\n"
+      "out vec4 f_color;\n"
+      RLH_FRAGMENT_LIGHT_SOURCE
+      RLH_FRAGMENT_ATLAS_SOURCE
+      "void main()\n"
+      "{\n"
+      "  vec4 tex_color = atlas_color();\n"
+      "  vec4 actual_tex_color = vec4(tex_color.r, tex_color.r, tex_color.r, 1.0);\n"
+      "  f_color = light(mix(v_bg, v_fg * actual_tex_color, tex_color.g));\n"
+      "}";
+
+  const char *RLH_FRAGMENT_STENCIL_SOURCE =
+      "#version 330 core\n"
+      "in vec4 v_fg;\n"
+      "in vec4 v_bg;\n"
+      "out vec4 f_color;\n"
+      RLH_FRAGMENT_LIGHT_SOURCE
+      RLH_FRAGMENT_ATLAS_SOURCE
+      "void main()\n"
+      "{\n"
+      "  vec4 tex_color = atlas_color();\n"
+      "  f_color = light(mix(v_bg, v_fg, tex_color.r));\n"
+      "}";
+
+  // Draws the cached image of a terminal as one quad, with corners made from gl_VertexID.
+  const char *RLH_CACHE_VERTEX_SOURCE =
+      "#version 330 core\n"
+      "out vec2 v_uv;\n"
+      "uniform mat4 u_matrix;\n"
+      "void main()\n"
+      "{\n"
+      "  vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+      "  v_uv = vec2(corner.x, 1.0 - corner.y);\n"
+      "  gl_Position = u_matrix * vec4(corner, 0.0, 1.0);\n"
+      "}";
+
+  const char *RLH_CACHE_FRAGMENT_SOURCE =
+      "#version 330 core\n"
+      "in vec2 v_uv;\n"
+      "out vec4 f_color;\n"
+      "uniform sampler2D u_cache;\n"
+      "void main()\n"
+      "{\n"
+      "  f_color = texture(u_cache, v_uv);\n"
+      "}";
+
+  // Moves every particle forward by transform feedback. Dead particles stay as they are.
+  const char *RLH_PARTICLE_UPDATE_SOURCE =
+      "#version 330 core\n"
+      "layout(location = 0) in vec4 a_motion;\n"
+      "layout(location = 1) in float a_age;\n"
+      "layout(location = 2) in vec4 a_lifetime_forces;\n"
+      "out vec4 v_motion;\n"
+      "out float v_age;\n"
+      "uniform float u_seconds;\n"
+      "void main()\n"
+      "{\n"
+      "  v_motion = a_motion;\n"
+      "  v_age = a_age;\n"
+      "  if (a_age < a_lifetime_forces.x)\n"
+      "  {\n"
+      "    vec2 velocity = (a_motion.zw + a_lifetime_forces.yz * u_seconds) * exp(-a_lifetime_forces.w * u_seconds);\n"
+      "    v_motion = vec4(a_motion.xy + velocity * u_seconds, velocity);\n"
+      "    v_age = a_age + u_seconds;\n"
+      "  }\n"
+      "}";
+
+  // Draws every particle as an instance of a quad, with corners made from gl_VertexID, for the same
+  // fragment shaders as the tiles.
+  const char *RLH_PARTICLE_VERTEX_SOURCE =
+      "#version 330 core\n"
+      "layout(location = 0) in vec4 a_motion;\n"
+      "layout(location = 1) in float a_age;\n"
+      "layout(location = 2) in vec4 a_lifetime_forces;\n"
+      "layout(location = 3) in vec2 a_size;\n"
+      "layout(location = 4) in vec4 a_stpq;\n"
+      "layout(location = 5) in uint a_page;\n"
+      "layout(location = 6) in vec4 a_fg;\n"
+      "layout(location = 7) in vec4 a_bg;\n"
+      "layout(location = 8) in vec4 a_fg_end;\n"
+      "layout(location = 9) in vec4 a_bg_end;\n"
+      "out vec2 v_pos;\n"
+      "out vec3 v_uvp;\n"
+      "out vec4 v_fg;\n"
+      "out vec4 v_bg;\n"
+      "flat out int v_repeat;\n"
+      "flat out vec4 v_glyph;\n"
+      "uniform mat4 u_matrix;\n"
+      "uniform vec2 u_pixel_scale;\n"
+      "uniform bool u_palette_mode;\n"
+      "uniform sampler2D u_palette;\n"
+      "vec4 tile_color(vec4 color)\n"
+      "{\n"
+      "  return u_palette_mode ? texelFetch(u_palette, ivec2(int(color.r * 255.0 + 0.5), 0), 0) : color;\n"
+      "}\n"
+      "void main()\n"
+      "{\n"
+      "  bool alive = a_age < a_lifetime_forces.x;\n"
+      "  vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+      "  // dead particles have every corner in the same place, so they cover no pixels\n"
+      "  vec2 pos = alive ? (a_motion.xy + corner * a_size) * u_pixel_scale : vec2(-1.0);\n"
+      "  gl_Position = u_matrix * vec4(pos, 0.0, 1.0);\n"
+      "  v_pos = pos;\n"
+      "  v_uvp = vec3(mix(a_stpq.x, a_stpq.y, corner.x), mix(a_stpq.z, a_stpq.w, corner.y), float(a_page));\n"
+      "  float fade = alive ? a_age / a_lifetime_forces.x : 1.0;\n"
+      "  v_fg = mix(tile_color(a_fg), tile_color(a_fg_end), fade);\n"
+      "  v_bg = mix(tile_color(a_bg), tile_color(a_bg_end), fade);\n"
+      "  v_repeat = 0;\n"
+      "  v_glyph = vec4(0.0);\n"
+      "}";
+
+  typedef enum rlhfragmenttype_t
+  {
+    RLH_FRAGMENT_NONE,
+    RLH_FRAGMENT_STENCIL,
+    RLH_FRAGMENT_GREEN_BG,
+    RLH_FRAGMENT_ALPHA_BG,
+    RLH_FRAGMENT_COUNT
+  } rlhfragmenttype_t;
+
+  GLint RLH_ATLAS_TEXTURE_SLOT = 0;
+  GLint RLH_PALETTE_TEXTURE_SLOT = 1;
+  GLint RLH_ANIMATION_TEXTURE_SLOT = 2;
+  GLint RLH_LIGHT_MAP_TEXTURE_SLOT = 3;
+  GLint RLH_CACHE_TEXTURE_SLOT = 4;
+  GLint RLH_GLYPH_TEXTURE_SLOT = 5;
+#define RLH_GL33_TEXTURE_SLOT_COUNT 6
+  // Each row of the animation texture is the frame count, frame duration and color period, the fg
+  // and bg colors to fade to, and then the stpq and page of each frame.
+  const int RLH_GL33_ANIMATION_TEXELS = 3 + RLH_ANIMATION_MAX_FRAMES * 2;
+  // The glyph texture has the stpq of each glyph of the atlas, this many to a row.
+#define RLH_GL33_GLYPH_TEXELS_WIDE 256
+  // Timer queries are read back this many draws late at the earliest, so reading them never stalls.
+#define RLH_GL33_TIMER_QUERY_COUNT 4
+
+  // The part of a particle that transform feedback changes, which is kept in two buffers that take
+  // turns being read and written.
+  typedef struct rlhGl33ParticleState_s
+  {
+    float x;
+    float y;
+    float velocity_x;
+    float velocity_y;
+    float age;
+  } rlhGl33ParticleState_s;
+
+  // The OpenGL state that a terminal set to draw, as it last set it, so setting it to the same
+  // values again can be skipped.
+  typedef struct rlhGl33State_s
+  {
+    rlhbool_t known;
+    GLuint program;
+    GLuint vertex_array;
+    GLuint array_buffer;
+    GLint texture_slot;
+    GLuint textures[RLH_GL33_TEXTURE_SLOT_COUNT];
+    rlhbool_t blend;
+    GLenum blend_func[4];
+    rlhbool_t scissor_test;
+    GLint scissor[4];
+  } rlhGl33State_s;
+
+  typedef struct rlhGl33Term_s
+  {
+    // The state this terminal last set, and the id that marks it as the owner of the state.
+    rlhGl33State_s state;
+    long state_id;
+    rlhfragmenttype_t fragment_type;
+    GLuint gl_program;
+    GLuint gl_vertex_array;
+    GLuint gl_vertex_buffer;
+    GLuint gl_element_buffer;
+    GLint gl_matrix_uniform_location;
+    // The matrix uniform of the program, so drawing with the same matrix again does not set it.
+    float matrix[16];
+    rlhbool_t matrix_set;
+    GLint gl_palette_mode_uniform_location;
+    GLuint gl_atlas_texture_2d_array;
+    GLuint gl_glyph_texture_2d;
+    GLuint gl_palette_texture_2d;
+    rlhbool_t palette_mode;
+    // Asynchronous atlas upload
+    GLuint gl_atlas_upload_buffer;
+    GLuint gl_atlas_upload_texture_2d_array;
+    GLuint gl_atlas_upload_glyph_texture_2d;
+    GLsync gl_atlas_upload_fence;
+    rlhAtlasCreateInfo_t atlas_upload_info;
+    int atlas_upload_page_next;
+    // Animations
+    GLuint gl_animation_texture_2d;
+    GLint gl_time_uniform_location;
+    float animation_time;
+    // Light map
+    GLuint gl_light_map_texture_2d;
+    GLint gl_light_map_mode_uniform_location;
+    GLint gl_light_map_cells_uniform_location;
+    rlhbool_t light_map_mode;
+    int light_map_width;
+    int light_map_height;
+    float light_map_cells_wide;
+    float light_map_cells_tall;
+    // Rects
+    GLint gl_cells_uniform_location;
+    float cells_wide;
+    float cells_tall;
+    // Moving tiles
+    GLint gl_motion_alpha_uniform_location;
+    GLint gl_motion_scale_uniform_location;
+    float motion_alpha;
+    float motion_scale_x;
+    float motion_scale_y;
+    // Particles
+    GLuint gl_particle_update_program;
+    GLint gl_particle_seconds_uniform_location;
+    GLuint gl_particle_program;
+    rlhfragmenttype_t particle_fragment_type;
+    GLint gl_particle_matrix_uniform_location;
+    GLint gl_particle_pixel_scale_uniform_location;
+    GLint gl_particle_palette_mode_uniform_location;
+    GLint gl_particle_light_map_mode_uniform_location;
+    GLint gl_particle_light_map_cells_uniform_location;
+    float particle_matrix[16];
+    rlhbool_t particle_matrix_set;
+    GLuint gl_particle_state_buffers[2];
+    GLuint gl_particle_buffer;
+    GLuint gl_particle_update_vertex_arrays[2];
+    GLuint gl_particle_vertex_arrays[2];
+    size_t particle_capacity;
+    size_t particle_next;
+    int particle_state;
+    // Cache mode
+    GLuint gl_cache_framebuffer;
+    GLuint gl_cache_texture_2d;
+    GLuint gl_cache_program;
+    GLuint gl_cache_vertex_array;
+    GLint gl_cache_matrix_uniform_location;
+    float cache_matrix[16];
+    rlhbool_t cache_matrix_set;
+    int cache_width;
+    int cache_height;
+#ifdef RLH_STATS_TIMERS
+    GLuint gl_timer_queries[RLH_GL33_TIMER_QUERY_COUNT];
+    size_t timer_query_next;
+    size_t timer_query_pending;
+#endif
+  } rlhGl33Term_s;
+
+  // The id of the terminal that last set OpenGL state on any context, which is 0 after
+  // rlhInvalidateGlState(NULL). A terminal only trusts the state it remembers while it is the owner,
+  // so terminals that share a context, or draw to contexts made current in turns, never skip
+  // setting state that another terminal changed.
+  static volatile long _rlhGl33StateOwner = 0;
+  static volatile long _rlhGl33StateIdLock = 0;
+  static long _rlhGl33LastStateId = 0;
+
+  // Give out an id that no other terminal has. Terminals can be created on several threads at once,
+  // so the counter is guarded by a spin lock made of the atomic exchange.
+  static inline long _rlhGl33NewStateId(void)
+  {
+    while (RLH_ATOMIC_EXCHANGE(&_rlhGl33StateIdLock, 1) != 0)
+    {
+    }
+    _rlhGl33LastStateId = (_rlhGl33LastStateId == 0x7fffffffL) ? 1 : _rlhGl33LastStateId + 1;
+    const long id = _rlhGl33LastStateId;
+    RLH_ATOMIC_EXCHANGE(&_rlhGl33StateIdLock, 0);
+    return id;
+  }
+
+  // Forget the state of a terminal, so everything is set again the next time it is used. Deleting an
+  // object unbinds it and its name can be given to a new object, so this is done after deleting any.
+  static inline void _rlhGl33InvalidateState(rlhGl33Term_s *const gl)
+  {
+    gl->state.known = RLH_FALSE;
+  }
+
+  static inline rlhGl33State_s *_rlhGl33GetState(rlhGl33Term_s *const gl)
+  {
+    rlhGl33State_s *const state = &gl->state;
+    if (!state->known || RLH_ATOMIC_LOAD(&_rlhGl33StateOwner) != gl->state_id)
+    {
+      // all bits set is a name, slot, enum and flag that is never set, so everything is set again
+      memset(state, 0xff, sizeof(rlhGl33State_s));
+      state->known = RLH_TRUE;
+      RLH_ATOMIC_EXCHANGE(&_rlhGl33StateOwner, gl->state_id);
+    }
+    return state;
+  }
+
+  static inline void _rlhGl33UseProgram(rlhGl33Term_s *const gl, const GLuint program)
+  {
+    GLD_START();
+    rlhGl33State_s *const state = _rlhGl33GetState(gl);
+    if (state->program != program)
+    {
+      GLD_CALL(glUseProgram(program));
+      state->program = program;
+    }
+  }
+
+  static inline void _rlhGl33BindVertexArray(rlhGl33Term_s *const gl, const GLuint vertex_array)
+  {
+    GLD_START();
+    rlhGl33State_s *const state = _rlhGl33GetState(gl);
+    if (state->vertex_array != vertex_array)
+    {
+      GLD_CALL(glBindVertexArray(vertex_array));
+      state->vertex_array = vertex_array;
+    }
+  }
+
+  static inline void _rlhGl33BindArrayBuffer(rlhGl33Term_s *const gl, const GLuint buffer)
+  {
+    GLD_START();
+    rlhGl33State_s *const state = _rlhGl33GetState(gl);
+    if (state->array_buffer != buffer)
+    {
+      GLD_CALL(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+      state->array_buffer = buffer;
+    }
+  }
+
+  // Bind a texture to a texture slot, which is also left as the active texture unit so the texture
+  // can be changed after. Each slot is only ever used with one target.
+  static inline void _rlhGl33BindTexture(rlhGl33Term_s *const gl, const GLint slot, const GLenum target, const GLuint texture)
+  {
+    GLD_START();
+    rlhGl33State_s *const state = _rlhGl33GetState(gl);
+    if (state->texture_slot != slot)
+    {
+      GLD_CALL(glActiveTexture(GL_TEXTURE0 + slot));
+      state->texture_slot = slot;
+    }
+    if (state->textures[slot] != texture)
+    {
+      GLD_CALL(glBindTexture(target, texture));
+      state->textures[slot] = texture;
+    }
+  }
+
+  // Turn blending on with the given blend functions.
+  static inline void _rlhGl33SetBlend(rlhGl33Term_s *const gl, const GLenum src_rgb, const GLenum dst_rgb, const GLenum src_alpha, const GLenum dst_alpha)
+  {
+    GLD_START();
+    rlhGl33State_s *const state = _rlhGl33GetState(gl);
+    if (state->blend != RLH_TRUE)
+    {
+      GLD_CALL(glEnable(GL_BLEND));
+      state->blend = RLH_TRUE;
+    }
+    if (state->blend_func[0] != src_rgb || state->blend_func[1] != dst_rgb ||
+        state->blend_func[2] != src_alpha || state->blend_func[3] != dst_alpha)
+    {
+      GLD_CALL(glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha));
+      state->blend_func[0] = src_rgb;
+      state->blend_func[1] = dst_rgb;
+      state->blend_func[2] = src_alpha;
+      state->blend_func[3] = dst_alpha;
+    }
+  }
+
+  static inline void _rlhGl33SetScissorTest(rlhGl33Term_s *const gl, const rlhbool_t enabled)
+  {
+    GLD_START();
+    rlhGl33State_s *const state = _rlhGl33GetState(gl);
+    if (state->scissor_test != enabled)
+    {
+      if (enabled)
+      {
+        GLD_CALL(glEnable(GL_SCISSOR_TEST));
+      }
+      else
+      {
+        GLD_CALL(glDisable(GL_SCISSOR_TEST));
+      }
+      state->scissor_test = enabled;
+    }
+  }
+
+  static inline void _rlhGl33SetScissorBox(rlhGl33Term_s *const gl, const GLint x, const GLint y, const GLint width, const GLint height)
+  {
+    GLD_START();
+    rlhGl33State_s *const state = _rlhGl33GetState(gl);
+    if (state->scissor[0] != x || state->scissor[1] != y || state->scissor[2] != width || state->scissor[3] != height)
+    {
+      GLD_CALL(glScissor(x, y, width, height));
+      state->scissor[0] = x;
+      state->scissor[1] = y;
+      state->scissor[2] = width;
+      state->scissor[3] = height;
+    }
+  }
+
+  // Set the matrix uniform of the current program, unless it already is the matrix in mirror.
+  static inline void _rlhGl33SetMatrix(const GLint location, const float *const matrix_4x4, float *const mirror, rlhbool_t *const mirror_set)
+  {
+    GLD_START();
+    if (!*mirror_set || memcmp(mirror, matrix_4x4, sizeof(float) * 16) != 0)
+    {
+      GLD_CALL(glUniformMatrix4fv(location, 1, GL_TRUE, matrix_4x4));
+      memcpy(mirror, matrix_4x4, sizeof(float) * 16);
+      *mirror_set = RLH_TRUE;
+    }
+  }
+
+  static inline GLenum _rlhColorTypeToGlFormat(const rlhcolortype_t color)
+  {
+    switch (color)
+    {
+    case RLH_COLOR_G:
+      return GL_RED;
+    case RLH_COLOR_GA:
+      return GL_RG;
+    case RLH_COLOR_RGBA:
+      return GL_RGBA;
+    case RLH_COLOR_BGRA:
+      return GL_BGRA;
+    default:
+      return GL_NONE;
+    }
+  }
+
+  static inline GLenum _rlhColorTypeToGlInternalFormat(const rlhcolortype_t color)
+  {
+    switch (color)
+    {
+    case RLH_COLOR_G:
+      return GL_R8;
+    case RLH_COLOR_GA:
+      return GL_RG;
+    case RLH_COLOR_RGBA:
+    case RLH_COLOR_BGRA:
+      return GL_RGBA;
+    default:
+      return GL_NONE;
+    }
+  }
+
+  static inline GLenum _rlhChannelSizeToType(const size_t channel_size)
+  {
+    switch (channel_size)
+    {
+    case 1:
+      return GL_UNSIGNED_BYTE;
+    case 2:
+      return GL_UNSIGNED_SHORT;
+    case 4:
+      return GL_UNSIGNED_INT;
+    default:
+      return GL_NONE;
+    }
+  }
+
+  static inline rlhresult_t _rlhCreateGlTextureArray(rlhGl33Term_s *const gl, const rlhAtlasCreateInfo_t *const atlas_info, GLuint *const gl_texture_2d_array)
+  {
+    *gl_texture_2d_array = GL_NONE;
+    const GLenum format = _rlhColorTypeToGlFormat(atlas_info->color);
+    const GLenum internal_format = _rlhColorTypeToGlInternalFormat(atlas_info->color);
+    const GLenum pixel_type = _rlhChannelSizeToType(atlas_info->channel_size);
+    if (internal_format == GL_NONE || format == GL_NONE)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    GLD_START();
+    GLD_CALL(glGenTextures(1, gl_texture_2d_array));
+    _rlhGl33BindTexture(gl, RLH_ATLAS_TEXTURE_SLOT, GL_TEXTURE_2D_ARRAY, *gl_texture_2d_array);
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0));
+    GLD_CALL(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internal_format, atlas_info->width, atlas_info->height, atlas_info->pages, 0, format, pixel_type, atlas_info->pixel_data));
+    return RLH_RESULT_OK;
+  }
+
+  // Make the texture that tiles which repeat look up the stpq of their glyph in.
+  static inline rlhresult_t _rlhCreateGlGlyphTexture(rlhGl33Term_s *const gl, const rlhAtlasCreateInfo_t *const atlas_info, GLuint *const gl_glyph_texture_2d)
+  {
+    *gl_glyph_texture_2d = GL_NONE;
+    const int rows = atlas_info->glyph_count > 0 ? (atlas_info->glyph_count + RLH_GL33_GLYPH_TEXELS_WIDE - 1) / RLH_GL33_GLYPH_TEXELS_WIDE : 1;
+    float *const texels = (float *)RLH_MALLOC((size_t)rows * RLH_GL33_GLYPH_TEXELS_WIDE * 4 * sizeof(float), NULL);
+    if (texels == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memset(texels, 0, (size_t)rows * RLH_GL33_GLYPH_TEXELS_WIDE * 4 * sizeof(float));
+    for (int glyph = 0; glyph < atlas_info->glyph_count; glyph++)
+    {
+      memcpy(texels + glyph * 4, atlas_info->glyph_stpqp + glyph * RLH_FONTMAP_COORDINATES_PER_GLYPH, 4 * sizeof(float));
+    }
+    GLD_START();
+    GLD_CALL(glGenTextures(1, gl_glyph_texture_2d));
+    _rlhGl33BindTexture(gl, RLH_GLYPH_TEXTURE_SLOT, GL_TEXTURE_2D, *gl_glyph_texture_2d);
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+    GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+    GLD_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, RLH_GL33_GLYPH_TEXELS_WIDE, rows, 0, GL_RGBA, GL_FLOAT, texels));
+    RLH_FREE(texels, NULL);
+    return RLH_RESULT_OK;
+  }
+
+  static inline GLuint _rlhCreateGlProgram(const char *vertex_source, const char *fragment_source)
+  {
+    GLint gl_program, gl_vertex_shader, gl_fragment_shader;
+    GLD_CALL(gl_vertex_shader = glCreateShader(GL_VERTEX_SHADER));
+    GLD_CALL(glShaderSource(gl_vertex_shader, 1, &vertex_source, NULL));
+    GLD_COMPILE(gl_vertex_shader, "rlh vertex shader");
+    GLD_CALL(gl_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER));
+    GLD_CALL(glShaderSource(gl_fragment_shader, 1, &fragment_source, NULL));
+    GLD_COMPILE(gl_fragment_shader, "rlh fragment shader");
+    GLD_CALL(gl_program = glCreateProgram());
+    GLD_CALL(glAttachShader(gl_program, gl_vertex_shader));
+    GLD_CALL(glAttachShader(gl_program, gl_fragment_shader));
+    GLD_LINK(gl_program, "rlh shader program");
+    GLD_CALL(glDetachShader(gl_program, gl_vertex_shader));
+    GLD_CALL(glDetachShader(gl_program, gl_fragment_shader));
+    GLD_CALL(glDeleteShader(gl_vertex_shader));
+    GLD_CALL(glDeleteShader(gl_fragment_shader));
+    return gl_program;
+  }
+
+  // Make a program without a fragment shader that captures varyings from its vertex shader.
+  static inline GLuint _rlhCreateGlFeedbackProgram(const char *vertex_source, const char *const *varyings, const GLsizei varying_count)
+  {
+    GLint gl_program, gl_vertex_shader;
+    GLD_CALL(gl_vertex_shader = glCreateShader(GL_VERTEX_SHADER));
+    GLD_CALL(glShaderSource(gl_vertex_shader, 1, &vertex_source, NULL));
+    GLD_COMPILE(gl_vertex_shader, "rlh feedback vertex shader");
+    GLD_CALL(gl_program = glCreateProgram());
+    GLD_CALL(glAttachShader(gl_program, gl_vertex_shader));
+    GLD_CALL(glTransformFeedbackVaryings(gl_program, varying_count, varyings, GL_INTERLEAVED_ATTRIBS));
+    GLD_LINK(gl_program, "rlh feedback program");
+    GLD_CALL(glDetachShader(gl_program, gl_vertex_shader));
+    GLD_CALL(glDeleteShader(gl_vertex_shader));
+    return gl_program;
+  }
+
+  static inline rlhfragmenttype_t _rlhColorTypeToFragmentType(rlhcolortype_t color)
+  {
+    switch (color)
+    {
+    case RLH_COLOR_G:
+      return RLH_FRAGMENT_STENCIL;
+    case RLH_COLOR_GA:
+      return RLH_FRAGMENT_GREEN_BG;
+    }
+    return RLH_FRAGMENT_ALPHA_BG;
+  }
+
+  static inline const char *_rlhFragmentSourceFromFragmentType(rlhfragmenttype_t fragment)
+  {
+    switch (fragment)
+    {
+    case RLH_FRAGMENT_STENCIL:
+      return RLH_FRAGMENT_STENCIL_SOURCE;
+    case RLH_FRAGMENT_GREEN_BG:
+      return RLH_FRAGMENT_GREEN_BG_SOURCE;
+    }
+    return RLH_FRAGMENT_ALPHA_BG_SOURCE;
+  }
+
+  static rlhresult_t _rlhGl33Create(void *user_data, void **backend_data)
+  {
+    (void)user_data;
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)RLH_MALLOC(sizeof(rlhGl33Term_s), NULL);
+    if (gl == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memset(gl, 0, sizeof(rlhGl33Term_s));
+    gl->state_id = _rlhGl33NewStateId();
+    GLD_START();
+    GLD_CALL(glGenVertexArrays(1, &gl->gl_vertex_array));
+    GLD_CALL(glGenBuffers(1, &gl->gl_vertex_buffer));
+    GLD_CALL(glGenBuffers(1, &gl->gl_element_buffer));
+    _rlhGl33BindVertexArray(gl, gl->gl_vertex_array);
+    _rlhGl33BindArrayBuffer(gl, gl->gl_vertex_buffer);
+    GLD_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->gl_element_buffer));
+    const GLsizei stride = sizeof(rlhVertex_s);
+    // position
+    GLD_CALL(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(rlhVertex_s, x)));
+    GLD_CALL(glEnableVertexAttribArray(0));
+    // uv
+    GLD_CALL(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(rlhVertex_s, s)));
+    GLD_CALL(glEnableVertexAttribArray(1));
+    // forground color, normalized from bytes to 0.0 to 1.0
+    GLD_CALL(glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)offsetof(rlhVertex_s, fg)));
+    GLD_CALL(glEnableVertexAttribArray(2));
+    // background color
+    GLD_CALL(glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)offsetof(rlhVertex_s, bg)));
+    GLD_CALL(glEnableVertexAttribArray(3));
+    // page and animation, as integers
+    GLD_CALL(glVertexAttribIPointer(4, 2, GL_UNSIGNED_SHORT, stride, (void *)offsetof(rlhVertex_s, page)));
+    GLD_CALL(glEnableVertexAttribArray(4));
+    // motion in pixels, as floats
+    GLD_CALL(glVertexAttribPointer(5, 2, GL_SHORT, GL_FALSE, stride, (void *)offsetof(rlhVertex_s, motion_x)));
+    GLD_CALL(glEnableVertexAttribArray(5));
+    _rlhGl33BindVertexArray(gl, GL_NONE);
+#ifdef RLH_STATS_TIMERS
+    GLD_CALL(glGenQueries(RLH_GL33_TIMER_QUERY_COUNT, gl->gl_timer_queries));
+#endif
+    *backend_data = gl;
+    return RLH_RESULT_OK;
+  }
+
+  static void _rlhGl33DeleteParticles(rlhGl33Term_s *gl)
+  {
+    GLD_START();
+    if (gl->gl_particle_update_program != GL_NONE)
+    {
+      GLD_CALL(glDeleteProgram(gl->gl_particle_update_program));
+      GLD_CALL(glDeleteBuffers(2, gl->gl_particle_state_buffers));
+      GLD_CALL(glDeleteBuffers(1, &gl->gl_particle_buffer));
+      GLD_CALL(glDeleteVertexArrays(2, gl->gl_particle_update_vertex_arrays));
+      GLD_CALL(glDeleteVertexArrays(2, gl->gl_particle_vertex_arrays));
+      gl->gl_particle_update_program = GL_NONE;
+      memset(gl->gl_particle_state_buffers, 0, sizeof(gl->gl_particle_state_buffers));
+      gl->gl_particle_buffer = GL_NONE;
+      memset(gl->gl_particle_update_vertex_arrays, 0, sizeof(gl->gl_particle_update_vertex_arrays));
+      memset(gl->gl_particle_vertex_arrays, 0, sizeof(gl->gl_particle_vertex_arrays));
+      _rlhGl33InvalidateState(gl);
+    }
+    if (gl->gl_particle_program != GL_NONE)
+    {
+      GLD_CALL(glDeleteProgram(gl->gl_particle_program));
+      gl->gl_particle_program = GL_NONE;
+      gl->particle_fragment_type = RLH_FRAGMENT_NONE;
+      _rlhGl33InvalidateState(gl);
+    }
+    gl->particle_capacity = 0;
+  }
+
+  static void _rlhGl33Destroy(void *backend_data)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    if (gl == NULL)
+      return;
+    GLD_START();
+    if (gl->gl_vertex_array != GL_NONE)
+    {
+      GLD_CALL(glDeleteVertexArrays(1, &gl->gl_vertex_array));
+      gl->gl_vertex_array = GL_NONE;
+    }
+    if (gl->gl_vertex_buffer != GL_NONE)
+    {
+      GLD_CALL(glDeleteBuffers(1, &gl->gl_vertex_buffer));
+      gl->gl_vertex_buffer = GL_NONE;
+    }
+    if (gl->gl_element_buffer != GL_NONE)
+    {
+      GLD_CALL(glDeleteBuffers(1, &gl->gl_element_buffer));
+      gl->gl_element_buffer = GL_NONE;
+    }
+    if (gl->gl_program != GL_NONE)
+    {
+      GLD_CALL(glDeleteProgram(gl->gl_program));
+      gl->gl_program = GL_NONE;
+    }
+    if (gl->gl_atlas_texture_2d_array != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_atlas_texture_2d_array));
+      gl->gl_atlas_texture_2d_array = GL_NONE;
+    }
+    if (gl->gl_glyph_texture_2d != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_glyph_texture_2d));
+      gl->gl_glyph_texture_2d = GL_NONE;
+    }
+    if (gl->gl_palette_texture_2d != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_palette_texture_2d));
+      gl->gl_palette_texture_2d = GL_NONE;
+    }
+    if (gl->gl_atlas_upload_buffer != GL_NONE)
+    {
+      // deleting a mapped buffer unmaps it
+      GLD_CALL(glDeleteBuffers(1, &gl->gl_atlas_upload_buffer));
+      gl->gl_atlas_upload_buffer = GL_NONE;
+    }
+    if (gl->gl_atlas_upload_texture_2d_array != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_atlas_upload_texture_2d_array));
+      gl->gl_atlas_upload_texture_2d_array = GL_NONE;
+    }
+    if (gl->gl_atlas_upload_glyph_texture_2d != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_atlas_upload_glyph_texture_2d));
+      gl->gl_atlas_upload_glyph_texture_2d = GL_NONE;
+    }
+    if (gl->gl_atlas_upload_fence != NULL)
+    {
+      GLD_CALL(glDeleteSync(gl->gl_atlas_upload_fence));
+      gl->gl_atlas_upload_fence = NULL;
+    }
+    if (gl->gl_animation_texture_2d != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_animation_texture_2d));
+      gl->gl_animation_texture_2d = GL_NONE;
+    }
+    if (gl->gl_light_map_texture_2d != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_light_map_texture_2d));
+      gl->gl_light_map_texture_2d = GL_NONE;
+    }
+    _rlhGl33DeleteParticles(gl);
+    if (gl->gl_cache_framebuffer != GL_NONE)
+    {
+      GLD_CALL(glDeleteFramebuffers(1, &gl->gl_cache_framebuffer));
+      gl->gl_cache_framebuffer = GL_NONE;
+    }
+    if (gl->gl_cache_texture_2d != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_cache_texture_2d));
+      GLD_CALL(glDeleteProgram(gl->gl_cache_program));
+      GLD_CALL(glDeleteVertexArrays(1, &gl->gl_cache_vertex_array));
+      gl->gl_cache_texture_2d = GL_NONE;
+      gl->gl_cache_program = GL_NONE;
+      gl->gl_cache_vertex_array = GL_NONE;
+    }
+#ifdef RLH_STATS_TIMERS
+    GLD_CALL(glDeleteQueries(RLH_GL33_TIMER_QUERY_COUNT, gl->gl_timer_queries));
+#endif
+    _rlhGl33InvalidateState(gl);
+    RLH_FREE(gl, NULL);
+  }
+
+  // Replace the atlas and glyph textures, and the program too if the new atlas needs a different
+  // fragment shader.
+  static void _rlhGl33UseAtlasTexture(rlhGl33Term_s *gl, const GLuint gl_atlas_texture_2d_array, const GLuint gl_glyph_texture_2d, const rlhcolortype_t color)
+  {
+    GLD_START();
+    rlhfragmenttype_t fragment_type = _rlhColorTypeToFragmentType(color);
+    if (fragment_type != gl->fragment_type)
+    {
+      if (gl->gl_program != GL_NONE)
+      {
+        GLD_CALL(glDeleteProgram(gl->gl_program));
+        gl->gl_program = GL_NONE;
+      }
+      const char *fragment_source = _rlhFragmentSourceFromFragmentType(fragment_type);
+      gl->gl_program = _rlhCreateGlProgram(RLH_VERTEX_SOURCE, fragment_source);
+      gl->matrix_set = RLH_FALSE;
+      _rlhGl33InvalidateState(gl);
+      _rlhGl33UseProgram(gl, gl->gl_program);
+      GLD_CALL(gl->gl_matrix_uniform_location = glGetUniformLocation(gl->gl_program, "u_matrix"));
+      GLint atlas_slot_uniform;
+      GLD_CALL(atlas_slot_uniform = glGetUniformLocation(gl->gl_program, "u_atlas"));
+      GLD_CALL(glUniform1i(atlas_slot_uniform, RLH_ATLAS_TEXTURE_SLOT));
+      GLint palette_slot_uniform;
+      GLD_CALL(palette_slot_uniform = glGetUniformLocation(gl->gl_program, "u_palette"));
+      GLD_CALL(glUniform1i(palette_slot_uniform, RLH_PALETTE_TEXTURE_SLOT));
+      GLD_CALL(gl->gl_palette_mode_uniform_location = glGetUniformLocation(gl->gl_program, "u_palette_mode"));
+      GLD_CALL(glUniform1i(gl->gl_palette_mode_uniform_location, gl->palette_mode));
+      GLint animation_slot_uniform;
+      GLD_CALL(animation_slot_uniform = glGetUniformLocation(gl->gl_program, "u_animations"));
+      GLD_CALL(glUniform1i(animation_slot_uniform, RLH_ANIMATION_TEXTURE_SLOT));
+      GLint glyph_slot_uniform;
+      GLD_CALL(glyph_slot_uniform = glGetUniformLocation(gl->gl_program, "u_glyphs"));
+      GLD_CALL(glUniform1i(glyph_slot_uniform, RLH_GLYPH_TEXTURE_SLOT));
+      GLD_CALL(gl->gl_time_uniform_location = glGetUniformLocation(gl->gl_program, "u_time"));
+      GLD_CALL(glUniform1f(gl->gl_time_uniform_location, gl->animation_time));
+      GLint light_map_slot_uniform;
+      GLD_CALL(light_map_slot_uniform = glGetUniformLocation(gl->gl_program, "u_light_map"));
+      GLD_CALL(glUniform1i(light_map_slot_uniform, RLH_LIGHT_MAP_TEXTURE_SLOT));
+      GLD_CALL(gl->gl_light_map_mode_uniform_location = glGetUniformLocation(gl->gl_program, "u_light_map_mode"));
+      GLD_CALL(glUniform1i(gl->gl_light_map_mode_uniform_location, gl->light_map_mode));
+      GLD_CALL(gl->gl_light_map_cells_uniform_location = glGetUniformLocation(gl->gl_program, "u_light_map_cells"));
+      GLD_CALL(glUniform2f(gl->gl_light_map_cells_uniform_location, gl->light_map_cells_wide, gl->light_map_cells_tall));
+      GLD_CALL(gl->gl_cells_uniform_location = glGetUniformLocation(gl->gl_program, "u_cells"));
+      GLD_CALL(glUniform2f(gl->gl_cells_uniform_location, gl->cells_wide, gl->cells_tall));
+      GLD_CALL(gl->gl_motion_alpha_uniform_location = glGetUniformLocation(gl->gl_program, "u_motion_alpha"));
+      GLD_CALL(glUniform1f(gl->gl_motion_alpha_uniform_location, gl->motion_alpha));
+      GLD_CALL(gl->gl_motion_scale_uniform_location = glGetUniformLocation(gl->gl_program, "u_motion_scale"));
+      GLD_CALL(glUniform2f(gl->gl_motion_scale_uniform_location, gl->motion_scale_x, gl->motion_scale_y));
+    }
+    gl->fragment_type = fragment_type;
+    if (gl->gl_atlas_texture_2d_array != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_atlas_texture_2d_array));
+      gl->gl_atlas_texture_2d_array = GL_NONE;
+      _rlhGl33InvalidateState(gl);
+    }
+    gl->gl_atlas_texture_2d_array = gl_atlas_texture_2d_array;
+    if (gl->gl_glyph_texture_2d != GL_NONE)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_glyph_texture_2d));
+      gl->gl_glyph_texture_2d = GL_NONE;
+      _rlhGl33InvalidateState(gl);
+    }
+    gl->gl_glyph_texture_2d = gl_glyph_texture_2d;
+  }
+
+  static rlhresult_t _rlhGl33CreateAtlas(void *backend_data, const rlhAtlasCreateInfo_t *atlas_info)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLuint gl_atlas_texture_2d_array = GL_NONE;
+    rlhresult_t result = _rlhCreateGlTextureArray(gl, atlas_info, &gl_atlas_texture_2d_array);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    GLuint gl_glyph_texture_2d = GL_NONE;
+    result = _rlhCreateGlGlyphTexture(gl, atlas_info, &gl_glyph_texture_2d);
+    if (result != RLH_RESULT_OK)
+    {
+      GLD_START();
+      GLD_CALL(glDeleteTextures(1, &gl_atlas_texture_2d_array));
+      _rlhGl33InvalidateState(gl);
+      return result;
+    }
+    _rlhGl33UseAtlasTexture(gl, gl_atlas_texture_2d_array, gl_glyph_texture_2d, atlas_info->color);
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33BeginAtlasUpload(void *backend_data, const rlhAtlasCreateInfo_t *atlas_info, void **pixel_data)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    // allocate the texture before the pixel buffer is bound, so it is not filled from it
+    rlhAtlasCreateInfo_t storage_info = *atlas_info;
+    storage_info.pixel_data = NULL;
+    rlhresult_t result = _rlhCreateGlTextureArray(gl, &storage_info, &gl->gl_atlas_upload_texture_2d_array);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    result = _rlhCreateGlGlyphTexture(gl, atlas_info, &gl->gl_atlas_upload_glyph_texture_2d);
+    if (result != RLH_RESULT_OK)
+    {
+      GLD_CALL(glDeleteTextures(1, &gl->gl_atlas_upload_texture_2d_array));
+      gl->gl_atlas_upload_texture_2d_array = GL_NONE;
+      _rlhGl33InvalidateState(gl);
+      return result;
+    }
+    const GLsizeiptr pixel_data_size = (GLsizeiptr)_rlhGetAtlasPixelDataSize(atlas_info);
+    GLD_CALL(glGenBuffers(1, &gl->gl_atlas_upload_buffer));
+    GLD_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->gl_atlas_upload_buffer));
+    GLD_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, pixel_data_size, NULL, GL_STREAM_DRAW));
+    GLD_CALL(*pixel_data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, pixel_data_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    GLD_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE));
+    if (*pixel_data == NULL)
+    {
+      GLD_CALL(glDeleteBuffers(1, &gl->gl_atlas_upload_buffer));
+      gl->gl_atlas_upload_buffer = GL_NONE;
+      GLD_CALL(glDeleteTextures(1, &gl->gl_atlas_upload_texture_2d_array));
+      gl->gl_atlas_upload_texture_2d_array = GL_NONE;
+      GLD_CALL(glDeleteTextures(1, &gl->gl_atlas_upload_glyph_texture_2d));
+      gl->gl_atlas_upload_glyph_texture_2d = GL_NONE;
+      _rlhGl33InvalidateState(gl);
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    gl->atlas_upload_info = storage_info;
+    gl->atlas_upload_page_next = 0;
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33EndAtlasUpload(void *backend_data)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    GLboolean unmapped;
+    GLD_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->gl_atlas_upload_buffer));
+    GLD_CALL(unmapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+    GLD_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE));
+    // the buffer contents are lost if the driver had to move it while it was mapped
+    return unmapped ? RLH_RESULT_OK : RLH_RESULT_ERROR_INVALID_VALUE;
+  }
+
+  static rlhresult_t _rlhGl33StepAtlasUpload(void *backend_data, int page_count, rlhbool_t *resident)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    const rlhAtlasCreateInfo_t *const info = &gl->atlas_upload_info;
+    GLD_START();
+    *resident = RLH_FALSE;
+    if (gl->atlas_upload_page_next < info->pages)
+    {
+      const size_t page_size = (size_t)(_rlhGetAtlasPixelDataSize(info) / (uint64_t)info->pages);
+      const GLenum format = _rlhColorTypeToGlFormat(info->color);
+      const GLenum pixel_type = _rlhChannelSizeToType(info->channel_size);
+      _rlhGl33BindTexture(gl, RLH_ATLAS_TEXTURE_SLOT, GL_TEXTURE_2D_ARRAY, gl->gl_atlas_upload_texture_2d_array);
+      GLD_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->gl_atlas_upload_buffer));
+      for (int i = 0; i < page_count && gl->atlas_upload_page_next < info->pages; i++)
+      {
+        const int page = gl->atlas_upload_page_next++;
+        GLD_CALL(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, page, info->width, info->height, 1, format, pixel_type,
+                                 (const void *)((size_t)page * page_size)));
+      }
+      GLD_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE));
+      if (gl->atlas_upload_page_next < info->pages)
+      {
+        return RLH_RESULT_OK;
+      }
+      // the buffer is only freed once the copies that read from it have finished
+      GLD_CALL(glDeleteBuffers(1, &gl->gl_atlas_upload_buffer));
+      gl->gl_atlas_upload_buffer = GL_NONE;
+      GLD_CALL(gl->gl_atlas_upload_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+      return RLH_RESULT_OK;
+    }
+    GLenum wait_result;
+    GLD_CALL(wait_result = glClientWaitSync(gl->gl_atlas_upload_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0));
+    if (wait_result != GL_ALREADY_SIGNALED && wait_result != GL_CONDITION_SATISFIED)
+    {
+      return wait_result == GL_WAIT_FAILED ? RLH_RESULT_ERROR_INVALID_VALUE : RLH_RESULT_OK;
+    }
+    GLD_CALL(glDeleteSync(gl->gl_atlas_upload_fence));
+    gl->gl_atlas_upload_fence = NULL;
+    _rlhGl33UseAtlasTexture(gl, gl->gl_atlas_upload_texture_2d_array, gl->gl_atlas_upload_glyph_texture_2d, info->color);
+    gl->gl_atlas_upload_texture_2d_array = GL_NONE;
+    gl->gl_atlas_upload_glyph_texture_2d = GL_NONE;
+    *resident = RLH_TRUE;
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33UploadVertices(void *backend_data, const rlhVertex_s *vertex_data, size_t vertex_data_size)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    _rlhGl33BindArrayBuffer(gl, gl->gl_vertex_buffer);
+    GLD_CALL(glBufferData(GL_ARRAY_BUFFER, vertex_data_size, vertex_data, GL_STREAM_DRAW));
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33UploadElements(void *backend_data, const uint32_t *element_data, size_t element_data_size)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    // the element buffer binding is part of the vertex array state
+    _rlhGl33BindVertexArray(gl, gl->gl_vertex_array);
+    GLD_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, element_data_size, element_data, GL_DYNAMIC_DRAW));
+    return RLH_RESULT_OK;
+  }
+
+  static void _rlhGl33SetScissor(rlhGl33Term_s *const gl, const rlhScissor_t *scissor)
+  {
+    GLD_START();
+    const int actual_translate_y = scissor->viewport_height - (scissor->y + scissor->height);
+    // crop the scissor area so the position is not less than 0 (this causes opengl error)
+    const int cropped_x = MAX(scissor->x, 0);
+    const int cropped_y = MAX(actual_translate_y, 0);
+    int cropped_width = scissor->width;
+    int cropped_height = scissor->height;
+    if (cropped_x != scissor->x)
+    {
+      cropped_width += scissor->x;
+    }
+    if (cropped_y != actual_translate_y)
+    {
+      cropped_height += actual_translate_y;
+    }
+    // set scissor
+    _rlhGl33SetScissorBox(gl, cropped_x, cropped_y, MAX(cropped_width, 0), MAX(cropped_height, 0));
+    _rlhGl33SetScissorTest(gl, RLH_TRUE);
+  }
+
+  // Bind the textures that tiles and particles are drawn with.
+  static void _rlhGl33BindTileTextures(rlhGl33Term_s *gl)
+  {
+    _rlhGl33BindTexture(gl, RLH_ATLAS_TEXTURE_SLOT, GL_TEXTURE_2D_ARRAY, gl->gl_atlas_texture_2d_array);
+    _rlhGl33BindTexture(gl, RLH_GLYPH_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_glyph_texture_2d);
+    if (gl->palette_mode)
+    {
+      _rlhGl33BindTexture(gl, RLH_PALETTE_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_palette_texture_2d);
+    }
+    if (gl->gl_animation_texture_2d != GL_NONE)
+    {
+      _rlhGl33BindTexture(gl, RLH_ANIMATION_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_animation_texture_2d);
+    }
+    if (gl->light_map_mode)
+    {
+      _rlhGl33BindTexture(gl, RLH_LIGHT_MAP_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_light_map_texture_2d);
+    }
+  }
+
+  // Draw the tiles with the blend mode and scissor that are already set.
+  static void _rlhGl33DrawTiles(rlhGl33Term_s *gl, const float *matrix_4x4, size_t element_count)
+  {
+    GLD_START();
+    // Bind objects
+    _rlhGl33BindVertexArray(gl, gl->gl_vertex_array);
+    _rlhGl33UseProgram(gl, gl->gl_program);
+    _rlhGl33BindTileTextures(gl);
+    // set the matrix uniform
+    _rlhGl33SetMatrix(gl->gl_matrix_uniform_location, matrix_4x4, gl->matrix, &gl->matrix_set);
+#ifdef RLH_STATS_TIMERS
+    // if every query is still waiting to be read, skip timing this draw instead of stalling
+    const rlhbool_t timed = gl->timer_query_pending < RLH_GL33_TIMER_QUERY_COUNT;
+    if (timed)
+    {
+      GLD_CALL(glBeginQuery(GL_TIME_ELAPSED, gl->gl_timer_queries[gl->timer_query_next]));
+    }
+#endif
+    // DRAW!!!
+    GLD_CALL(glDrawElements(GL_TRIANGLES, element_count, GL_UNSIGNED_INT, NULL));
+#ifdef RLH_STATS_TIMERS
+    if (timed)
+    {
+      GLD_CALL(glEndQuery(GL_TIME_ELAPSED));
+      gl->timer_query_next = (gl->timer_query_next + 1) % RLH_GL33_TIMER_QUERY_COUNT;
+      gl->timer_query_pending++;
+    }
+#endif
+  }
+
+  static rlhresult_t _rlhGl33Draw(void *backend_data, const float *matrix_4x4, size_t element_count, const rlhScissor_t *scissor)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    if (scissor != NULL)
+    {
+      _rlhGl33SetScissor(gl, scissor);
+    }
+    // set blend mode
+    _rlhGl33SetBlend(gl, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    _rlhGl33DrawTiles(gl, matrix_4x4, element_count);
+    if (scissor != NULL)
+    {
+      // unset the scissor, so it does not clip what the application draws or clears next
+      _rlhGl33SetScissorTest(gl, RLH_FALSE);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  // Make the cache image and the objects to draw it with, or resize the image.
+  // Create the framebuffer that tiles are drawn into textures through.
+  static void _rlhGl33PrepareFramebuffer(rlhGl33Term_s *gl)
+  {
+    GLD_START();
+    if (gl->gl_cache_framebuffer == GL_NONE)
+    {
+      GLD_CALL(glGenFramebuffers(1, &gl->gl_cache_framebuffer));
+    }
+  }
+
+  static rlhresult_t _rlhGl33PrepareCache(rlhGl33Term_s *gl, const int cache_width, const int cache_height)
+  {
+    GLD_START();
+    _rlhGl33PrepareFramebuffer(gl);
+    if (gl->gl_cache_texture_2d == GL_NONE)
+    {
+      gl->gl_cache_program = _rlhCreateGlProgram(RLH_CACHE_VERTEX_SOURCE, RLH_CACHE_FRAGMENT_SOURCE);
+      _rlhGl33UseProgram(gl, gl->gl_cache_program);
+      GLD_CALL(gl->gl_cache_matrix_uniform_location = glGetUniformLocation(gl->gl_cache_program, "u_matrix"));
+      GLint cache_slot_uniform;
+      GLD_CALL(cache_slot_uniform = glGetUniformLocation(gl->gl_cache_program, "u_cache"));
+      GLD_CALL(glUniform1i(cache_slot_uniform, RLH_CACHE_TEXTURE_SLOT));
+      // the quad has no vertex data, but core profile contexts can not draw without a vertex array
+      GLD_CALL(glGenVertexArrays(1, &gl->gl_cache_vertex_array));
+      GLD_CALL(glGenTextures(1, &gl->gl_cache_texture_2d));
+      _rlhGl33BindTexture(gl, RLH_CACHE_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_cache_texture_2d);
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+    }
+    if (cache_width != gl->cache_width || cache_height != gl->cache_height)
+    {
+      _rlhGl33BindTexture(gl, RLH_CACHE_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_cache_texture_2d);
+      GLD_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cache_width, cache_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+      gl->cache_width = cache_width;
+      gl->cache_height = cache_height;
+    }
+    return RLH_RESULT_OK;
+  }
+
+  // Draw the tiles into all of a texture that is width by height pixels through the cache framebuffer.
+  static rlhresult_t _rlhGl33DrawTilesToTexture(rlhGl33Term_s *gl, size_t element_count, GLuint texture, int width, int height)
+  {
+    GLD_START();
+    // Put back the framebuffer, viewport and clear color of the caller after drawing the image.
+    GLint framebuffer;
+    GLint viewport[4];
+    GLfloat clear_color[4];
+    GLD_CALL(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer));
+    GLD_CALL(glGetIntegerv(GL_VIEWPORT, viewport));
+    GLD_CALL(glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color));
+    GLD_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gl->gl_cache_framebuffer));
+    GLD_CALL(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0));
+    GLenum status;
+    GLD_CALL(status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+      GLD_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)framebuffer));
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    GLD_CALL(glViewport(0, 0, width, height));
+    GLD_CALL(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+    GLD_CALL(glClear(GL_COLOR_BUFFER_BIT));
+    // Keep the image premultiplied, so drawing it over the screen blends like drawing the tiles would.
+    _rlhGl33SetBlend(gl, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    _rlhGl33DrawTiles(gl, RLH_OPENGL_SCREEN_MATRIX, element_count);
+    GLD_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)framebuffer));
+    GLD_CALL(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+    GLD_CALL(glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]));
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33DrawCached(void *backend_data, const float *matrix_4x4, size_t element_count, const rlhScissor_t *scissor, int cache_width, int cache_height, rlhbool_t redraw)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    if (redraw)
+    {
+      rlhresult_t result = _rlhGl33PrepareCache(gl, cache_width, cache_height);
+      if (result == RLH_RESULT_OK)
+      {
+        result = _rlhGl33DrawTilesToTexture(gl, element_count, gl->gl_cache_texture_2d, cache_width, cache_height);
+      }
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+    }
+    if (gl->gl_cache_texture_2d == GL_NONE)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (scissor != NULL)
+    {
+      _rlhGl33SetScissor(gl, scissor);
+    }
+    _rlhGl33SetBlend(gl, GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    _rlhGl33BindVertexArray(gl, gl->gl_cache_vertex_array);
+    _rlhGl33UseProgram(gl, gl->gl_cache_program);
+    _rlhGl33BindTexture(gl, RLH_CACHE_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_cache_texture_2d);
+    _rlhGl33SetMatrix(gl->gl_cache_matrix_uniform_location, matrix_4x4, gl->cache_matrix, &gl->cache_matrix_set);
+    GLD_CALL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+    if (scissor != NULL)
+    {
+      // unset the scissor, so it does not clip what the application draws or clears next
+      _rlhGl33SetScissorTest(gl, RLH_FALSE);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33DrawToTexture(void *backend_data, size_t element_count, uint32_t texture, int width, int height, uint32_t *drawn_texture)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    if (texture == 0)
+    {
+      rlhresult_t result = _rlhGl33PrepareCache(gl, width, height);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      texture = gl->gl_cache_texture_2d;
+    }
+    else
+    {
+      GLboolean is_texture;
+      GLD_CALL(is_texture = glIsTexture(texture));
+      if (!is_texture)
+      {
+        return RLH_RESULT_ERROR_INVALID_VALUE;
+      }
+      // Binding a texture of another target fails and leaves the texture that was bound before.
+      _rlhGl33BindTexture(gl, RLH_CACHE_TEXTURE_SLOT, GL_TEXTURE_2D, texture);
+      GLint bound_texture;
+      GLD_CALL(glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound_texture));
+      if ((GLuint)bound_texture != texture)
+      {
+        // take the error of the failed bind, so the application does not see it
+        GLD_CALL(glGetError());
+        _rlhGl33GetState(gl)->textures[RLH_CACHE_TEXTURE_SLOT] = (GLuint)bound_texture;
+        return RLH_RESULT_ERROR_INVALID_VALUE;
+      }
+      // the size of a texture of the application is whatever it was made with
+      GLD_CALL(glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width));
+      GLD_CALL(glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height));
+      // do not leave the texture of the application bound, it could be deleted and its name reused
+      _rlhGl33BindTexture(gl, RLH_CACHE_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_cache_texture_2d);
+      if (width <= 0 || height <= 0)
+      {
+        return RLH_RESULT_ERROR_INVALID_VALUE;
+      }
+      _rlhGl33PrepareFramebuffer(gl);
+    }
+    const rlhresult_t result = _rlhGl33DrawTilesToTexture(gl, element_count, texture, width, height);
+    if (result == RLH_RESULT_OK)
+    {
+      *drawn_texture = texture;
+    }
+    return result;
+  }
+
+#ifdef RLH_STATS_TIMERS
+  static rlhbool_t _rlhGl33ReadGpuTime(void *backend_data, uint64_t *gpu_ns)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    if (gl->timer_query_pending == 0)
+      return RLH_FALSE;
+    const size_t oldest = (gl->timer_query_next + RLH_GL33_TIMER_QUERY_COUNT - gl->timer_query_pending) % RLH_GL33_TIMER_QUERY_COUNT;
+    GLD_START();
+    GLint available = GL_FALSE;
+    GLD_CALL(glGetQueryObjectiv(gl->gl_timer_queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available));
+    if (!available)
+      return RLH_FALSE;
+    GLuint64 elapsed_ns = 0;
+    GLD_CALL(glGetQueryObjectui64v(gl->gl_timer_queries[oldest], GL_QUERY_RESULT, &elapsed_ns));
+    gl->timer_query_pending--;
+    *gpu_ns = elapsed_ns;
+    return RLH_TRUE;
+  }
+#endif
+
+  static rlhresult_t _rlhGl33SetPalette(void *backend_data, const rlhColor8_s *palette)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    if (palette != NULL)
+    {
+      if (gl->gl_palette_texture_2d == GL_NONE)
+      {
+        GLD_CALL(glGenTextures(1, &gl->gl_palette_texture_2d));
+        _rlhGl33BindTexture(gl, RLH_PALETTE_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_palette_texture_2d);
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+        GLD_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, RLH_PALETTE_SIZE, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, palette));
+      }
+      else
+      {
+        _rlhGl33BindTexture(gl, RLH_PALETTE_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_palette_texture_2d);
+        GLD_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, RLH_PALETTE_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, palette));
+      }
+    }
+    gl->palette_mode = (rlhbool_t)(palette != NULL);
+    if (gl->gl_program != GL_NONE)
+    {
+      _rlhGl33UseProgram(gl, gl->gl_program);
+      GLD_CALL(glUniform1i(gl->gl_palette_mode_uniform_location, gl->palette_mode));
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33SetAnimation(void *backend_data, uint16_t animation, const rlhAnimationInfo_t *animation_info, const float *glyph_stpqp)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    if (gl->gl_animation_texture_2d == GL_NONE)
+    {
+      // start with every row zeroed, so tiles with animations that were never set do not animate
+      const size_t texture_size = (size_t)RLH_GL33_ANIMATION_TEXELS * RLH_ANIMATION_COUNT * 4 * sizeof(float);
+      float *const zeroes = (float *)RLH_MALLOC(texture_size, NULL);
+      if (zeroes == NULL)
+      {
+        return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      memset(zeroes, 0, texture_size);
+      GLD_CALL(glGenTextures(1, &gl->gl_animation_texture_2d));
+      _rlhGl33BindTexture(gl, RLH_ANIMATION_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_animation_texture_2d);
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+      GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+      GLD_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, RLH_GL33_ANIMATION_TEXELS, RLH_ANIMATION_COUNT, 0, GL_RGBA, GL_FLOAT, zeroes));
+      RLH_FREE(zeroes, NULL);
+    }
+    else
+    {
+      _rlhGl33BindTexture(gl, RLH_ANIMATION_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_animation_texture_2d);
+    }
+    float row[RLH_GL33_ANIMATION_TEXELS * 4];
+    memset(row, 0, sizeof(row));
+    if (animation_info != NULL)
+    {
+      row[0] = glyph_stpqp != NULL ? (float)animation_info->frame_count : 0.0f;
+      row[1] = animation_info->frame_duration;
+      row[2] = animation_info->color_period;
+      const uint8_t *const fg = &animation_info->fg.r;
+      const uint8_t *const bg = &animation_info->bg.r;
+      for (int i = 0; i < 4; i++)
+      {
+        row[4 + i] = fg[i] / 255.0f;
+        row[8 + i] = bg[i] / 255.0f;
+      }
+      for (int frame = 0; glyph_stpqp != NULL && frame < animation_info->frame_count; frame++)
+      {
+        const float *const stpqp = glyph_stpqp + frame * RLH_FONTMAP_COORDINATES_PER_GLYPH;
+        float *const texels = row + (3 + frame * 2) * 4;
+        texels[0] = stpqp[0];
+        texels[1] = stpqp[1];
+        texels[2] = stpqp[2];
+        texels[3] = stpqp[3];
+        texels[4] = stpqp[4];
+      }
+    }
+    GLD_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, animation, RLH_GL33_ANIMATION_TEXELS, 1, GL_RGBA, GL_FLOAT, row));
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33SetAnimationTime(void *backend_data, float seconds)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    gl->animation_time = seconds;
+    if (gl->gl_program != GL_NONE)
+    {
+      _rlhGl33UseProgram(gl, gl->gl_program);
+      GLD_CALL(glUniform1f(gl->gl_time_uniform_location, seconds));
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33SetLightMap(void *backend_data, const rlhColor8_s *light_map, int width, int height, float cells_wide, float cells_tall)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    if (light_map != NULL)
+    {
+      if (gl->gl_light_map_texture_2d == GL_NONE)
+      {
+        GLD_CALL(glGenTextures(1, &gl->gl_light_map_texture_2d));
+        _rlhGl33BindTexture(gl, RLH_LIGHT_MAP_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_light_map_texture_2d);
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+        GLD_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+      }
+      else
+      {
+        _rlhGl33BindTexture(gl, RLH_LIGHT_MAP_TEXTURE_SLOT, GL_TEXTURE_2D, gl->gl_light_map_texture_2d);
+      }
+      if (width != gl->light_map_width || height != gl->light_map_height)
+      {
+        GLD_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, light_map));
+        gl->light_map_width = width;
+        gl->light_map_height = height;
+      }
+      else
+      {
+        GLD_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, light_map));
+      }
+      gl->light_map_cells_wide = cells_wide;
+      gl->light_map_cells_tall = cells_tall;
+    }
+    gl->light_map_mode = (rlhbool_t)(light_map != NULL);
+    if (gl->gl_program != GL_NONE)
+    {
+      _rlhGl33UseProgram(gl, gl->gl_program);
+      GLD_CALL(glUniform1i(gl->gl_light_map_mode_uniform_location, gl->light_map_mode));
+      GLD_CALL(glUniform2f(gl->gl_light_map_cells_uniform_location, gl->light_map_cells_wide, gl->light_map_cells_tall));
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33SetCells(void *backend_data, float cells_wide, float cells_tall)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    gl->cells_wide = cells_wide;
+    gl->cells_tall = cells_tall;
+    if (gl->gl_program != GL_NONE)
+    {
+      _rlhGl33UseProgram(gl, gl->gl_program);
+      GLD_CALL(glUniform2f(gl->gl_cells_uniform_location, cells_wide, cells_tall));
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33SetMotion(void *backend_data, float alpha, float pixels_wide, float pixels_tall)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    GLD_START();
+    gl->motion_alpha = alpha;
+    // the motion of vertices is in pixels, and their positions go from 0.0 to 1.0 across the terminal
+    gl->motion_scale_x = pixels_wide > 0.0f ? 1.0f / pixels_wide : 0.0f;
+    gl->motion_scale_y = pixels_tall > 0.0f ? 1.0f / pixels_tall : 0.0f;
+    if (gl->gl_program != GL_NONE)
+    {
+      _rlhGl33UseProgram(gl, gl->gl_program);
+      GLD_CALL(glUniform1f(gl->gl_motion_alpha_uniform_location, gl->motion_alpha));
+      GLD_CALL(glUniform2f(gl->gl_motion_scale_uniform_location, gl->motion_scale_x, gl->motion_scale_y));
+    }
+    return RLH_RESULT_OK;
+  }
+
+  // Point the attributes of the bound vertex array at a particle state buffer and the particle
+  // buffer. The update only reads what moving the particles needs, one particle per vertex, and the
+  // draw reads every property once per instance.
+  static void _rlhGl33SetParticleAttributes(rlhGl33Term_s *gl, const GLuint state_buffer, const rlhbool_t instanced)
+  {
+    GLD_START();
+    const GLsizei state_stride = sizeof(rlhGl33ParticleState_s);
+    const GLsizei stride = sizeof(rlhParticle_s);
+    _rlhGl33BindArrayBuffer(gl, state_buffer);
+    // position and velocity
+    GLD_CALL(glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, state_stride, (void *)offsetof(rlhGl33ParticleState_s, x)));
+    GLD_CALL(glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, state_stride, (void *)offsetof(rlhGl33ParticleState_s, age)));
+    _rlhGl33BindArrayBuffer(gl, gl->gl_particle_buffer);
+    // lifetime, acceleration and drag
+    GLD_CALL(glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(rlhParticle_s, lifetime)));
+    GLuint attribute_count = 3;
+    if (instanced)
+    {
+      GLD_CALL(glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(rlhParticle_s, width)));
+      GLD_CALL(glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(rlhParticle_s, s)));
+      GLD_CALL(glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, stride, (void *)offsetof(rlhParticle_s, page)));
+      GLD_CALL(glVertexAttribPointer(6, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)offsetof(rlhParticle_s, fg)));
+      GLD_CALL(glVertexAttribPointer(7, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)offsetof(rlhParticle_s, bg)));
+      GLD_CALL(glVertexAttribPointer(8, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)offsetof(rlhParticle_s, fg_end)));
+      GLD_CALL(glVertexAttribPointer(9, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *)offsetof(rlhParticle_s, bg_end)));
+      attribute_count = 10;
+    }
+    for (GLuint attribute = 0; attribute < attribute_count; attribute++)
+    {
+      GLD_CALL(glEnableVertexAttribArray(attribute));
+      GLD_CALL(glVertexAttribDivisor(attribute, instanced ? 1 : 0));
+    }
+  }
+
+  static rlhresult_t _rlhGl33SetParticleCapacity(void *backend_data, size_t capacity)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    _rlhGl33DeleteParticles(gl);
+    if (capacity == 0)
+    {
+      return RLH_RESULT_OK;
+    }
+    // Every slot starts as a dead particle, with a lifetime of 0 that is over before it starts.
+    void *zeros = RLH_MALLOC(capacity * sizeof(rlhParticle_s), NULL);
+    if (zeros == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memset(zeros, 0, capacity * sizeof(rlhParticle_s));
+    GLD_START();
+    static const char *const varyings[2] = {"v_motion", "v_age"};
+    gl->gl_particle_update_program = _rlhCreateGlFeedbackProgram(RLH_PARTICLE_UPDATE_SOURCE, varyings, 2);
+    GLD_CALL(gl->gl_particle_seconds_uniform_location = glGetUniformLocation(gl->gl_particle_update_program, "u_seconds"));
+    GLD_CALL(glGenBuffers(2, gl->gl_particle_state_buffers));
+    GLD_CALL(glGenBuffers(1, &gl->gl_particle_buffer));
+    GLD_CALL(glGenVertexArrays(2, gl->gl_particle_update_vertex_arrays));
+    GLD_CALL(glGenVertexArrays(2, gl->gl_particle_vertex_arrays));
+    for (int i = 0; i < 2; i++)
+    {
+      _rlhGl33BindArrayBuffer(gl, gl->gl_particle_state_buffers[i]);
+      GLD_CALL(glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(rlhGl33ParticleState_s), zeros, GL_DYNAMIC_COPY));
+    }
+    _rlhGl33BindArrayBuffer(gl, gl->gl_particle_buffer);
+    GLD_CALL(glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(rlhParticle_s), zeros, GL_DYNAMIC_DRAW));
+    RLH_FREE(zeros, NULL);
+    for (int i = 0; i < 2; i++)
+    {
+      _rlhGl33BindVertexArray(gl, gl->gl_particle_update_vertex_arrays[i]);
+      _rlhGl33SetParticleAttributes(gl, gl->gl_particle_state_buffers[i], RLH_FALSE);
+      _rlhGl33BindVertexArray(gl, gl->gl_particle_vertex_arrays[i]);
+      _rlhGl33SetParticleAttributes(gl, gl->gl_particle_state_buffers[i], RLH_TRUE);
+    }
+    _rlhGl33BindVertexArray(gl, GL_NONE);
+    gl->particle_capacity = capacity;
+    gl->particle_next = 0;
+    gl->particle_state = 0;
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33UpdateParticles(void *backend_data, float seconds, const rlhParticle_s *particles, size_t count)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    if (gl->particle_capacity == 0)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    GLD_START();
+    if (seconds > 0.0f)
+    {
+      // Read one state buffer and write the other, which is then the one that is drawn.
+      const int next_state = 1 - gl->particle_state;
+      _rlhGl33UseProgram(gl, gl->gl_particle_update_program);
+      GLD_CALL(glUniform1f(gl->gl_particle_seconds_uniform_location, seconds));
+      _rlhGl33BindVertexArray(gl, gl->gl_particle_update_vertex_arrays[gl->particle_state]);
+      GLD_CALL(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, gl->gl_particle_state_buffers[next_state]));
+      GLD_CALL(glEnable(GL_RASTERIZER_DISCARD));
+      GLD_CALL(glBeginTransformFeedback(GL_POINTS));
+      GLD_CALL(glDrawArrays(GL_POINTS, 0, (GLsizei)gl->particle_capacity));
+      GLD_CALL(glEndTransformFeedback());
+      GLD_CALL(glDisable(GL_RASTERIZER_DISCARD));
+      GLD_CALL(glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, GL_NONE));
+      gl->particle_state = next_state;
+    }
+    // New particles go into the slots after the last ones, wrapping around to replace the oldest.
+    rlhGl33ParticleState_s states[64];
+    size_t added = 0;
+    while (added < count)
+    {
+      const size_t slot = gl->particle_next;
+      const size_t batch = MIN(MIN(count - added, gl->particle_capacity - slot), sizeof(states) / sizeof(states[0]));
+      for (size_t i = 0; i < batch; i++)
+      {
+        const rlhParticle_s *const particle = &particles[added + i];
+        states[i].x = particle->x;
+        states[i].y = particle->y;
+        states[i].velocity_x = particle->velocity_x;
+        states[i].velocity_y = particle->velocity_y;
+        states[i].age = particle->age;
+      }
+      _rlhGl33BindArrayBuffer(gl, gl->gl_particle_state_buffers[gl->particle_state]);
+      GLD_CALL(glBufferSubData(GL_ARRAY_BUFFER, slot * sizeof(rlhGl33ParticleState_s), batch * sizeof(rlhGl33ParticleState_s), states));
+      _rlhGl33BindArrayBuffer(gl, gl->gl_particle_buffer);
+      GLD_CALL(glBufferSubData(GL_ARRAY_BUFFER, slot * sizeof(rlhParticle_s), batch * sizeof(rlhParticle_s), particles + added));
+      gl->particle_next = (slot + batch) % gl->particle_capacity;
+      added += batch;
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static rlhresult_t _rlhGl33DrawParticles(void *backend_data, const float *matrix_4x4, const rlhScissor_t *scissor, float pixels_wide, float pixels_tall)
+  {
+    rlhGl33Term_s *gl = (rlhGl33Term_s *)backend_data;
+    if (gl->particle_capacity == 0)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    GLD_START();
+    if (gl->particle_fragment_type != gl->fragment_type)
+    {
+      // Particles use the fragment shader of the tiles, which depends on the atlas.
+      if (gl->gl_particle_program != GL_NONE)
+      {
+        GLD_CALL(glDeleteProgram(gl->gl_particle_program));
+      }
+      gl->gl_particle_program = _rlhCreateGlProgram(RLH_PARTICLE_VERTEX_SOURCE, _rlhFragmentSourceFromFragmentType(gl->fragment_type));
+      gl->particle_fragment_type = gl->fragment_type;
+      gl->particle_matrix_set = RLH_FALSE;
+      _rlhGl33InvalidateState(gl);
+      _rlhGl33UseProgram(gl, gl->gl_particle_program);
+      GLD_CALL(gl->gl_particle_matrix_uniform_location = glGetUniformLocation(gl->gl_particle_program, "u_matrix"));
+      GLD_CALL(gl->gl_particle_pixel_scale_uniform_location = glGetUniformLocation(gl->gl_particle_program, "u_pixel_scale"));
+      GLD_CALL(gl->gl_particle_palette_mode_uniform_location = glGetUniformLocation(gl->gl_particle_program, "u_palette_mode"));
+      GLD_CALL(gl->gl_particle_light_map_mode_uniform_location = glGetUniformLocation(gl->gl_particle_program, "u_light_map_mode"));
+      GLD_CALL(gl->gl_particle_light_map_cells_uniform_location = glGetUniformLocation(gl->gl_particle_program, "u_light_map_cells"));
+      GLint slot_uniform;
+      GLD_CALL(slot_uniform = glGetUniformLocation(gl->gl_particle_program, "u_atlas"));
+      GLD_CALL(glUniform1i(slot_uniform, RLH_ATLAS_TEXTURE_SLOT));
+      GLD_CALL(slot_uniform = glGetUniformLocation(gl->gl_particle_program, "u_palette"));
+      GLD_CALL(glUniform1i(slot_uniform, RLH_PALETTE_TEXTURE_SLOT));
+      GLD_CALL(slot_uniform = glGetUniformLocation(gl->gl_particle_program, "u_light_map"));
+      GLD_CALL(glUniform1i(slot_uniform, RLH_LIGHT_MAP_TEXTURE_SLOT));
+    }
+    if (scissor != NULL)
+    {
+      _rlhGl33SetScissor(gl, scissor);
+    }
+    _rlhGl33SetBlend(gl, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    _rlhGl33BindVertexArray(gl, gl->gl_particle_vertex_arrays[gl->particle_state]);
+    _rlhGl33UseProgram(gl, gl->gl_particle_program);
+    _rlhGl33BindTileTextures(gl);
+    // the tiles keep these uniforms up to date as they change, the particles just set them every draw
+    GLD_CALL(glUniform2f(gl->gl_particle_pixel_scale_uniform_location, 1.0f / pixels_wide, 1.0f / pixels_tall));
+    GLD_CALL(glUniform1i(gl->gl_particle_palette_mode_uniform_location, gl->palette_mode));
+    GLD_CALL(glUniform1i(gl->gl_particle_light_map_mode_uniform_location, gl->light_map_mode));
+    GLD_CALL(glUniform2f(gl->gl_particle_light_map_cells_uniform_location, gl->light_map_cells_wide, gl->light_map_cells_tall));
+    _rlhGl33SetMatrix(gl->gl_particle_matrix_uniform_location, matrix_4x4, gl->particle_matrix, &gl->particle_matrix_set);
+    GLD_CALL(glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)gl->particle_capacity));
+    if (scissor != NULL)
+    {
+      _rlhGl33SetScissorTest(gl, RLH_FALSE);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  const rlhBackend_t RLH_BACKEND_GL33 = {
+      "gl33",
+      NULL,
+      _rlhGl33Create,
+      _rlhGl33Destroy,
+      _rlhGl33CreateAtlas,
+      _rlhGl33UploadVertices,
+      _rlhGl33UploadElements,
+      _rlhGl33Draw,
+#ifdef RLH_STATS_TIMERS
+      _rlhGl33ReadGpuTime,
+#else
+      NULL,
+#endif
+      _rlhGl33SetPalette,
+      _rlhGl33BeginAtlasUpload,
+      _rlhGl33EndAtlasUpload,
+      _rlhGl33StepAtlasUpload,
+      _rlhGl33SetAnimation,
+      _rlhGl33SetAnimationTime,
+      _rlhGl33SetLightMap,
+      _rlhGl33DrawCached,
+      _rlhGl33DrawToTexture,
+      _rlhGl33SetCells,
+      _rlhGl33SetMotion,
+      _rlhGl33SetParticleCapacity,
+      _rlhGl33UpdateParticles,
+      _rlhGl33DrawParticles};
+
+  void rlhClearColor(const rlhColor_s color)
+  {
+    GLD_START();
+    GLD_CALL(glClearColor(color.r, color.g, color.b, color.a));
+    GLD_CALL(glClear(GL_COLOR_BUFFER_BIT));
+  }
+
+  void rlhViewport(const int x, const int y, const int width, const int height)
+  {
+    GLD_START();
+    GLD_CALL(glViewport(x, y, width, height));
+  }
+
+  void rlhInvalidateGlState(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      RLH_ATOMIC_EXCHANGE(&_rlhGl33StateOwner, 0);
+      return;
+    }
+    if (term->backend->create == _rlhGl33Create)
+    {
+      _rlhGl33InvalidateState((rlhGl33Term_s *)term->backend_data);
+    }
+  }
+#endif
+
+  // Recordings are a header followed by records, each of which starts with a tag byte. Pushes are
+  // stored as differences from the previous push, and only store the size and colors if they
+  // changed. All values are in the byte order of the machine that recorded them.
+  typedef enum rlhrecordtag_t
+  {
+    RLH_RECORD_PUSH = 0,
+    RLH_RECORD_CLEAR = 1,
+    RLH_RECORD_FRAME = 2,
+    RLH_RECORD_SIZE = 3,
+    RLH_RECORD_ATLAS = 4,
+    RLH_RECORD_PALETTE = 5,
+    RLH_RECORD_ANIMATION = 6,
+    RLH_RECORD_ANIMATION_TIME = 7,
+    RLH_RECORD_LIGHT_MAP = 8,
+    // The motion of the push right after it, which did not move if there is none.
+    RLH_RECORD_MOTION = 9,
+    RLH_RECORD_MOTION_ALPHA = 10,
+    RLH_RECORD_PARTICLE_CAPACITY = 11,
+    // Emitted particles as they were made, so replays do not depend on how they were spread out.
+    RLH_RECORD_PARTICLES = 12,
+    RLH_RECORD_PARTICLE_TIME = 13,
+    RLH_RECORD_TAG_MASK = 0x0f,
+    RLH_RECORD_PUSH_SIZE_CHANGED = 0x10,
+    RLH_RECORD_PUSH_FG_CHANGED = 0x20,
+    RLH_RECORD_PUSH_BG_CHANGED = 0x40,
+    RLH_RECORD_PUSH_ANIMATION_CHANGED = 0x80
+  } rlhrecordtag_t;
+
+  static const char RLH_RECORD_MAGIC[8] = {'R', 'L', 'H', 'R', 'E', 'C', '\0', '\0'};
+#define RLH_RECORD_VERSION 1u
+#define RLH_RECORD_BYTE_ORDER 0x01020304u
+#define RLH_RECORD_FLAG_RETAINED 1u
+// tag, six varints of at most 10 bytes and two colors.
+#define RLH_RECORD_MAX_PUSH_SIZE (1 + 6 * 10 + 2 * sizeof(rlhColor8_s))
+#define RLH_RECORD_BUFFER_SIZE 65536
+
+  typedef struct rlhRecordPush_s
+  {
+    int64_t x;
+    int64_t y;
+    int64_t width;
+    int64_t height;
+    int64_t glyph;
+    int64_t animation;
+    rlhColor8_s fg;
+    rlhColor8_s bg;
+  } rlhRecordPush_s;
+
+  typedef struct rlhRecorder_s
+  {
+    FILE *file;
+    rlhbool_t failed;
+    uint64_t bytes_written;
+    rlhRecordPush_s last_push;
+    size_t buffer_used;
+    uint8_t buffer[RLH_RECORD_BUFFER_SIZE];
+  } rlhRecorder_s;
+
+  static inline void _rlhRecorderFlush(rlhRecorder_s *const recorder)
+  {
+    if (!recorder->failed && recorder->buffer_used != 0 &&
+        fwrite(recorder->buffer, 1, recorder->buffer_used, recorder->file) != recorder->buffer_used)
+    {
+      recorder->failed = RLH_TRUE;
+    }
+    recorder->buffer_used = 0;
+  }
+
+  // Get space for size bytes at the end of the record buffer, which can not be more than its size.
+  static inline uint8_t *_rlhRecorderReserve(rlhRecorder_s *const recorder, const size_t size)
+  {
+    if (recorder->buffer_used + size > RLH_RECORD_BUFFER_SIZE)
+    {
+      _rlhRecorderFlush(recorder);
+    }
+    return recorder->buffer + recorder->buffer_used;
+  }
+
+  static inline void _rlhRecorderCommit(rlhRecorder_s *const recorder, const size_t size)
+  {
+    recorder->buffer_used += size;
+    recorder->bytes_written += size;
+  }
+
+  static inline void _rlhRecorderWrite(rlhRecorder_s *const recorder, const void *const data, const size_t size)
+  {
+    if (size > RLH_RECORD_BUFFER_SIZE)
+    {
+      // Large payloads like atlas pixels skip the buffer.
+      _rlhRecorderFlush(recorder);
+      if (!recorder->failed && fwrite(data, 1, size, recorder->file) != size)
+      {
+        recorder->failed = RLH_TRUE;
+      }
+      recorder->bytes_written += size;
+      return;
+    }
+    memcpy(_rlhRecorderReserve(recorder, size), data, size);
+    _rlhRecorderCommit(recorder, size);
+  }
+
+  // Pad the recording with zeros so the next byte is at an offset that is a multiple of alignment.
+  static inline void _rlhRecorderAlign(rlhRecorder_s *const recorder, const size_t alignment)
+  {
+    const size_t padding = (alignment - recorder->bytes_written % alignment) % alignment;
+    memset(_rlhRecorderReserve(recorder, padding), 0, padding);
+    _rlhRecorderCommit(recorder, padding);
+  }
+
+  static inline uint8_t *_rlhWriteVarint(uint8_t *out, const int64_t value)
+  {
+    // zigzag encode so small negative differences are small too.
+    uint64_t bits = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    while (bits >= 0x80)
+    {
+      *out++ = (uint8_t)(bits | 0x80);
+      bits >>= 7;
+    }
+    *out++ = (uint8_t)bits;
+    return out;
+  }
+
+  static inline void _rlhRecordTag(rlhRecorder_s *const recorder, const uint8_t tag)
+  {
+    *_rlhRecorderReserve(recorder, 1) = tag;
+    _rlhRecorderCommit(recorder, 1);
+  }
+
+  static inline void _rlhRecordPush(rlhRecorder_s *const recorder, const int pixel_x, const int pixel_y,
+                                    const int pixel_w, const int pixel_h, const uint16_t glyph,
+                                    const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    rlhRecordPush_s *const last = &recorder->last_push;
+    uint8_t *const start = _rlhRecorderReserve(recorder, RLH_RECORD_MAX_PUSH_SIZE);
+    uint8_t tag = RLH_RECORD_PUSH;
+    uint8_t *out = start + 1;
+    out = _rlhWriteVarint(out, pixel_x - last->x);
+    out = _rlhWriteVarint(out, pixel_y - last->y);
+    out = _rlhWriteVarint(out, glyph - last->glyph);
+    if (pixel_w != last->width || pixel_h != last->height)
+    {
+      tag |= RLH_RECORD_PUSH_SIZE_CHANGED;
+      out = _rlhWriteVarint(out, pixel_w - last->width);
+      out = _rlhWriteVarint(out, pixel_h - last->height);
+    }
+    if (animation != last->animation)
+    {
+      tag |= RLH_RECORD_PUSH_ANIMATION_CHANGED;
+      out = _rlhWriteVarint(out, animation - last->animation);
+    }
+    if (memcmp(&fg, &last->fg, sizeof(rlhColor8_s)) != 0)
+    {
+      tag |= RLH_RECORD_PUSH_FG_CHANGED;
+      memcpy(out, &fg, sizeof(rlhColor8_s));
+      out += sizeof(rlhColor8_s);
+    }
+    if (memcmp(&bg, &last->bg, sizeof(rlhColor8_s)) != 0)
+    {
+      tag |= RLH_RECORD_PUSH_BG_CHANGED;
+      memcpy(out, &bg, sizeof(rlhColor8_s));
+      out += sizeof(rlhColor8_s);
+    }
+    *start = tag;
+    last->x = pixel_x;
+    last->y = pixel_y;
+    last->width = pixel_w;
+    last->height = pixel_h;
+    last->glyph = glyph;
+    last->animation = animation;
+    last->fg = fg;
+    last->bg = bg;
+    _rlhRecorderCommit(recorder, (size_t)(out - start));
+  }
+
+  static inline void _rlhRecordSize(rlhRecorder_s *const recorder, const rlhTermSizeInfo_t *const size_info)
+  {
+    const int32_t values[7] = {size_info->width, size_info->height, size_info->size_mode,
+                               size_info->floor_pixels_to_tiles, size_info->pixel_scale,
+                               size_info->tile_width, size_info->tile_height};
+    _rlhRecordTag(recorder, RLH_RECORD_SIZE);
+    _rlhRecorderWrite(recorder, values, sizeof(values));
+  }
+
+  static inline void _rlhRecordAtlas(rlhRecorder_s *const recorder, const rlhAtlasCreateInfo_t *const atlas_info)
+  {
+    const int32_t values[6] = {atlas_info->width, atlas_info->height, atlas_info->pages,
+                               atlas_info->channel_size, atlas_info->color, atlas_info->glyph_count};
+    const uint64_t pixel_data_size = _rlhGetAtlasPixelDataSize(atlas_info);
+    _rlhRecordTag(recorder, RLH_RECORD_ATLAS);
+    _rlhRecorderWrite(recorder, values, sizeof(values));
+    _rlhRecorderWrite(recorder, &pixel_data_size, sizeof(pixel_data_size));
+    // Align the pixels and glyph coordinates, so a replay can use them straight from the file.
+    _rlhRecorderAlign(recorder, 8);
+    _rlhRecorderWrite(recorder, atlas_info->pixel_data, (size_t)pixel_data_size);
+    _rlhRecorderAlign(recorder, sizeof(float));
+    _rlhRecorderWrite(recorder, atlas_info->glyph_stpqp,
+                      atlas_info->glyph_count * RLH_FONTMAP_COORDINATES_PER_GLYPH * sizeof(float));
+  }
+
+  static inline void _rlhRecordPalette(rlhRecorder_s *const recorder, const rlhbool_t palette_mode,
+                                       const rlhColor8_s *const palette)
+  {
+    _rlhRecordTag(recorder, RLH_RECORD_PALETTE);
+    _rlhRecordTag(recorder, (uint8_t)(palette_mode ? 1 : 0));
+    _rlhRecorderWrite(recorder, palette, RLH_PALETTE_SIZE * sizeof(rlhColor8_s));
+  }
+
+  static inline void _rlhRecordAnimation(rlhRecorder_s *const recorder, const uint16_t animation,
+                                         const rlhAnimationInfo_t *const animation_info)
+  {
+    _rlhRecordTag(recorder, RLH_RECORD_ANIMATION);
+    const int32_t values[4] = {animation, animation_info != NULL,
+                               animation_info != NULL ? animation_info->base_glyph : 0,
+                               animation_info != NULL ? animation_info->frame_count : 0};
+    _rlhRecorderWrite(recorder, values, sizeof(values));
+    if (animation_info != NULL)
+    {
+      const float timing[2] = {animation_info->frame_duration, animation_info->color_period};
+      _rlhRecorderWrite(recorder, timing, sizeof(timing));
+      _rlhRecorderWrite(recorder, &animation_info->fg, sizeof(rlhColor8_s));
+      _rlhRecorderWrite(recorder, &animation_info->bg, sizeof(rlhColor8_s));
+    }
+  }
+
+  static inline void _rlhRecordAnimationTime(rlhRecorder_s *const recorder, const double seconds)
+  {
+    _rlhRecordTag(recorder, RLH_RECORD_ANIMATION_TIME);
+    _rlhRecorderWrite(recorder, &seconds, sizeof(seconds));
+  }
+
+  static inline void _rlhRecordMotion(rlhRecorder_s *const recorder, const int motion_x, const int motion_y)
+  {
+    uint8_t *const start = _rlhRecorderReserve(recorder, 1 + 2 * 10);
+    uint8_t *out = start;
+    *out++ = RLH_RECORD_MOTION;
+    out = _rlhWriteVarint(out, motion_x);
+    out = _rlhWriteVarint(out, motion_y);
+    _rlhRecorderCommit(recorder, (size_t)(out - start));
+  }
+
+  static inline void _rlhRecordMotionAlpha(rlhRecorder_s *const recorder, const float alpha)
+  {
+    _rlhRecordTag(recorder, RLH_RECORD_MOTION_ALPHA);
+    _rlhRecorderWrite(recorder, &alpha, sizeof(alpha));
+  }
+
+  static inline void _rlhRecordParticleCapacity(rlhRecorder_s *const recorder, const size_t capacity)
+  {
+    const uint64_t value = capacity;
+    _rlhRecordTag(recorder, RLH_RECORD_PARTICLE_CAPACITY);
+    _rlhRecorderWrite(recorder, &value, sizeof(value));
+  }
+
+  static inline void _rlhRecordParticles(rlhRecorder_s *const recorder, const rlhParticle_s *const particles,
+                                         const size_t count)
+  {
+    const uint32_t value = (uint32_t)count;
+    _rlhRecordTag(recorder, RLH_RECORD_PARTICLES);
+    _rlhRecorderWrite(recorder, &value, sizeof(value));
+    _rlhRecorderWrite(recorder, particles, count * sizeof(rlhParticle_s));
+  }
+
+  static inline void _rlhRecordParticleTime(rlhRecorder_s *const recorder, const float seconds)
+  {
+    _rlhRecordTag(recorder, RLH_RECORD_PARTICLE_TIME);
+    _rlhRecorderWrite(recorder, &seconds, sizeof(seconds));
+  }
+
+  static inline void _rlhRecordLightMap(rlhRecorder_s *const recorder, const rlhColor8_s *const light_map,
+                                        const size_t tiles_wide, const size_t tiles_tall)
+  {
+    const int32_t values[2] = {light_map != NULL ? (int32_t)tiles_wide : 0, light_map != NULL ? (int32_t)tiles_tall : 0};
+    _rlhRecordTag(recorder, RLH_RECORD_LIGHT_MAP);
+    _rlhRecorderWrite(recorder, values, sizeof(values));
+    if (light_map != NULL)
+    {
+      _rlhRecorderWrite(recorder, light_map, tiles_wide * tiles_tall * sizeof(rlhColor8_s));
+    }
+  }
+
+  static inline rlhresult_t _rlhTermStartRecording(rlhTerm_h const term, const char *const path,
+                                                   const rlhTermSizeInfo_t *const size_info,
+                                                   const rlhAtlasCreateInfo_t *const atlas_info)
+  {
+    rlhRecorder_s *recorder = (rlhRecorder_s *)RLH_MALLOC(sizeof(rlhRecorder_s), term->allocator_user_data);
+    if (recorder == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memset(recorder, 0, offsetof(rlhRecorder_s, buffer));
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL)
+    {
+      RLH_FREE(recorder, term->allocator_user_data);
+      return RLH_RESULT_ERROR_IO;
+    }
+#ifdef RLH_RETAINED_MODE
+    const uint32_t flags = RLH_RECORD_FLAG_RETAINED;
+#else
+    const uint32_t flags = 0;
+#endif
+    const uint32_t header_values[4] = {RLH_RECORD_VERSION, RLH_RECORD_BYTE_ORDER, flags, 0};
+    _rlhRecorderWrite(recorder, RLH_RECORD_MAGIC, sizeof(RLH_RECORD_MAGIC));
+    _rlhRecorderWrite(recorder, header_values, sizeof(header_values));
+    _rlhRecordSize(recorder, size_info);
+    _rlhRecordAtlas(recorder, atlas_info);
+    term->recorder = recorder;
+    return RLH_RESULT_OK;
+  }
+
+  // Send an animation to the backend with the glyph coordinates of the current atlas. An animation
+  // with glyphs that are not in the atlas shows its base glyph without cycling.
+  static inline rlhresult_t _rlhTermSendAnimation(rlhTerm_h const term, const uint16_t animation)
+  {
+    if (!term->animation_is_set[animation])
+    {
+      return term->backend->set_animation(term->backend_data, animation, NULL, NULL);
+    }
+    const rlhAnimationInfo_t *const info = &term->animations[animation];
+    const float *glyph_stpqp = NULL;
+    if (info->frame_count > 1 && (size_t)info->base_glyph + (size_t)info->frame_count <= term->glyph_count)
+    {
+      glyph_stpqp = term->glyph_stpqp + info->base_glyph * RLH_FONTMAP_COORDINATES_PER_GLYPH;
+    }
+    return term->backend->set_animation(term->backend_data, animation, info, glyph_stpqp);
+  }
+
+  // Send every animation again after the atlas changed, since they store atlas coordinates.
+  static inline rlhresult_t _rlhTermSendAnimations(rlhTerm_h const term)
+  {
+    if (!term->animations_used)
+    {
+      return RLH_RESULT_OK;
+    }
+    for (uint16_t animation = 1; animation < RLH_ANIMATION_COUNT; animation++)
+    {
+      if (term->animation_is_set[animation])
+      {
+        const rlhresult_t result = _rlhTermSendAnimation(term, animation);
+        if (result != RLH_RESULT_OK)
+        {
+          return result;
+        }
+      }
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static inline rlhresult_t _rlhTermSetAtlas(rlhTerm_h term, rlhAtlasCreateInfo_t *atlas_info)
+  {
+    const size_t stpqp_size = atlas_info->glyph_count * RLH_FONTMAP_COORDINATES_PER_GLYPH * sizeof(float);
+    float *glyph_stpqp = (float *)RLH_REALLOC(term->glyph_stpqp, stpqp_size, term->allocator_user_data);
+    if (glyph_stpqp == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    term->glyph_stpqp = glyph_stpqp;
+    RLH_PROFILE_BEGIN(rlh_create_atlas);
+    rlhresult_t result = term->backend->create_atlas(term->backend_data, atlas_info);
+    RLH_PROFILE_END(rlh_create_atlas);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    memcpy(term->glyph_stpqp, atlas_info->glyph_stpqp, stpqp_size);
+    term->glyph_count = atlas_info->glyph_count;
+    term->cache_valid = RLH_FALSE;
+    return _rlhTermSendAnimations(term);
+  }
+
+  rlhresult_t rlhTermCreate(rlhTermCreateInfo_t *term_info, rlhTerm_h *term)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    rlhresult_t result = _rlhTermInfoCheck(term_info);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    rlhTerm_h term_h = (rlhTerm_h)RLH_MALLOC(sizeof(rlhTerm_s), term_info->allocator_user_data);
+    if (term_h == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+
+    memset(term_h, 0, sizeof(rlhTerm_s));
+    term_h->allocator_user_data = term_info->allocator_user_data;
+    term_h->motion_alpha = 1.0f;
+    term_h->particle_random = 0x2545f491u;
+    const rlhBackend_t *backend = term_info->backend;
+    if (backend == NULL)
+    {
+#ifndef RLH_NO_OPENGL
+      backend = &RLH_BACKEND_GL33;
+#else
+      backend = &RLH_BACKEND_NULL;
+#endif
+    }
+    result = backend->create(backend->user_data, &term_h->backend_data);
+    if (result != RLH_RESULT_OK)
+    {
+      RLH_FREE(term_h, term_info->allocator_user_data);
+      return result;
+    }
+    term_h->backend = backend;
+    _rlhTermSetPixelSize(
+        term_h,
+        term_info->size_info);
+    if (term_info->tile_arena_size != 0)
+    {
+      // The arena is always a whole amount of tiles, any bytes left over at the end are not used.
+      term_h->vertex_data_is_arena = RLH_TRUE;
+      term_h->vertex_data_tile_capacity = term_info->tile_arena_size / _rlhGetVertexDataSize(1);
+      term_h->vertex_data = (rlhVertex_s *)term_info->tile_arena;
+    }
+    else
+    {
+      term_h->vertex_data_tile_capacity = term_h->tiles_wide * term_h->tiles_tall;
+      term_h->shrink_interval = term_info->shrink_interval;
+    }
+    if (term_h->vertex_data == NULL)
+    {
+      term_h->vertex_data_is_owned = RLH_TRUE;
+      term_h->vertex_data = (rlhVertex_s *)RLH_MALLOC(
+          _rlhGetVertexDataSize(term_h->vertex_data_tile_capacity),
+          term_h->allocator_user_data);
+    }
+    if (term_h->vertex_data == NULL)
+    {
+      rlhTermDestroy(term_h);
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    result = _rlhTermSetAtlas(term_h, term_info->atlas_info);
+    if (result != RLH_RESULT_OK)
+    {
+      rlhTermDestroy(term_h);
+      return result;
+    }
+    if (term_info->record_path != NULL)
+    {
+      result = _rlhTermStartRecording(term_h, term_info->record_path, term_info->size_info, term_info->atlas_info);
+      if (result != RLH_RESULT_OK)
+      {
+        rlhTermDestroy(term_h);
+        return result;
+      }
+    }
+    *term = term_h;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermStopRecording(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    rlhRecorder_s *const recorder = term->recorder;
+    if (recorder == NULL)
+    {
+      return RLH_RESULT_OK;
+    }
+    _rlhRecorderFlush(recorder);
+    const rlhbool_t failed = (rlhbool_t)(recorder->failed || fclose(recorder->file) != 0);
+    RLH_FREE(recorder, term->allocator_user_data);
+    term->recorder = NULL;
+    return failed ? RLH_RESULT_ERROR_IO : RLH_RESULT_OK;
+  }
+
+  void rlhTermDestroy(rlhTerm_h const term)
+  {
+    if (term == NULL)
+      return;
+    rlhTermStopRecording(term);
+    void *const allocator_user_data = term->allocator_user_data;
+    if (term->vertex_data_is_owned)
+    {
+      RLH_FREE(term->vertex_data, allocator_user_data);
+    }
+    term->vertex_data = NULL;
+    if (term->handoff_mode)
+    {
+      RLH_FREE(term->handoff_buffers[term->handoff_published & ~RLH_HANDOFF_NEW].vertex_data, allocator_user_data);
+      RLH_FREE(term->handoff_buffers[term->handoff_read].vertex_data, allocator_user_data);
+    }
+    RLH_FREE(term->glyph_stpqp, allocator_user_data);
+    term->glyph_stpqp = NULL;
+    RLH_FREE(term->atlas_upload_stpqp, allocator_user_data);
+    term->atlas_upload_stpqp = NULL;
+    RLH_FREE(term->atlas_upload_record_pixels, allocator_user_data);
+    term->atlas_upload_record_pixels = NULL;
+    RLH_FREE(term->light_map, allocator_user_data);
+    term->light_map = NULL;
+    RLH_FREE(term->visibility_mask, allocator_user_data);
+    term->visibility_mask = NULL;
+    RLH_FREE(term->particles, allocator_user_data);
+    term->particles = NULL;
+    RLH_FREE(term->pick_rects, allocator_user_data);
+    term->pick_rects = NULL;
+    RLH_FREE(term->pick_nodes, allocator_user_data);
+    term->pick_nodes = NULL;
+    RLH_FREE(term->pick_buckets, allocator_user_data);
+    term->pick_buckets = NULL;
+    for (size_t i = 0; i < RLH_TEXT_CACHE_SIZE; i++)
+    {
+      RLH_FREE(term->text_runs[i].text, allocator_user_data);
+      RLH_FREE(term->text_runs[i].tiles, allocator_user_data);
+    }
+    RLH_FREE(term->element_data, allocator_user_data);
+    term->element_data = NULL;
+    if (term->backend != NULL)
+    {
+      term->backend->destroy(term->backend_data);
+      term->backend_data = NULL;
+    }
+    RLH_FREE(term, allocator_user_data);
+  }
+
+  rlhresult_t rlhTermSetAtlas(rlhTerm_h const term, rlhAtlasCreateInfo_t *atlas_info)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    rlhresult_t result = _rlhAtlasInfoCheck(atlas_info);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    if (term->atlas_upload_state != RLH_ATLAS_UPLOAD_NONE)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    result = _rlhTermSetAtlas(term, atlas_info);
+    if (result == RLH_RESULT_OK && term->recorder != NULL)
+    {
+      _rlhRecordAtlas(term->recorder, atlas_info);
+    }
+    return result;
+  }
+
+  rlhresult_t rlhTermBeginAtlasUpload(rlhTerm_h const term, const rlhAtlasCreateInfo_t *const atlas_info, const int pages_per_draw, void **pixel_data)
+  {
+    if (term == NULL || atlas_info == NULL || atlas_info->glyph_stpqp == NULL || pixel_data == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    rlhresult_t result = _rlhAtlasLayoutCheck(atlas_info);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    // the upload would replace the glyph coordinates during a draw, while the game thread pushes with them
+    if (pages_per_draw <= 0 ||
+        term->atlas_upload_state != RLH_ATLAS_UPLOAD_NONE ||
+        term->handoff_mode ||
+        term->backend->begin_atlas_upload == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    // The glyph coordinates are only used once the new atlas is resident.
+    const size_t stpqp_size = atlas_info->glyph_count * RLH_FONTMAP_COORDINATES_PER_GLYPH * sizeof(float);
+    float *const stpqp = (float *)RLH_MALLOC(stpqp_size, term->allocator_user_data);
+    if (stpqp == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memcpy(stpqp, atlas_info->glyph_stpqp, stpqp_size);
+    if (term->recorder != NULL)
+    {
+      // The mapped memory of the backend can not be read back for the recording, so the pixels are
+      // written to memory of our own and copied to the backend when they are done.
+      term->atlas_upload_record_pixels = (uint8_t *)RLH_MALLOC((size_t)_rlhGetAtlasPixelDataSize(atlas_info), term->allocator_user_data);
+      if (term->atlas_upload_record_pixels == NULL)
+      {
+        RLH_FREE(stpqp, term->allocator_user_data);
+        return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      *pixel_data = term->atlas_upload_record_pixels;
+    }
+    else
+    {
+      result = term->backend->begin_atlas_upload(term->backend_data, atlas_info, pixel_data);
+      if (result != RLH_RESULT_OK)
+      {
+        RLH_FREE(stpqp, term->allocator_user_data);
+        return result;
+      }
+    }
+    term->atlas_upload_info = *atlas_info;
+    term->atlas_upload_info.pixel_data = term->atlas_upload_record_pixels;
+    term->atlas_upload_info.glyph_stpqp = stpqp;
+    term->atlas_upload_stpqp = stpqp;
+    term->atlas_upload_pages_per_draw = pages_per_draw;
+    term->atlas_upload_state = RLH_ATLAS_UPLOAD_WRITING;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermEndAtlasUpload(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (term->atlas_upload_state != RLH_ATLAS_UPLOAD_WRITING)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    rlhresult_t result = RLH_RESULT_OK;
+    if (term->atlas_upload_record_pixels != NULL)
+    {
+      void *pixel_data = NULL;
+      result = term->backend->begin_atlas_upload(term->backend_data, &term->atlas_upload_info, &pixel_data);
+      if (result == RLH_RESULT_OK)
+      {
+        memcpy(pixel_data, term->atlas_upload_record_pixels, (size_t)_rlhGetAtlasPixelDataSize(&term->atlas_upload_info));
+      }
+    }
+    if (result == RLH_RESULT_OK)
+    {
+      result = term->backend->end_atlas_upload(term->backend_data);
+    }
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    term->atlas_upload_state = RLH_ATLAS_UPLOAD_TRANSFERRING;
+    return RLH_RESULT_OK;
+  }
+
+  rlhatlasupload_t rlhTermGetAtlasUploadState(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return RLH_ATLAS_UPLOAD_NONE;
+    }
+    return term->atlas_upload_state;
+  }
+
+  // Copy the next pages of a pending atlas upload, and switch to the new atlas once it is resident.
+  static inline rlhresult_t _rlhTermStepAtlasUpload(rlhTerm_h const term)
+  {
+    rlhbool_t resident = RLH_FALSE;
+    RLH_PROFILE_BEGIN(rlh_step_atlas_upload);
+    rlhresult_t result = term->backend->step_atlas_upload(term->backend_data, term->atlas_upload_pages_per_draw, &resident);
+    RLH_PROFILE_END(rlh_step_atlas_upload);
+    if (result != RLH_RESULT_OK || !resident)
+    {
+      return result;
+    }
+    RLH_FREE(term->glyph_stpqp, term->allocator_user_data);
+    term->glyph_stpqp = term->atlas_upload_stpqp;
+    term->glyph_count = term->atlas_upload_info.glyph_count;
+    term->atlas_upload_stpqp = NULL;
+    if (term->recorder != NULL && term->atlas_upload_record_pixels != NULL)
+    {
+      _rlhRecordAtlas(term->recorder, &term->atlas_upload_info);
+    }
+    RLH_FREE(term->atlas_upload_record_pixels, term->allocator_user_data);
+    term->atlas_upload_record_pixels = NULL;
+    term->atlas_upload_state = RLH_ATLAS_UPLOAD_NONE;
+    term->cache_valid = RLH_FALSE;
+    return _rlhTermSendAnimations(term);
+  }
+
+  int rlhTermGetGlyphCount(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return 0;
+    }
+    return (int)term->glyph_count;
+  }
+
+  float rlhTermGetPixelScale(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return 0.0f;
+    }
+    return term->pixel_scale;
+  }
+
+  void rlhTermGetTerminalSize(rlhTerm_h const term, int *const tiles_wide, int *const tiles_tall)
+  {
+    if (term == NULL)
+    {
+      return;
+    }
+    if (tiles_wide != NULL)
+    {
+      *tiles_wide = (int)term->tiles_wide;
+    }
+    if (tiles_tall != NULL)
+    {
+      *tiles_tall = (int)term->tiles_tall;
+    }
+  }
+
+  void rlhTermGetScaledPixelSize(rlhTerm_h const term, int *const pixel_width, int *const pixel_height)
+  {
+    if (term == NULL)
+    {
+      return;
+    }
+    if (pixel_width != NULL)
+    {
+      *pixel_width = (int)term->scaled_pixel_width;
+    }
+    if (pixel_height != NULL)
+    {
+      *pixel_height = (int)term->scaled_pixel_height;
+    }
+  }
+
+  void rlhTermGetUnscaledPixelSize(rlhTerm_h const term, int *const pixel_width, int *const pixel_height)
+  {
+    if (term == NULL)
+    {
+      return;
+    }
+    if (pixel_width != NULL)
+    {
+      *pixel_width = (int)term->unscaled_pixel_width;
+    }
+    if (pixel_height != NULL)
+    {
+      *pixel_height = (int)term->unscaled_pixel_height;
+    }
+  }
+
+  void rlhTermGetTileSize(rlhTerm_h const term, int *const tile_width, int *const tile_height)
+  {
+    if (term == NULL)
+    {
+      return;
+    }
+    if (tile_width != NULL)
+    {
+      *tile_width = (int)term->tile_width;
+    }
+    if (tile_height != NULL)
+    {
+      *tile_height = (int)term->tile_height;
+    }
+  }
+
+  rlhresult_t rlhTermSetSize(rlhTerm_h const term, rlhTermSizeInfo_t *const size_info)
+  {
+    if (term == NULL || size_info == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    rlhresult_t result = _rlhSizeInfoCheck(size_info);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    const size_t tiles_wide = term->tiles_wide;
+    const size_t tiles_tall = term->tiles_tall;
+    _rlhTermSetPixelSize(
+        term,
+        size_info);
+    term->cache_valid = RLH_FALSE;
+    if (term->light_map != NULL)
+    {
+      // The cells still cover the terminal, but a light map for a different amount of tiles is useless.
+      if (term->tiles_wide != tiles_wide || term->tiles_tall != tiles_tall)
+      {
+        RLH_FREE(term->light_map, term->allocator_user_data);
+        term->light_map = NULL;
+      }
+      term->light_map_changed = RLH_TRUE;
+    }
+    if (term->tiles_wide != tiles_wide || term->tiles_tall != tiles_tall)
+    {
+      RLH_FREE(term->visibility_mask, term->allocator_user_data);
+      term->visibility_mask = NULL;
+    }
+    if (term->recorder != NULL)
+    {
+      _rlhRecordSize(term->recorder, size_info);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static inline void _rlhTermApplyShrinkPolicy(rlhTerm_h const term)
+  {
+    // the element data belongs to the drawing thread in handoff mode
+    if (term->shrink_interval == 0 || term->handoff_mode)
+      return;
+    term->vertex_data_high_water = MAX(term->vertex_data_high_water, term->vertex_data_tile_count);
+    if (++term->shrink_clear_count < term->shrink_interval)
+      return;
+    const size_t high_water = term->vertex_data_high_water;
+    term->shrink_clear_count = 0;
+    term->vertex_data_high_water = 0;
+    // Only shrink after using less than a quarter of the buffer, and keep at least twice the high
+    // water mark, so a buffer does not shrink and grow again every interval.
+    if (high_water * 4 > term->vertex_data_tile_capacity)
+      return;
+    size_t new_capacity = term->vertex_data_tile_capacity;
+    while (new_capacity / 2 >= MAX(high_water * 2, 8))
+    {
+      new_capacity /= 2;
+    }
+    if (new_capacity == term->vertex_data_tile_capacity)
+      return;
+    // If a shrinking realloc fails the old buffer is still valid, so just keep using it.
+    rlhVertex_s *new_vertex_data = (rlhVertex_s *)RLH_REALLOC(
+        term->vertex_data,
+        _rlhGetVertexDataSize(new_capacity),
+        term->allocator_user_data);
+    if (new_vertex_data == NULL)
+      return;
+    term->vertex_data = new_vertex_data;
+    term->vertex_data_tile_capacity = new_capacity;
+    if (term->element_glyph_count > new_capacity)
+    {
+      uint32_t *new_element_data = (uint32_t *)RLH_REALLOC(
+          term->element_data,
+          _rlhGetElementDataSize(new_capacity),
+          term->allocator_user_data);
+      if (new_element_data != NULL)
+      {
+        term->element_data = new_element_data;
+        term->element_glyph_count = new_capacity;
+      }
+    }
+    term->stats.vertex_data_shrinks++;
+  }
+
+  static inline void _rlhTermClearTileData(rlhTerm_h const term)
+  {
+    _rlhTermApplyShrinkPolicy(term);
+    term->vertex_data_tile_count = 0;
+    term->pick_stale = RLH_TRUE;
+  }
+
+  rlhresult_t rlhTermClearTileData(rlhTerm_h term)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (term->recorder != NULL)
+    {
+      _rlhRecordTag(term->recorder, RLH_RECORD_CLEAR);
+    }
+    _rlhTermClearTileData(term);
+    return RLH_RESULT_OK;
+  }
+
+  int rlhTermGetTileDataCount(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return 0;
+    }
+    return (int)term->vertex_data_tile_count;
+  }
+
+  static inline void _rlhTermReadGpuTimes(rlhTerm_h const term)
+  {
+    if (term->backend->read_gpu_time == NULL)
+      return;
+    uint64_t gpu_ns;
+    while (term->backend->read_gpu_time(term->backend_data, &gpu_ns))
+    {
+      term->draw_stats.gpu_ns += gpu_ns;
+      term->draw_stats.gpu_timed_draws++;
+      term->draw_stats.gpu_last_draw_ns = gpu_ns;
+    }
+  }
+
+  static inline rlhbool_t _rlhTermTryReserveVertexData(rlhTerm_h const term, const size_t tile_count)
+  {
+    // If we hit the reserved tile count, double the amount of reserved space until it fits.
+    if (tile_count <= term->vertex_data_tile_capacity - term->vertex_data_tile_count)
+      return RLH_TRUE;
+    // A tile arena never grows.
+    if (term->vertex_data_is_arena)
+      return RLH_FALSE;
+    size_t new_capacity = (term->vertex_data_tile_capacity == 0) ? 8 : term->vertex_data_tile_capacity * 2;
+    while (new_capacity - term->vertex_data_tile_count < tile_count)
+    {
+      new_capacity *= 2;
+    }
+    RLH_PROFILE_BEGIN(rlh_reserve);
+    rlhVertex_s *new_vertex_data = (rlhVertex_s *)RLH_REALLOC(
+        term->vertex_data,
+        _rlhGetVertexDataSize(new_capacity),
+        term->allocator_user_data);
+    RLH_PROFILE_END(rlh_reserve);
+    if (new_vertex_data == NULL)
+    {
+      return RLH_FALSE; // out of memory
+    }
+    term->vertex_data = new_vertex_data;
+    term->vertex_data_tile_capacity = new_capacity;
+    term->stats.vertex_data_reallocations++;
+    return RLH_TRUE;
+  }
+
+  rlhresult_t rlhTermSetHandoffMode(rlhTerm_h const term, const rlhbool_t enabled)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (enabled == term->handoff_mode)
+    {
+      return RLH_RESULT_OK;
+    }
+    if (!enabled)
+    {
+      // keep pushing to the write buffer, and let go of the other two
+      RLH_FREE(term->handoff_buffers[term->handoff_published & ~RLH_HANDOFF_NEW].vertex_data, term->allocator_user_data);
+      RLH_FREE(term->handoff_buffers[term->handoff_read].vertex_data, term->allocator_user_data);
+      memset(term->handoff_buffers, 0, sizeof(term->handoff_buffers));
+      term->handoff_mode = RLH_FALSE;
+      term->vertex_data_changed = RLH_TRUE;
+      return RLH_RESULT_OK;
+    }
+    if (term->vertex_data_is_arena || term->recorder != NULL || term->atlas_upload_state != RLH_ATLAS_UPLOAD_NONE)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    const size_t tile_capacity = MAX(term->vertex_data_tile_capacity, 8);
+    rlhHandoffBuffer_s buffers[RLH_HANDOFF_BUFFER_COUNT];
+    memset(buffers, 0, sizeof(buffers));
+    for (size_t i = 1; i < RLH_HANDOFF_BUFFER_COUNT; i++)
+    {
+      buffers[i].vertex_data = (rlhVertex_s *)RLH_MALLOC(_rlhGetVertexDataSize(tile_capacity), term->allocator_user_data);
+      buffers[i].tile_capacity = tile_capacity;
+      if (buffers[i].vertex_data == NULL)
+      {
+        RLH_FREE(buffers[1].vertex_data, term->allocator_user_data);
+        return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+    }
+    memcpy(term->handoff_buffers, buffers, sizeof(buffers));
+    term->handoff_write = 0;
+    term->handoff_published = 1;
+    term->handoff_read = 2;
+    term->handoff_frame_changed = RLH_TRUE;
+    term->draw_stats_sequence = 0;
+    term->handoff_draw_stats = term->draw_stats;
+    term->handoff_draw_stats_sequence = 0;
+    term->handoff_mode = RLH_TRUE;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermPublishFrame(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (!term->handoff_mode)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    rlhHandoffBuffer_s *const published = &term->handoff_buffers[term->handoff_write];
+    published->vertex_data = term->vertex_data;
+    published->tile_count = term->vertex_data_tile_count;
+    published->tile_capacity = term->vertex_data_tile_capacity;
+    // The buffer that was published before comes back, whether it was drawn or not.
+    const long write = RLH_ATOMIC_EXCHANGE(&term->handoff_published, term->handoff_write | RLH_HANDOFF_NEW) & ~RLH_HANDOFF_NEW;
+    term->handoff_write = write;
+    // a buffer that comes back without being drawn has older draw counters than the ones we have
+    if (term->handoff_buffers[write].draw_stats_sequence > term->handoff_draw_stats_sequence)
+    {
+      term->handoff_draw_stats = term->handoff_buffers[write].draw_stats;
+      term->handoff_draw_stats_sequence = term->handoff_buffers[write].draw_stats_sequence;
+    }
+    term->vertex_data = term->handoff_buffers[write].vertex_data;
+    term->vertex_data_tile_capacity = term->handoff_buffers[write].tile_capacity;
+    term->vertex_data_tile_count = 0;
+#ifdef RLH_RETAINED_MODE
+    // the drawing thread only reads the published tiles, so they can be copied while it draws them
+    if (!_rlhTermTryReserveVertexData(term, published->tile_count))
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memcpy(term->vertex_data, published->vertex_data, _rlhGetVertexDataSize(published->tile_count));
+    term->vertex_data_tile_count = published->tile_count;
+#else
+    term->pick_stale = RLH_TRUE;
+#endif
+    return RLH_RESULT_OK;
+  }
+
+  // Take the latest published frame for drawing, if there is one that was not drawn yet.
+  static inline void _rlhTermAcquireFrame(rlhTerm_h const term)
+  {
+    if ((RLH_ATOMIC_LOAD(&term->handoff_published) & RLH_HANDOFF_NEW) == 0)
+      return;
+    // the draw counters go back to the pushing thread with the buffer that was drawn
+    rlhHandoffBuffer_s *const drawn = &term->handoff_buffers[term->handoff_read];
+    drawn->draw_stats = term->draw_stats;
+    drawn->draw_stats_sequence = ++term->draw_stats_sequence;
+    term->handoff_read = RLH_ATOMIC_EXCHANGE(&term->handoff_published, term->handoff_read) & ~RLH_HANDOFF_NEW;
+    term->handoff_frame_changed = RLH_TRUE;
+  }
+
+  static inline uint8_t _rlhPackColorChannel(const float channel)
+  {
+    if (!(channel > 0.0f))
+      return 0;
+    if (channel >= 1.0f)
+      return 255;
+    return (uint8_t)(channel * 255.0f + 0.5f);
+  }
+
+  rlhColor8_s rlhColorToColor8(const rlhColor_s color)
+  {
+    rlhColor8_s color8;
+    color8.r = _rlhPackColorChannel(color.r);
+    color8.g = _rlhPackColorChannel(color.g);
+    color8.b = _rlhPackColorChannel(color.b);
+    color8.a = _rlhPackColorChannel(color.a);
+    return color8;
+  }
+
+  rlhresult_t rlhTermSetPaletteMode(rlhTerm_h const term, const rlhbool_t enabled)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (enabled && term->backend->set_palette == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (term->palette_mode != enabled)
+    {
+      term->palette_mode = enabled;
+      term->palette_changed = RLH_TRUE;
+    }
+    if (term->recorder != NULL)
+    {
+      _rlhRecordPalette(term->recorder, term->palette_mode, term->palette);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetPalette(rlhTerm_h const term, const size_t first_index, const size_t color_count, const rlhColor8_s *const colors)
+  {
+    if (term == NULL || colors == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (first_index > RLH_PALETTE_SIZE || color_count > RLH_PALETTE_SIZE - first_index)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    memcpy(term->palette + first_index, colors, color_count * sizeof(rlhColor8_s));
+    term->palette_changed = RLH_TRUE;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordPalette(term->recorder, term->palette_mode, term->palette);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetAnimation(rlhTerm_h const term, const uint16_t animation, const rlhAnimationInfo_t *const animation_info)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (animation == RLH_NO_ANIMATION || animation >= RLH_ANIMATION_COUNT ||
+        term->backend->set_animation == NULL || term->backend->set_animation_time == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (animation_info != NULL &&
+        (animation_info->base_glyph >= term->glyph_count ||
+         animation_info->frame_count < 0 ||
+         animation_info->frame_count > RLH_ANIMATION_MAX_FRAMES ||
+         animation_info->color_period < 0.0f ||
+         (animation_info->frame_count > 1 &&
+          ((size_t)animation_info->base_glyph + (size_t)animation_info->frame_count > term->glyph_count ||
+           animation_info->frame_duration <= 0.0f))))
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    term->animation_is_set[animation] = (rlhbool_t)(animation_info != NULL);
+    if (animation_info != NULL)
+    {
+      term->animations[animation] = *animation_info;
+    }
+    else
+    {
+      memset(&term->animations[animation], 0, sizeof(rlhAnimationInfo_t));
+    }
+    term->animations_used = RLH_TRUE;
+    term->cache_valid = RLH_FALSE;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordAnimation(term->recorder, animation, animation_info);
+    }
+    return _rlhTermSendAnimation(term, animation);
+  }
+
+  rlhresult_t rlhTermSetAnimationTime(rlhTerm_h const term, const double seconds)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    term->animation_time = seconds;
+    term->animation_time_changed = RLH_TRUE;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordAnimationTime(term->recorder, seconds);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetLightMap(rlhTerm_h const term, const rlhColor8_s *const light_map)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    const size_t cell_count = term->tiles_wide * term->tiles_tall;
+    if (cell_count == 0 || term->backend->set_light_map == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (light_map == NULL)
+    {
+      RLH_FREE(term->light_map, term->allocator_user_data);
+      term->light_map = NULL;
+    }
+    else
+    {
+      if (term->light_map == NULL)
+      {
+        term->light_map = (rlhColor8_s *)RLH_MALLOC(cell_count * sizeof(rlhColor8_s), term->allocator_user_data);
+        if (term->light_map == NULL)
+        {
+          return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+        }
+      }
+      memcpy(term->light_map, light_map, cell_count * sizeof(rlhColor8_s));
+    }
+    term->light_map_changed = RLH_TRUE;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordLightMap(term->recorder, term->light_map, term->tiles_wide, term->tiles_tall);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetCacheMode(rlhTerm_h const term, const rlhbool_t enabled)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (enabled && term->backend->draw_cached == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    term->cache_mode = enabled;
+    term->cache_valid = RLH_FALSE;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetLowResMode(rlhTerm_h const term, const rlhbool_t enabled)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (enabled && term->backend->draw_cached == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    term->low_res_mode = enabled;
+    // the image is a different size now
+    term->cache_valid = RLH_FALSE;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetVisibilityMask(rlhTerm_h const term, const uint8_t *const mask)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    const size_t mask_size = RLH_VISIBILITY_MASK_SIZE(term->tiles_wide, term->tiles_tall);
+    if (mask_size == 0)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (mask == NULL)
+    {
+      RLH_FREE(term->visibility_mask, term->allocator_user_data);
+      term->visibility_mask = NULL;
+      return RLH_RESULT_OK;
+    }
+    if (term->visibility_mask == NULL)
+    {
+      term->visibility_mask = (uint8_t *)RLH_MALLOC(mask_size, term->allocator_user_data);
+      if (term->visibility_mask == NULL)
+      {
+        return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+    }
+    memcpy(term->visibility_mask, mask, mask_size);
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetCellVisible(rlhTerm_h const term, const int grid_x, const int grid_y, const rlhbool_t visible)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if ((size_t)grid_x >= term->tiles_wide || (size_t)grid_y >= term->tiles_tall)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (term->visibility_mask == NULL)
+    {
+      const size_t mask_size = RLH_VISIBILITY_MASK_SIZE(term->tiles_wide, term->tiles_tall);
+      term->visibility_mask = (uint8_t *)RLH_MALLOC(mask_size, term->allocator_user_data);
+      if (term->visibility_mask == NULL)
+      {
+        return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      memset(term->visibility_mask, 0xff, mask_size);
+    }
+    const size_t cell = (size_t)grid_y * term->tiles_wide + (size_t)grid_x;
+    if (visible)
+    {
+      term->visibility_mask[cell >> 3] |= (uint8_t)(1u << (cell & 7));
+    }
+    else
+    {
+      term->visibility_mask[cell >> 3] &= (uint8_t)~(1u << (cell & 7));
+    }
+    return RLH_RESULT_OK;
+  }
+
+  // Check if a grid cell is hidden by the visibility mask. Cells outside of the grid are never hidden,
+  // so they are culled like any other tile.
+  static inline rlhbool_t _rlhIsCellMasked(const uint8_t *const mask, const size_t tiles_wide, const size_t tiles_tall,
+                                           const int grid_x, const int grid_y)
+  {
+    if ((size_t)grid_x >= tiles_wide || (size_t)grid_y >= tiles_tall)
+    {
+      return RLH_FALSE;
+    }
+    const size_t cell = (size_t)grid_y * tiles_wide + (size_t)grid_x;
+    return (rlhbool_t)(((mask[cell >> 3] >> (cell & 7)) & 1) == 0);
+  }
+
+  // Skip a grid push if its cell is hidden, before it is recorded or turned into vertices.
+  static inline rlhbool_t _rlhTermRejectMaskedCell(rlhTerm_h const term, const int grid_x, const int grid_y)
+  {
+    if (term->visibility_mask == NULL ||
+        !_rlhIsCellMasked(term->visibility_mask, term->tiles_wide, term->tiles_tall, grid_x, grid_y))
+    {
+      return RLH_FALSE;
+    }
+    term->stats.tiles_masked++;
+    return RLH_TRUE;
+  }
+
+  static inline void _rlhSetVertex(rlhVertex_s *const vertex, const float x, const float y,
+                                   const float s, const float t, const uint16_t page,
+                                   const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg,
+                                   const int16_t motion_x, const int16_t motion_y)
+  {
+    vertex->x = x;
+    vertex->y = y;
+    vertex->s = s;
+    vertex->t = t;
+    vertex->page = page;
+    vertex->animation = animation;
+    vertex->fg = fg;
+    vertex->bg = bg;
+    vertex->motion_x = motion_x;
+    vertex->motion_y = motion_y;
+  }
+
+  // Start the pick index over, with buckets the size of a tile that cover the terminal.
+  static inline void _rlhTermResetPicks(rlhTerm_h const term)
+  {
+    term->pick_stale = RLH_FALSE;
+    term->pick_failed = RLH_FALSE;
+    term->pick_rect_count = 0;
+    term->pick_node_count = 0;
+    term->pick_large = 0;
+    const int bucket_width = MAX((int)term->tile_width, 1);
+    const int bucket_height = MAX((int)term->tile_height, 1);
+    const int buckets_wide = MAX(((int)term->unscaled_pixel_width + bucket_width - 1) / bucket_width, 1);
+    const int buckets_tall = MAX(((int)term->unscaled_pixel_height + bucket_height - 1) / bucket_height, 1);
+    if (term->pick_buckets == NULL || buckets_wide != term->pick_buckets_wide || buckets_tall != term->pick_buckets_tall)
+    {
+      uint32_t *const buckets = (uint32_t *)RLH_REALLOC(
+          term->pick_buckets, (size_t)buckets_wide * buckets_tall * sizeof(uint32_t), term->allocator_user_data);
+      if (buckets == NULL)
+      {
+        term->pick_failed = RLH_TRUE;
+        return;
+      }
+      term->pick_buckets = buckets;
+      term->pick_buckets_wide = buckets_wide;
+      term->pick_buckets_tall = buckets_tall;
+    }
+    term->pick_bucket_width = bucket_width;
+    term->pick_bucket_height = bucket_height;
+    memset(term->pick_buckets, 0, (size_t)buckets_wide * buckets_tall * sizeof(uint32_t));
+  }
+
+  static inline rlhbool_t _rlhTermTryReservePickNodes(rlhTerm_h const term, const size_t count)
+  {
+    if (term->pick_node_count + count <= term->pick_node_capacity)
+    {
+      return RLH_TRUE;
+    }
+    const size_t new_capacity = MAX(term->pick_node_capacity * 2, term->pick_node_count + count);
+    rlhPickNode_s *const nodes = (rlhPickNode_s *)RLH_REALLOC(
+        term->pick_nodes, new_capacity * sizeof(rlhPickNode_s), term->allocator_user_data);
+    if (nodes == NULL)
+    {
+      return RLH_FALSE;
+    }
+    term->pick_nodes = nodes;
+    term->pick_node_capacity = new_capacity;
+    return RLH_TRUE;
+  }
+
+  // Put a tile that is about to be pushed in the pick index. If this runs out of memory, picking
+  // fails until the index starts over.
+  static inline void _rlhTermIndexPick(rlhTerm_h const term, const int pixel_x, const int pixel_y,
+                                       const int pixel_w, const int pixel_h)
+  {
+    if (term->pick_stale)
+    {
+      _rlhTermResetPicks(term);
+    }
+    if (term->pick_failed || pixel_w <= 0 || pixel_h <= 0)
+    {
+      return;
+    }
+    if (term->pick_rect_count == term->pick_rect_capacity)
+    {
+      const size_t new_capacity = MAX(term->pick_rect_capacity * 2, 64);
+      rlhPickRect_s *const rects = (rlhPickRect_s *)RLH_REALLOC(
+          term->pick_rects, new_capacity * sizeof(rlhPickRect_s), term->allocator_user_data);
+      if (rects == NULL)
+      {
+        term->pick_failed = RLH_TRUE;
+        return;
+      }
+      term->pick_rects = rects;
+      term->pick_rect_capacity = new_capacity;
+    }
+    const uint32_t rect = (uint32_t)term->pick_rect_count++;
+    rlhPickRect_s *const pick_rect = &term->pick_rects[rect];
+    pick_rect->x = pixel_x;
+    pick_rect->y = pixel_y;
+    pick_rect->width = pixel_w;
+    pick_rect->height = pixel_h;
+    pick_rect->tile_index = (uint32_t)term->vertex_data_tile_count;
+    pick_rect->tag = term->pick_tag;
+    // Tiles past the edges of the terminal go in the buckets along the edges.
+    const int bucket_left = MIN(MAX(pixel_x / term->pick_bucket_width, 0), term->pick_buckets_wide - 1);
+    const int bucket_right = MIN(MAX((pixel_x + pixel_w - 1) / term->pick_bucket_width, 0), term->pick_buckets_wide - 1);
+    const int bucket_top = MIN(MAX(pixel_y / term->pick_bucket_height, 0), term->pick_buckets_tall - 1);
+    const int bucket_bottom = MIN(MAX((pixel_y + pixel_h - 1) / term->pick_bucket_height, 0), term->pick_buckets_tall - 1);
+    const int bucket_count = (bucket_right - bucket_left + 1) * (bucket_bottom - bucket_top + 1);
+    if (!_rlhTermTryReservePickNodes(term, bucket_count > RLH_PICK_MAX_BUCKETS ? 1 : (size_t)bucket_count))
+    {
+      term->pick_failed = RLH_TRUE;
+      return;
+    }
+    if (bucket_count > RLH_PICK_MAX_BUCKETS)
+    {
+      rlhPickNode_s *const node = &term->pick_nodes[term->pick_node_count++];
+      node->rect = rect;
+      node->next = term->pick_large;
+      term->pick_large = (uint32_t)term->pick_node_count;
+      return;
+    }
+    for (int bucket_y = bucket_top; bucket_y <= bucket_bottom; bucket_y++)
+    {
+      for (int bucket_x = bucket_left; bucket_x <= bucket_right; bucket_x++)
+      {
+        uint32_t *const bucket = &term->pick_buckets[bucket_y * term->pick_buckets_wide + bucket_x];
+        rlhPickNode_s *const node = &term->pick_nodes[term->pick_node_count++];
+        node->rect = rect;
+        node->next = *bucket;
+        *bucket = (uint32_t)term->pick_node_count;
+      }
+    }
+  }
+
+  // Push a tile that moved by motion_x and motion_y pixels since its previous position. It is only
+  // culled if it is outside of the terminal at both positions.
+  static inline void _rlhTermPushMovingTile(rlhTerm_h const term, const int pixel_x, const int pixel_y,
+                                            const int pixel_w, const int pixel_h, const uint16_t glyph,
+                                            const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg,
+                                            const int16_t motion_x, const int16_t motion_y)
+  {
+    if (glyph >= term->glyph_count)
+    {
+      term->stats.tiles_culled++;
+      return;
+    }
+    const int min_x = motion_x > 0 ? pixel_x - motion_x : pixel_x;
+    const int min_y = motion_y > 0 ? pixel_y - motion_y : pixel_y;
+    const int max_x = (motion_x < 0 ? pixel_x - motion_x : pixel_x) + pixel_w;
+    const int max_y = (motion_y < 0 ? pixel_y - motion_y : pixel_y) + pixel_h;
+    if (!(
+            max_x > 0 &&
+            min_x < (int)term->unscaled_pixel_width &&
+            max_y > 0 &&
+            min_y < (int)term->unscaled_pixel_height))
+    {
+      term->stats.tiles_culled++;
+      return;
+    }
     float position_s = (float)pixel_x / (float)term->unscaled_pixel_width;
     float position_t = position_s + ((float)pixel_w / (float)term->unscaled_pixel_width);
     float position_p = (float)pixel_y / (float)term->unscaled_pixel_height;
@@ -1112,124 +5050,1296 @@ extern "C"
     const float atlas_t = term->glyph_stpqp[glyph_stpqp_i++];
     const float atlas_p = term->glyph_stpqp[glyph_stpqp_i++];
     const float atlas_q = term->glyph_stpqp[glyph_stpqp_i++];
-    const float atlas_page = term->glyph_stpqp[glyph_stpqp_i];
-    size_t index = _rlhGetVertexAttributeCount(term->vertex_data_tile_count);
-    // v0
-    term->vertex_data[index++] = position_s;
-    term->vertex_data[index++] = position_p;
-    term->vertex_data[index++] = atlas_s;
-    term->vertex_data[index++] = atlas_p;
-    term->vertex_data[index++] = atlas_page;
-    term->vertex_data[index++] = fg.r;
-    term->vertex_data[index++] = fg.g;
-    term->vertex_data[index++] = fg.b;
-    term->vertex_data[index++] = fg.a;
-    term->vertex_data[index++] = bg.r;
-    term->vertex_data[index++] = bg.g;
-    term->vertex_data[index++] = bg.b;
-    term->vertex_data[index++] = bg.a;
-    // v1
-    term->vertex_data[index++] = position_t;
-    term->vertex_data[index++] = position_p;
-    term->vertex_data[index++] = atlas_t;
-    term->vertex_data[index++] = atlas_p;
-    term->vertex_data[index++] = atlas_page;
-    term->vertex_data[index++] = fg.r;
-    term->vertex_data[index++] = fg.g;
-    term->vertex_data[index++] = fg.b;
-    term->vertex_data[index++] = fg.a;
-    term->vertex_data[index++] = bg.r;
-    term->vertex_data[index++] = bg.g;
-    term->vertex_data[index++] = bg.b;
-    term->vertex_data[index++] = bg.a;
-    // v2
-    term->vertex_data[index++] = position_s;
-    term->vertex_data[index++] = position_q;
-    term->vertex_data[index++] = atlas_s;
-    term->vertex_data[index++] = atlas_q;
-    term->vertex_data[index++] = atlas_page;
-    term->vertex_data[index++] = fg.r;
-    term->vertex_data[index++] = fg.g;
-    term->vertex_data[index++] = fg.b;
-    term->vertex_data[index++] = fg.a;
-    term->vertex_data[index++] = bg.r;
-    term->vertex_data[index++] = bg.g;
-    term->vertex_data[index++] = bg.b;
-    term->vertex_data[index++] = bg.a;
-    // v3
-    term->vertex_data[index++] = position_t;
-    term->vertex_data[index++] = position_q;
-    term->vertex_data[index++] = atlas_t;
-    term->vertex_data[index++] = atlas_q;
-    term->vertex_data[index++] = atlas_page;
-    term->vertex_data[index++] = fg.r;
-    term->vertex_data[index++] = fg.g;
-    term->vertex_data[index++] = fg.b;
-    term->vertex_data[index++] = fg.a;
-    term->vertex_data[index++] = bg.r;
-    term->vertex_data[index++] = bg.g;
-    term->vertex_data[index++] = bg.b;
-    term->vertex_data[index] = bg.a;
+    const uint16_t atlas_page = (uint16_t)term->glyph_stpqp[glyph_stpqp_i];
+    if (term->pick_mode)
+    {
+      _rlhTermIndexPick(term, pixel_x, pixel_y, pixel_w, pixel_h);
+    }
+    rlhVertex_s *const vertices = term->vertex_data + term->vertex_data_tile_count * RLH_VERTICES_PER_TILE;
+    if (animation & RLH_ANIMATION_REPEAT)
+    {
+      // The shader looks up the glyph by the index in s, and repeats it over the grid cells.
+      const float glyph_index = (float)glyph;
+      _rlhSetVertex(&vertices[0], position_s, position_p, glyph_index, 0.0f, atlas_page, animation, fg, bg, motion_x, motion_y);
+      _rlhSetVertex(&vertices[1], position_t, position_p, glyph_index, 0.0f, atlas_page, animation, fg, bg, motion_x, motion_y);
+      _rlhSetVertex(&vertices[2], position_s, position_q, glyph_index, 0.0f, atlas_page, animation, fg, bg, motion_x, motion_y);
+      _rlhSetVertex(&vertices[3], position_t, position_q, glyph_index, 0.0f, atlas_page, animation, fg, bg, motion_x, motion_y);
+    }
+    else
+    {
+      _rlhSetVertex(&vertices[0], position_s, position_p, atlas_s, atlas_p, atlas_page, animation, fg, bg, motion_x, motion_y);
+      _rlhSetVertex(&vertices[1], position_t, position_p, atlas_t, atlas_p, atlas_page, animation, fg, bg, motion_x, motion_y);
+      _rlhSetVertex(&vertices[2], position_s, position_q, atlas_s, atlas_q, atlas_page, animation, fg, bg, motion_x, motion_y);
+      _rlhSetVertex(&vertices[3], position_t, position_q, atlas_t, atlas_q, atlas_page, animation, fg, bg, motion_x, motion_y);
+    }
     term->vertex_data_tile_count++;
     term->vertex_data_changed = RLH_TRUE;
+    term->stats.tiles_pushed++;
+  }
+
+  static inline void _rlhTermPushTile(rlhTerm_h const term, const int pixel_x, const int pixel_y,
+                                      const int pixel_w, const int pixel_h, const uint16_t glyph,
+                                      const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    _rlhTermPushMovingTile(term, pixel_x, pixel_y, pixel_w, pixel_h, glyph, animation, fg, bg, 0, 0);
+  }
+
+  static inline rlhresult_t _rlhTermPushMoving(rlhTerm_h const term, const int pixel_x, const int pixel_y,
+                                               const int pixel_w, const int pixel_h, const uint16_t glyph,
+                                               const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg,
+                                               const int16_t motion_x, const int16_t motion_y)
+  {
+    RLH_PROFILE_BEGIN(rlh_push);
+#ifdef RLH_STATS_TIMERS
+    const uint64_t start_ns = _rlhNowNs();
+#endif
+    if (term->recorder != NULL)
+    {
+      if (motion_x != 0 || motion_y != 0)
+      {
+        _rlhRecordMotion(term->recorder, motion_x, motion_y);
+      }
+      _rlhRecordPush(term->recorder, pixel_x, pixel_y, pixel_w, pixel_h, glyph, animation, fg, bg);
+    }
+    rlhresult_t result = RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    if (_rlhTermTryReserveVertexData(term, 1))
+    {
+      _rlhTermPushMovingTile(term, pixel_x, pixel_y, pixel_w, pixel_h, glyph, animation, fg, bg, motion_x, motion_y);
+      result = RLH_RESULT_OK;
+    }
+#ifdef RLH_STATS_TIMERS
+    term->stats.push_cpu_ns += _rlhNowNs() - start_ns;
+#endif
+    RLH_PROFILE_END(rlh_push);
+    return result;
+  }
+
+  static inline rlhresult_t _rlhTermPush(rlhTerm_h const term, const int pixel_x, const int pixel_y,
+                                         const int pixel_w, const int pixel_h, const uint16_t glyph,
+                                         const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    return _rlhTermPushMoving(term, pixel_x, pixel_y, pixel_w, pixel_h, glyph, animation, fg, bg, 0, 0);
+  }
+
+  rlhresult_t rlhTermPushFill(rlhTerm_h const term, const uint16_t glyph, const rlhColor_s fg,
+                              const rlhColor_s bg)
+  {
+    return rlhTermPushFill8(term, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+  }
+
+  rlhresult_t rlhTermPushGrid(rlhTerm_h const term, const int grid_x, const int grid_y,
+                              const uint16_t glyph, const rlhColor_s fg,
+                              const rlhColor_s bg)
+  {
+    return rlhTermPushGrid8(term, grid_x, grid_y, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+  }
+
+  rlhresult_t rlhTermPushGridSized(rlhTerm_h const term, const int grid_x, const int grid_y,
+                                   const int tile_pixel_width, const int tile_pixel_height,
+                                   const uint16_t glyph, const rlhColor_s fg,
+                                   const rlhColor_s bg)
+  {
+    return rlhTermPushGridSized8(term, grid_x, grid_y, tile_pixel_width, tile_pixel_height, glyph,
+                                 rlhColorToColor8(fg), rlhColorToColor8(bg));
+  }
+
+  rlhresult_t rlhTermPushFree(rlhTerm_h const term, const int screen_pixel_x,
+                              const int screen_pixel_y, const uint16_t glyph,
+                              const rlhColor_s fg, const rlhColor_s bg)
+  {
+    return rlhTermPushFree8(term, screen_pixel_x, screen_pixel_y, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+  }
+
+  rlhresult_t rlhTermPushFreeSized(rlhTerm_h const term, const int screen_pixel_x,
+                                   const int screen_pixel_y, const int tile_pixel_width,
+                                   const int tile_pixel_height, const uint16_t glyph,
+                                   const rlhColor_s fg, const rlhColor_s bg)
+  {
+    return rlhTermPushFreeSized8(term, screen_pixel_x, screen_pixel_y, tile_pixel_width, tile_pixel_height, glyph,
+                                 rlhColorToColor8(fg), rlhColorToColor8(bg));
+  }
+
+  rlhresult_t rlhTermPushFill8(rlhTerm_h const term, const uint16_t glyph, const rlhColor8_s fg,
+                               const rlhColor8_s bg)
+  {
+    return _rlhTermPush(term, 0, 0, term->unscaled_pixel_width, term->unscaled_pixel_height, glyph, RLH_NO_ANIMATION, fg, bg);
+  }
+
+  rlhresult_t rlhTermPushGrid8(rlhTerm_h const term, const int grid_x, const int grid_y,
+                               const uint16_t glyph, const rlhColor8_s fg,
+                               const rlhColor8_s bg)
+  {
+    if (_rlhTermRejectMaskedCell(term, grid_x, grid_y))
+    {
+      return RLH_RESULT_OK;
+    }
+    const int pixel_x = grid_x * term->tile_width;
+    const int pixel_y = grid_y * term->tile_height;
+    return _rlhTermPush(term, pixel_x, pixel_y, term->tile_width, term->tile_height, glyph, RLH_NO_ANIMATION, fg, bg);
+  }
+
+  rlhresult_t rlhTermPushGridSized8(rlhTerm_h const term, const int grid_x, const int grid_y,
+                                    const int tile_pixel_width, const int tile_pixel_height,
+                                    const uint16_t glyph, const rlhColor8_s fg,
+                                    const rlhColor8_s bg)
+  {
+    if (_rlhTermRejectMaskedCell(term, grid_x, grid_y))
+    {
+      return RLH_RESULT_OK;
+    }
+    const int pixel_x = grid_x * term->tile_width;
+    const int pixel_y = grid_y * term->tile_height;
+    return _rlhTermPush(term, pixel_x, pixel_y, tile_pixel_width, tile_pixel_height, glyph, RLH_NO_ANIMATION, fg, bg);
+  }
+
+  rlhresult_t rlhTermPushFree8(rlhTerm_h const term, const int screen_pixel_x,
+                               const int screen_pixel_y, const uint16_t glyph,
+                               const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    return _rlhTermPush(term, screen_pixel_x, screen_pixel_y, term->tile_width, term->tile_height, glyph, RLH_NO_ANIMATION, fg, bg);
+  }
+
+  rlhresult_t rlhTermPushFreeSized8(rlhTerm_h const term, const int screen_pixel_x,
+                                    const int screen_pixel_y, const int tile_pixel_width,
+                                    const int tile_pixel_height, const uint16_t glyph,
+                                    const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    return _rlhTermPush(term, screen_pixel_x, screen_pixel_y, tile_pixel_width, tile_pixel_height, glyph, RLH_NO_ANIMATION, fg, bg);
+  }
+
+  rlhresult_t rlhTermPushRect(rlhTerm_h const term, const int grid_x, const int grid_y,
+                              const int grid_width, const int grid_height, const uint16_t glyph,
+                              const rlhColor_s fg, const rlhColor_s bg)
+  {
+    return rlhTermPushRect8(term, grid_x, grid_y, grid_width, grid_height, glyph, rlhColorToColor8(fg), rlhColorToColor8(bg));
+  }
+
+  // Check if any grid cell of a rect is hidden by the visibility mask.
+  static inline rlhbool_t _rlhTermIsRectMasked(rlhTerm_h const term, const int grid_x, const int grid_y,
+                                               const int grid_width, const int grid_height)
+  {
+    if (term->visibility_mask == NULL)
+    {
+      return RLH_FALSE;
+    }
+    for (int y = grid_y; y < grid_y + grid_height; y++)
+    {
+      for (int x = grid_x; x < grid_x + grid_width; x++)
+      {
+        if (_rlhIsCellMasked(term->visibility_mask, term->tiles_wide, term->tiles_tall, x, y))
+        {
+          return RLH_TRUE;
+        }
+      }
+    }
+    return RLH_FALSE;
+  }
+
+  rlhresult_t rlhTermPushRect8(rlhTerm_h const term, const int grid_x, const int grid_y,
+                               const int grid_width, const int grid_height, const uint16_t glyph,
+                               const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (grid_width <= 0 || grid_height <= 0)
+    {
+      return RLH_RESULT_OK;
+    }
+    if ((grid_width == 1 && grid_height == 1) ||
+        term->backend->set_cells == NULL ||
+        _rlhTermIsRectMasked(term, grid_x, grid_y, grid_width, grid_height))
+    {
+      // push every cell on its own, which skips the hidden ones
+      rlhresult_t result = RLH_RESULT_OK;
+      for (int y = grid_y; y < grid_y + grid_height && result == RLH_RESULT_OK; y++)
+      {
+        for (int x = grid_x; x < grid_x + grid_width && result == RLH_RESULT_OK; x++)
+        {
+          result = rlhTermPushGrid8(term, x, y, glyph, fg, bg);
+        }
+      }
+      return result;
+    }
+    const int pixel_x = grid_x * term->tile_width;
+    const int pixel_y = grid_y * term->tile_height;
+    return _rlhTermPush(term, pixel_x, pixel_y, grid_width * term->tile_width, grid_height * term->tile_height,
+                        glyph, RLH_ANIMATION_REPEAT, fg, bg);
+  }
+
+  rlhresult_t rlhTermSetMotionAlpha(rlhTerm_h const term, const float alpha)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (term->backend->set_motion == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    term->motion_alpha = alpha;
+    term->motion_changed = RLH_TRUE;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordMotionAlpha(term->recorder, alpha);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermPushGridMoving8(rlhTerm_h const term, const int from_grid_x, const int from_grid_y,
+                                     const int grid_x, const int grid_y, const uint16_t glyph,
+                                     const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (_rlhTermRejectMaskedCell(term, grid_x, grid_y))
+    {
+      return RLH_RESULT_OK;
+    }
+    const int tile_width = (int)term->tile_width;
+    const int tile_height = (int)term->tile_height;
+    return rlhTermPushFreeMoving8(term, from_grid_x * tile_width, from_grid_y * tile_height,
+                                  grid_x * tile_width, grid_y * tile_height, glyph, fg, bg);
+  }
+
+  rlhresult_t rlhTermPushFreeMoving8(rlhTerm_h const term, const int from_pixel_x, const int from_pixel_y,
+                                     const int screen_pixel_x, const int screen_pixel_y, const rlhglyph_t glyph,
+                                     const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    const int64_t motion_x = (int64_t)screen_pixel_x - from_pixel_x;
+    const int64_t motion_y = (int64_t)screen_pixel_y - from_pixel_y;
+    if (term->backend->set_motion == NULL ||
+        motion_x < -INT16_MAX || motion_x > INT16_MAX || motion_y < -INT16_MAX || motion_y > INT16_MAX)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    term->motions_used = RLH_TRUE;
+    return _rlhTermPushMoving(term, screen_pixel_x, screen_pixel_y, term->tile_width, term->tile_height,
+                              glyph, RLH_NO_ANIMATION, fg, bg, (int16_t)motion_x, (int16_t)motion_y);
+  }
+
+  rlhresult_t rlhTermSetParticleCapacity(rlhTerm_h const term, const size_t capacity)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (term->backend->set_particle_capacity == NULL || term->backend->update_particles == NULL ||
+        term->backend->draw_particles == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    const rlhresult_t result = term->backend->set_particle_capacity(term->backend_data, capacity);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    term->particle_capacity = capacity;
+    term->particle_count = 0;
+    term->particle_seconds = 0.0f;
+    if (capacity == 0)
+    {
+      RLH_FREE(term->particles, term->allocator_user_data);
+      term->particles = NULL;
+      term->particle_array_capacity = 0;
+    }
+    if (term->recorder != NULL)
+    {
+      _rlhRecordParticleCapacity(term->recorder, capacity);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  // Keep particles to hand to the backend at the next draw, dropping the oldest ones that would be
+  // replaced by the time they get there anyway.
+  static inline rlhresult_t _rlhTermAddParticles(rlhTerm_h const term, const rlhParticle_s *particles, size_t count)
+  {
+    const size_t capacity = term->particle_capacity;
+    if (count > capacity)
+    {
+      particles += count - capacity;
+      count = capacity;
+    }
+    if (term->particle_count + count > capacity)
+    {
+      const size_t dropped = term->particle_count + count - capacity;
+      memmove(term->particles, term->particles + dropped, (term->particle_count - dropped) * sizeof(rlhParticle_s));
+      term->particle_count -= dropped;
+    }
+    if (term->particle_count + count > term->particle_array_capacity)
+    {
+      const size_t new_capacity = MIN(MAX(term->particle_array_capacity * 2, term->particle_count + count), capacity);
+      rlhParticle_s *const new_particles = (rlhParticle_s *)RLH_REALLOC(
+          term->particles, new_capacity * sizeof(rlhParticle_s), term->allocator_user_data);
+      if (new_particles == NULL)
+      {
+        return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      term->particles = new_particles;
+      term->particle_array_capacity = new_capacity;
+    }
+    memcpy(term->particles + term->particle_count, particles, count * sizeof(rlhParticle_s));
+    term->particle_count += count;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordParticles(term->recorder, particles, count);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  // A xorshift from -1.0 to 1.0, for spreading emitted particles out.
+  static inline float _rlhTermParticleRandom(rlhTerm_h const term)
+  {
+    uint32_t x = term->particle_random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    term->particle_random = x;
+    return (float)(x >> 8) / 8388608.0f - 1.0f;
+  }
+
+  rlhresult_t rlhTermEmitParticles(rlhTerm_h const term, const rlhParticleEmitInfo_t *const emit_info, const int count)
+  {
+    if (term == NULL || emit_info == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (term->particle_capacity == 0 || count < 0 || emit_info->glyph >= term->glyph_count ||
+        emit_info->width < 0 || emit_info->height < 0)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    const float *const stpqp = term->glyph_stpqp + emit_info->glyph * RLH_FONTMAP_COORDINATES_PER_GLYPH;
+    rlhParticle_s particles[64];
+    memset(particles, 0, sizeof(particles));
+    int emitted = 0;
+    while (emitted < count)
+    {
+      const int batch = MIN(count - emitted, (int)(sizeof(particles) / sizeof(particles[0])));
+      for (int i = 0; i < batch; i++)
+      {
+        rlhParticle_s *const particle = &particles[i];
+        particle->x = emit_info->x + emit_info->spread_x * _rlhTermParticleRandom(term);
+        particle->y = emit_info->y + emit_info->spread_y * _rlhTermParticleRandom(term);
+        particle->velocity_x = emit_info->velocity_x + emit_info->velocity_spread_x * _rlhTermParticleRandom(term);
+        particle->velocity_y = emit_info->velocity_y + emit_info->velocity_spread_y * _rlhTermParticleRandom(term);
+        particle->lifetime = emit_info->lifetime + emit_info->lifetime_spread * (0.5f + 0.5f * _rlhTermParticleRandom(term));
+        particle->acceleration_x = emit_info->acceleration_x;
+        particle->acceleration_y = emit_info->acceleration_y;
+        particle->drag = emit_info->drag;
+        particle->width = (float)(emit_info->width > 0 ? emit_info->width : (int)term->tile_width);
+        particle->height = (float)(emit_info->height > 0 ? emit_info->height : (int)term->tile_height);
+        particle->s = stpqp[0];
+        particle->t = stpqp[1];
+        particle->p = stpqp[2];
+        particle->q = stpqp[3];
+        particle->page = (uint32_t)stpqp[4];
+        particle->fg = emit_info->fg;
+        particle->bg = emit_info->bg;
+        particle->fg_end = emit_info->fg_end;
+        particle->bg_end = emit_info->bg_end;
+      }
+      const rlhresult_t result = _rlhTermAddParticles(term, particles, (size_t)batch);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      emitted += batch;
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermAdvanceParticles(rlhTerm_h const term, const float seconds)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (term->particle_capacity == 0 || !(seconds >= 0.0f))
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    term->particle_seconds += seconds;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordParticleTime(term->recorder, seconds);
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetPickMode(rlhTerm_h const term, const rlhbool_t enabled)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (enabled && !term->pick_mode)
+    {
+      // tiles pushed before pick mode was turned on are not in the index
+      term->pick_stale = RLH_TRUE;
+    }
+    else if (!enabled)
+    {
+      RLH_FREE(term->pick_rects, term->allocator_user_data);
+      RLH_FREE(term->pick_nodes, term->allocator_user_data);
+      RLH_FREE(term->pick_buckets, term->allocator_user_data);
+      term->pick_rects = NULL;
+      term->pick_rect_count = 0;
+      term->pick_rect_capacity = 0;
+      term->pick_nodes = NULL;
+      term->pick_node_count = 0;
+      term->pick_node_capacity = 0;
+      term->pick_buckets = NULL;
+      term->pick_large = 0;
+    }
+    term->pick_mode = enabled;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermSetPickTag(rlhTerm_h const term, const uint32_t tag)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    term->pick_tag = tag;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermPick(rlhTerm_h const term, const int pixel_x, const int pixel_y, rlhbool_t *const found,
+                          size_t *const tile_index, uint32_t *const tag)
+  {
+    if (term == NULL || found == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    *found = RLH_FALSE;
+    if (!term->pick_mode)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (term->pick_failed)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    if (term->pick_rect_count == 0)
+    {
+      return RLH_RESULT_OK;
+    }
+    // The lists are newest first, so the first tile that covers the position in each list is the
+    // topmost one of that list.
+    uint32_t best = 0;
+    const int bucket_x = MIN(MAX(pixel_x / term->pick_bucket_width, 0), term->pick_buckets_wide - 1);
+    const int bucket_y = MIN(MAX(pixel_y / term->pick_bucket_height, 0), term->pick_buckets_tall - 1);
+    const uint32_t lists[2] = {term->pick_buckets[bucket_y * term->pick_buckets_wide + bucket_x], term->pick_large};
+    for (int list = 0; list < 2; list++)
+    {
+      for (uint32_t node = lists[list]; node != 0; node = term->pick_nodes[node - 1].next)
+      {
+        const uint32_t rect = term->pick_nodes[node - 1].rect;
+        if (rect + 1 <= best)
+        {
+          break;
+        }
+        const rlhPickRect_s *const pick_rect = &term->pick_rects[rect];
+        if (pixel_x >= pick_rect->x && pixel_x < pick_rect->x + pick_rect->width &&
+            pixel_y >= pick_rect->y && pixel_y < pick_rect->y + pick_rect->height)
+        {
+          best = rect + 1;
+          break;
+        }
+      }
+    }
+    if (best == 0)
+    {
+      return RLH_RESULT_OK;
+    }
+    const rlhPickRect_s *const pick_rect = &term->pick_rects[best - 1];
+    *found = RLH_TRUE;
+    if (tile_index != NULL)
+    {
+      *tile_index = pick_rect->tile_index;
+    }
+    if (tag != NULL)
+    {
+      *tag = pick_rect->tag;
+    }
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermPushGridAnimated8(rlhTerm_h const term, const int grid_x, const int grid_y,
+                                       const uint16_t animation, const rlhColor8_s fg,
+                                       const rlhColor8_s bg)
+  {
+    if (_rlhTermRejectMaskedCell(term, grid_x, grid_y))
+    {
+      return RLH_RESULT_OK;
+    }
+    const int pixel_x = grid_x * term->tile_width;
+    const int pixel_y = grid_y * term->tile_height;
+    return rlhTermPushFreeSizedAnimated8(term, pixel_x, pixel_y, term->tile_width, term->tile_height, animation, fg, bg);
+  }
+
+  rlhresult_t rlhTermPushFreeSizedAnimated8(rlhTerm_h const term, const int screen_pixel_x,
+                                            const int screen_pixel_y, const int tile_pixel_width,
+                                            const int tile_pixel_height, const uint16_t animation,
+                                            const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    if (animation >= RLH_ANIMATION_COUNT)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    return _rlhTermPush(term, screen_pixel_x, screen_pixel_y, tile_pixel_width, tile_pixel_height,
+                        term->animations[animation].base_glyph, animation, fg, bg);
+  }
+
+  // Push a tile in a grid cell position into vertex data that was already reserved for it.
+  static inline void _rlhTermPushReservedGridTile(rlhTerm_h const term, const int grid_x, const int grid_y, const rlhglyph_t glyph,
+                                                  const uint16_t animation, const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    const int tile_width = (int)term->tile_width;
+    const int tile_height = (int)term->tile_height;
+    const int pixel_x = grid_x * tile_width;
+    const int pixel_y = grid_y * tile_height;
+    if (term->recorder != NULL)
+    {
+      _rlhRecordPush(term->recorder, pixel_x, pixel_y, tile_width, tile_height, glyph, animation, fg, bg);
+    }
+    _rlhTermPushTile(term, pixel_x, pixel_y, tile_width, tile_height, glyph, animation, fg, bg);
+  }
+
+  // Push grid tiles moved by offset_x and offset_y cells, or none of them if they do not all fit.
+  static inline rlhresult_t _rlhTermPushGridTiles(rlhTerm_h const term, const rlhGridTile8_s *const tiles, const size_t tile_count,
+                                                  const int offset_x, const int offset_y)
+  {
+    if (!_rlhTermTryReserveVertexData(term, tile_count))
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    const uint8_t *const mask = term->visibility_mask;
+    size_t tiles_masked = 0;
+    for (size_t i = 0; i < tile_count; i++)
+    {
+      const rlhGridTile8_s *const tile = &tiles[i];
+      const int grid_x = tile->grid_x + offset_x;
+      const int grid_y = tile->grid_y + offset_y;
+      if (mask != NULL && _rlhIsCellMasked(mask, term->tiles_wide, term->tiles_tall, grid_x, grid_y))
+      {
+        tiles_masked++;
+        continue;
+      }
+      _rlhTermPushReservedGridTile(term, grid_x, grid_y, tile->glyph, tile->animation, tile->fg, tile->bg);
+    }
+    term->stats.tiles_masked += tiles_masked;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermPushGridBatch8(rlhTerm_h const term, const rlhGridTile8_s *const tiles, const size_t tile_count)
+  {
+    if (term == NULL || (tiles == NULL && tile_count != 0))
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    RLH_PROFILE_BEGIN(rlh_push);
+#ifdef RLH_STATS_TIMERS
+    const uint64_t start_ns = _rlhNowNs();
+#endif
+    const rlhresult_t result = _rlhTermPushGridTiles(term, tiles, tile_count, 0, 0);
+#ifdef RLH_STATS_TIMERS
+    term->stats.push_cpu_ns += _rlhNowNs() - start_ns;
+#endif
+    RLH_PROFILE_END(rlh_push);
+    return result;
+  }
+
+  static inline uint64_t _rlhHashBytes(uint64_t hash, const void *const data, const size_t size)
+  {
+    const uint8_t *const bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+      hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+  // Hash a text and everything about its layout except where it is, which only moves its tiles.
+  static inline uint64_t _rlhHashText(const char *const text, const size_t text_length, const rlhTextInfo_t *const text_info)
+  {
+    const int layout[5] = {text_info->grid_width, text_info->grid_height, (int)text_info->wrap,
+                           (int)text_info->halign, (int)text_info->valign};
+    uint64_t hash = _rlhHashBytes(0xcbf29ce484222325ull, text, text_length);
+    hash = _rlhHashBytes(hash, layout, sizeof(layout));
+    hash = _rlhHashBytes(hash, &text_info->fg, sizeof(rlhColor8_s));
+    return _rlhHashBytes(hash, &text_info->bg, sizeof(rlhColor8_s));
+  }
+
+  static inline rlhbool_t _rlhTextRunMatches(const rlhTextRun_s *const run, const uint64_t hash, const char *const text,
+                                             const size_t text_length, const rlhTextInfo_t *const text_info)
+  {
+    const rlhTextInfo_t *const run_info = &run->text_info;
+    return (rlhbool_t)(run->text != NULL && run->hash == hash && run->text_length == text_length &&
+                       run_info->grid_width == text_info->grid_width && run_info->grid_height == text_info->grid_height &&
+                       run_info->wrap == text_info->wrap && run_info->halign == text_info->halign &&
+                       run_info->valign == text_info->valign &&
+                       memcmp(&run_info->fg, &text_info->fg, sizeof(rlhColor8_s)) == 0 &&
+                       memcmp(&run_info->bg, &text_info->bg, sizeof(rlhColor8_s)) == 0 &&
+                       memcmp(run->text, text, text_length) == 0);
+  }
+
+  // Read the hex digits of a color markup, which has an alpha of 255 unless there are 8 digits.
+  static inline rlhbool_t _rlhParseTextColor(const char *const digits, const size_t digit_count, rlhColor8_s *const color)
+  {
+    if (digit_count != 6 && digit_count != 8)
+    {
+      return RLH_FALSE;
+    }
+    uint8_t channels[4] = {0, 0, 0, 255};
+    for (size_t i = 0; i < digit_count; i++)
+    {
+      const char digit = digits[i];
+      int value;
+      if (digit >= '0' && digit <= '9')
+        value = digit - '0';
+      else if (digit >= 'a' && digit <= 'f')
+        value = digit - 'a' + 10;
+      else if (digit >= 'A' && digit <= 'F')
+        value = digit - 'A' + 10;
+      else
+        return RLH_FALSE;
+      channels[i / 2] = (uint8_t)((i % 2 == 0) ? value << 4 : channels[i / 2] | value);
+    }
+    color->r = channels[0];
+    color->g = channels[1];
+    color->b = channels[2];
+    color->a = channels[3];
+    return RLH_TRUE;
+  }
+
+  // Turn a text into a tile for each glyph, with grid_x and grid_y set to the line and column the
+  // glyph is in before the text is wrapped and aligned. Writes the amount of lines to line_count.
+  static inline rlhresult_t _rlhParseText(const char *const text, const size_t text_length, const rlhTextInfo_t *const text_info,
+                                          rlhGridTile8_s *const tiles, size_t *const tile_count, int *const line_count)
+  {
+    rlhColor8_s fg = text_info->fg;
+    rlhColor8_s bg = text_info->bg;
+    size_t count = 0;
+    int line = 0;
+    int column = 0;
+    for (size_t i = 0; i < text_length; i++)
+    {
+      char glyph = text[i];
+      if (glyph == '\n')
+      {
+        line++;
+        column = 0;
+        continue;
+      }
+      if (glyph == '{' && i + 1 < text_length && text[i + 1] == '{')
+      {
+        i++;
+      }
+      else if (glyph == '{')
+      {
+        const char *const markup = &text[i + 1];
+        const char *const end = (const char *)memchr(markup, '}', text_length - i - 1);
+        if (end == NULL)
+        {
+          return RLH_RESULT_ERROR_INVALID_VALUE;
+        }
+        const size_t markup_length = (size_t)(end - markup);
+        if (markup_length == 1 && markup[0] == '/')
+        {
+          fg = text_info->fg;
+          bg = text_info->bg;
+        }
+        else if (!(markup_length > 3 && markup[2] == '=' &&
+                   ((markup[0] == 'f' && markup[1] == 'g' && _rlhParseTextColor(markup + 3, markup_length - 3, &fg)) ||
+                    (markup[0] == 'b' && markup[1] == 'g' && _rlhParseTextColor(markup + 3, markup_length - 3, &bg)))))
+        {
+          return RLH_RESULT_ERROR_INVALID_VALUE;
+        }
+        i += markup_length + 1;
+        continue;
+      }
+      rlhGridTile8_s *const tile = &tiles[count++];
+      tile->grid_x = column++;
+      tile->grid_y = line;
+      tile->glyph = (rlhglyph_t)(unsigned char)glyph;
+      tile->fg = fg;
+      tile->bg = bg;
+      tile->animation = RLH_NO_ANIMATION;
+    }
+    *tile_count = count;
+    *line_count = text_length > 0 ? line + 1 : 0;
+    return RLH_RESULT_OK;
+  }
+
+  // Break the lines of parsed text that are wider than width between words, and write the amount
+  // of lines after wrapping to line_count. The spaces that lines are broken at are removed.
+  static inline void _rlhWrapText(rlhGridTile8_s *const tiles, size_t *const tile_count, const int width, int *const line_count)
+  {
+    size_t count = 0;
+    size_t line_start = 0;
+    int source_line = 0;
+    int line = 0;
+    int column = 0;
+    for (size_t i = 0; i < *tile_count; i++)
+    {
+      rlhGridTile8_s tile = tiles[i];
+      if (tile.grid_y != source_line)
+      {
+        line += tile.grid_y - source_line;
+        source_line = tile.grid_y;
+        line_start = count;
+        column = 0;
+      }
+      if (column == width)
+      {
+        line++;
+        column = 0;
+        if (tile.glyph == ' ')
+        {
+          line_start = count;
+          continue;
+        }
+        size_t space = count;
+        while (space > line_start && tiles[space - 1].glyph != ' ')
+        {
+          space--;
+        }
+        if (space > line_start + 1)
+        {
+          // move the last word down to the new line, without the space before it
+          memmove(&tiles[space - 1], &tiles[space], (count - space) * sizeof(rlhGridTile8_s));
+          count--;
+          line_start = space - 1;
+          for (size_t j = line_start; j < count; j++)
+          {
+            tiles[j].grid_x = column++;
+            tiles[j].grid_y = line;
+          }
+        }
+        else
+        {
+          line_start = count;
+        }
+      }
+      tile.grid_x = column++;
+      tile.grid_y = line;
+      tiles[count++] = tile;
+    }
+    *line_count += line - source_line;
+    *tile_count = count;
+  }
+
+  // Lay out a text into the tiles of a text run, replacing what the run was before.
+  static inline rlhresult_t _rlhTermLayoutText(rlhTerm_h const term, rlhTextRun_s *const run, const uint64_t hash,
+                                               const char *const text, const size_t text_length,
+                                               const rlhTextInfo_t *const text_info)
+  {
+    void *const allocator_user_data = term->allocator_user_data;
+    rlhGridTile8_s *const tiles = (rlhGridTile8_s *)RLH_MALLOC((text_length > 0 ? text_length : 1) * sizeof(rlhGridTile8_s), allocator_user_data);
+    char *const text_copy = (char *)RLH_MALLOC(text_length > 0 ? text_length : 1, allocator_user_data);
+    if (tiles == NULL || text_copy == NULL)
+    {
+      RLH_FREE(tiles, allocator_user_data);
+      RLH_FREE(text_copy, allocator_user_data);
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    size_t tile_count;
+    int line_count;
+    const rlhresult_t result = _rlhParseText(text, text_length, text_info, tiles, &tile_count, &line_count);
+    if (result != RLH_RESULT_OK)
+    {
+      RLH_FREE(tiles, allocator_user_data);
+      RLH_FREE(text_copy, allocator_user_data);
+      return result;
+    }
+    if (text_info->wrap)
+    {
+      _rlhWrapText(tiles, &tile_count, text_info->grid_width, &line_count);
+    }
+    int offset_y;
+    switch (text_info->valign)
+    {
+    case RLH_VALIGN_TOP:
+      offset_y = 0;
+      break;
+    case RLH_VALIGN_BOTTOM:
+      offset_y = text_info->grid_height - line_count;
+      break;
+    case RLH_VALIGN_CENTER:
+    default:
+      offset_y = (text_info->grid_height - line_count) / 2;
+    }
+    // align each line by the column after its last glyph, and clip the glyphs to the rectangle
+    size_t count = 0;
+    for (size_t line_start = 0, line_end; line_start < tile_count; line_start = line_end)
+    {
+      line_end = line_start + 1;
+      while (line_end < tile_count && tiles[line_end].grid_y == tiles[line_start].grid_y)
+      {
+        line_end++;
+      }
+      const int line_width = tiles[line_end - 1].grid_x + 1;
+      int offset_x;
+      switch (text_info->halign)
+      {
+      case RLH_HALIGN_LEFT:
+        offset_x = 0;
+        break;
+      case RLH_HALIGN_RIGHT:
+        offset_x = text_info->grid_width - line_width;
+        break;
+      case RLH_HALIGN_CENTER:
+      default:
+        offset_x = (text_info->grid_width - line_width) / 2;
+      }
+      for (size_t i = line_start; i < line_end; i++)
+      {
+        rlhGridTile8_s tile = tiles[i];
+        const int x = tile.grid_x + offset_x;
+        const int y = tile.grid_y + offset_y;
+        if (x < 0 || x >= text_info->grid_width || y < 0 || y >= text_info->grid_height)
+        {
+          continue;
+        }
+        tile.grid_x = text_info->grid_x + x;
+        tile.grid_y = text_info->grid_y + y;
+        tiles[count++] = tile;
+      }
+    }
+    memcpy(text_copy, text, text_length);
+    RLH_FREE(run->text, allocator_user_data);
+    RLH_FREE(run->tiles, allocator_user_data);
+    run->hash = hash;
+    run->text = text_copy;
+    run->text_length = text_length;
+    run->text_info = *text_info;
+    run->tiles = tiles;
+    run->tile_count = count;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermPushText(rlhTerm_h const term, const rlhTextInfo_t *const text_info, const char *const text)
+  {
+    if (term == NULL || text_info == NULL || text == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (text_info->grid_width <= 0 || text_info->grid_height <= 0)
+    {
+      return RLH_RESULT_OK;
+    }
+    const size_t text_length = strlen(text);
+    const uint64_t hash = _rlhHashText(text, text_length, text_info);
+    rlhTextRun_s *const run = &term->text_runs[hash % RLH_TEXT_CACHE_SIZE];
+    if (_rlhTextRunMatches(run, hash, text, text_length, text_info))
+    {
+      term->stats.text_cache_hits++;
+      const int move_x = text_info->grid_x - run->text_info.grid_x;
+      const int move_y = text_info->grid_y - run->text_info.grid_y;
+      if (move_x != 0 || move_y != 0)
+      {
+        for (size_t i = 0; i < run->tile_count; i++)
+        {
+          run->tiles[i].grid_x += move_x;
+          run->tiles[i].grid_y += move_y;
+        }
+        run->text_info.grid_x = text_info->grid_x;
+        run->text_info.grid_y = text_info->grid_y;
+      }
+    }
+    else
+    {
+      const rlhresult_t result = _rlhTermLayoutText(term, run, hash, text, text_length, text_info);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+    }
+    return rlhTermPushGridBatch8(term, run->tiles, run->tile_count);
   }
 
-  rlhresult_t rlhTermPushFill(rlhTerm_h const term, const uint16_t glyph, const rlhColor_s fg,
-                              const rlhColor_s bg)
+  typedef struct rlhScrollback_s
+  {
+    int line_width;
+    size_t line_capacity;
+    void *allocator_user_data;
+    // line_capacity lines of line_width tiles each, used as a ring that starts at first_line.
+    rlhGridTile8_s *tiles;
+    int *line_lengths;
+    size_t first_line;
+    size_t line_count;
+    // Where messages are wrapped before their lines are copied into the ring.
+    rlhGridTile8_s *message_tiles;
+    size_t message_tile_capacity;
+  } rlhScrollback_s;
+
+  rlhresult_t rlhScrollbackCreate(const rlhScrollbackCreateInfo_t *const scrollback_info, rlhScrollback_h *scrollback)
   {
-    if (!_rlhTermTryReserveVertexData(term))
+    if (scrollback_info == NULL || scrollback == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (scrollback_info->line_width <= 0 || scrollback_info->line_capacity <= 0)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    void *const allocator_user_data = scrollback_info->allocator_user_data;
+    rlhScrollback_h scrollback_h = (rlhScrollback_h)RLH_MALLOC(sizeof(rlhScrollback_s), allocator_user_data);
+    if (scrollback_h == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memset(scrollback_h, 0, sizeof(rlhScrollback_s));
+    scrollback_h->line_width = scrollback_info->line_width;
+    scrollback_h->line_capacity = (size_t)scrollback_info->line_capacity;
+    scrollback_h->allocator_user_data = allocator_user_data;
+    scrollback_h->tiles = (rlhGridTile8_s *)RLH_MALLOC(scrollback_h->line_capacity * (size_t)scrollback_h->line_width * sizeof(rlhGridTile8_s), allocator_user_data);
+    scrollback_h->line_lengths = (int *)RLH_MALLOC(scrollback_h->line_capacity * sizeof(int), allocator_user_data);
+    if (scrollback_h->tiles == NULL || scrollback_h->line_lengths == NULL)
+    {
+      rlhScrollbackDestroy(scrollback_h);
       return RLH_RESULT_ERROR_OUT_OF_MEMORY;
-    _rlhTermPushTile(term, 0, 0, term->unscaled_pixel_width, term->unscaled_pixel_height, glyph, fg, bg);
+    }
+    *scrollback = scrollback_h;
     return RLH_RESULT_OK;
   }
 
-  rlhresult_t rlhTermPushGrid(rlhTerm_h const term, const int grid_x, const int grid_y,
-                              const uint16_t glyph, const rlhColor_s fg,
-                              const rlhColor_s bg)
+  void rlhScrollbackDestroy(rlhScrollback_h const scrollback)
   {
-    const int pixel_x = grid_x * term->tile_width * term->pixel_scale;
-    const int pixel_y = grid_y * term->tile_height * term->pixel_scale;
-    if (!_rlhTermTryReserveVertexData(term))
-      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
-    _rlhTermPushTile(term, pixel_x, pixel_y, term->tile_width * term->pixel_scale, term->tile_height * term->pixel_scale, glyph, fg, bg);
+    if (scrollback == NULL)
+      return;
+    void *const allocator_user_data = scrollback->allocator_user_data;
+    RLH_FREE(scrollback->tiles, allocator_user_data);
+    RLH_FREE(scrollback->line_lengths, allocator_user_data);
+    RLH_FREE(scrollback->message_tiles, allocator_user_data);
+    RLH_FREE(scrollback, allocator_user_data);
+  }
+
+  rlhresult_t rlhScrollbackAdd(rlhScrollback_h const scrollback, const char *const text, const rlhColor8_s fg, const rlhColor8_s bg)
+  {
+    if (scrollback == NULL || text == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    const size_t text_length = strlen(text);
+    if (text_length > scrollback->message_tile_capacity)
+    {
+      rlhGridTile8_s *const message_tiles = (rlhGridTile8_s *)RLH_REALLOC(scrollback->message_tiles, text_length * sizeof(rlhGridTile8_s), scrollback->allocator_user_data);
+      if (message_tiles == NULL)
+      {
+        return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+      }
+      scrollback->message_tiles = message_tiles;
+      scrollback->message_tile_capacity = text_length;
+    }
+    rlhTextInfo_t text_info;
+    memset(&text_info, 0, sizeof(rlhTextInfo_t));
+    text_info.fg = fg;
+    text_info.bg = bg;
+    rlhGridTile8_s *const message_tiles = scrollback->message_tiles;
+    size_t tile_count;
+    int line_count;
+    const rlhresult_t result = _rlhParseText(text, text_length, &text_info, message_tiles, &tile_count, &line_count);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    _rlhWrapText(message_tiles, &tile_count, scrollback->line_width, &line_count);
+    // an empty message is still an empty line
+    if (line_count == 0)
+    {
+      line_count = 1;
+    }
+    size_t tile = 0;
+    for (int line = 0; line < line_count; line++)
+    {
+      size_t slot;
+      if (scrollback->line_count == scrollback->line_capacity)
+      {
+        slot = scrollback->first_line;
+        scrollback->first_line = (scrollback->first_line + 1) % scrollback->line_capacity;
+      }
+      else
+      {
+        slot = (scrollback->first_line + scrollback->line_count) % scrollback->line_capacity;
+        scrollback->line_count++;
+      }
+      rlhGridTile8_s *const line_tiles = &scrollback->tiles[slot * (size_t)scrollback->line_width];
+      int length = 0;
+      for (; tile < tile_count && message_tiles[tile].grid_y == line; tile++)
+      {
+        line_tiles[length] = message_tiles[tile];
+        line_tiles[length].grid_y = 0;
+        length++;
+      }
+      scrollback->line_lengths[slot] = length;
+    }
     return RLH_RESULT_OK;
   }
 
-  rlhresult_t rlhTermPushGridSized(rlhTerm_h const term, const int grid_x, const int grid_y,
-                                   const int tile_pixel_width, const int tile_pixel_height,
-                                   const uint16_t glyph, const rlhColor_s fg,
-                                   const rlhColor_s bg)
+  rlhresult_t rlhScrollbackClear(rlhScrollback_h const scrollback)
   {
-    if (!_rlhTermTryReserveVertexData(term))
-      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
-    const unsigned int pixel_x = (unsigned int)grid_x * term->tile_width * term->pixel_scale;
-    const unsigned int pixel_y = (unsigned int)grid_y * term->tile_height * term->pixel_scale;
-    const unsigned int pixel_w_u = (unsigned int)tile_pixel_width * term->pixel_scale;
-    const unsigned int pixel_h_u = (unsigned int)tile_pixel_height * term->pixel_scale;
-    _rlhTermPushTile(term, pixel_x, pixel_y, pixel_w_u, pixel_h_u, glyph, fg, bg);
+    if (scrollback == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    scrollback->first_line = 0;
+    scrollback->line_count = 0;
     return RLH_RESULT_OK;
   }
 
-  rlhresult_t rlhTermPushFree(rlhTerm_h const term, const int screen_pixel_x,
-                              const int screen_pixel_y, const uint16_t glyph,
-                              const rlhColor_s fg, const rlhColor_s bg)
+  rlhresult_t rlhScrollbackGetLineCount(rlhScrollback_h const scrollback, size_t *const line_count)
   {
-    if (!_rlhTermTryReserveVertexData(term))
-      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
-    _rlhTermPushTile(term, (unsigned int)screen_pixel_x * term->pixel_scale, (unsigned int)screen_pixel_y * term->pixel_scale,
-                     term->tile_width * term->pixel_scale, term->tile_height * term->pixel_scale, glyph, fg, bg);
+    if (scrollback == NULL || line_count == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    *line_count = scrollback->line_count;
     return RLH_RESULT_OK;
   }
 
-  rlhresult_t rlhTermPushFreeSized(rlhTerm_h const term, const int screen_pixel_x,
-                                   const int screen_pixel_y, const int tile_pixel_width,
-                                   const int tile_pixel_height, const uint16_t glyph,
-                                   const rlhColor_s fg, const rlhColor_s bg)
+  rlhresult_t rlhTermPushScrollback(rlhTerm_h const term, rlhScrollback_h const scrollback, const int grid_x, const int grid_y,
+                                    const int grid_height, const size_t scroll)
   {
-    if (!_rlhTermTryReserveVertexData(term))
-      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
-    _rlhTermPushTile(term, screen_pixel_x * term->pixel_scale, screen_pixel_y * term->pixel_scale, tile_pixel_width * term->pixel_scale, tile_pixel_height * term->pixel_scale,
-                     glyph, fg, bg);
+    if (term == NULL || scrollback == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (grid_height <= 0 || scrollback->line_count == 0)
+    {
+      return RLH_RESULT_OK;
+    }
+    RLH_PROFILE_BEGIN(rlh_push);
+#ifdef RLH_STATS_TIMERS
+    const uint64_t start_ns = _rlhNowNs();
+#endif
+    const size_t height = (size_t)grid_height;
+    const size_t max_scroll = scrollback->line_count > height ? scrollback->line_count - height : 0;
+    const size_t end = scrollback->line_count - (scroll < max_scroll ? scroll : max_scroll);
+    const size_t start = end > height ? end - height : 0;
+    rlhresult_t result = RLH_RESULT_OK;
+    for (size_t line = start; result == RLH_RESULT_OK && line < end; line++)
+    {
+      const size_t slot = (scrollback->first_line + line) % scrollback->line_capacity;
+      const int row = grid_y + grid_height - (int)(end - line);
+      result = _rlhTermPushGridTiles(term, &scrollback->tiles[slot * (size_t)scrollback->line_width],
+                                     (size_t)scrollback->line_lengths[slot], grid_x, row);
+    }
+#ifdef RLH_STATS_TIMERS
+    term->stats.push_cpu_ns += _rlhNowNs() - start_ns;
+#endif
+    RLH_PROFILE_END(rlh_push);
+    return result;
+  }
+
+  // Copy the 2 by 2 pixels of an image that a cell covers, in the order top left, top right, bottom
+  // left, bottom right, as RGBA bytes. Pixels past the edges of the image are transparent.
+  static inline void _rlhGetImageCellPixels(const rlhColor8_s *const pixels, const int width, const int height,
+                                            const int pixel_x, const int pixel_y, uint8_t cell_pixels[16])
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      const int x = pixel_x + (i & 1);
+      const int y = pixel_y + (i >> 1);
+      if (x < width && y < height)
+      {
+        const rlhColor8_s *const pixel = &pixels[(size_t)y * (size_t)width + (size_t)x];
+        cell_pixels[i * 4 + 0] = pixel->r;
+        cell_pixels[i * 4 + 1] = pixel->g;
+        cell_pixels[i * 4 + 2] = pixel->b;
+        cell_pixels[i * 4 + 3] = pixel->a;
+      }
+      else
+      {
+        memset(&cell_pixels[i * 4], 0, 4);
+      }
+    }
+  }
+
+  // Find the split of the 4 pixels of a cell into a foreground and a background set, with the top left
+  // pixel in the foreground, where the pixels are closest to the mean color of their set. That is the
+  // split with the largest sum of squared channel sums over set sizes, which is scaled by 6 to stay in
+  // integers. The 7 splits are scored in 8 lanes at once, the last of which never wins, so compilers
+  // can vectorize the loop. Returns the mask of the foreground pixels, and the mean colors of the sets
+  // in fg and bg.
+  static inline int _rlhFitImageCell(const uint8_t cell_pixels[16], rlhColor8_s *const fg, rlhColor8_s *const bg)
+  {
+    static const int masks[8] = {1, 3, 5, 7, 9, 11, 13, 0};
+    static const int top_right[8] = {0, 1, 0, 1, 0, 1, 0, 0};
+    static const int bottom_left[8] = {0, 0, 1, 1, 0, 0, 1, 0};
+    static const int bottom_right[8] = {0, 0, 0, 0, 1, 1, 1, 0};
+    static const int fg_scales[8] = {6, 3, 3, 2, 3, 2, 2, 0};
+    static const int bg_scales[8] = {2, 3, 3, 6, 3, 6, 6, 0};
+    // 65536 over 1, 2 and 3 rounded up, which divides every sum of up to 4 channels exactly when
+    // multiplied and shifted right by 16
+    static const int reciprocals[4] = {0, 65536, 32768, 21846};
+    int scores[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int c = 0; c < 4; c++)
+    {
+      const int p0 = cell_pixels[c];
+      const int p1 = cell_pixels[4 + c];
+      const int p2 = cell_pixels[8 + c];
+      const int p3 = cell_pixels[12 + c];
+      const int total = p0 + p1 + p2 + p3;
+      for (int m = 0; m < 8; m++)
+      {
+        const int sum = p0 + top_right[m] * p1 + bottom_left[m] * p2 + bottom_right[m] * p3;
+        const int rest = total - sum;
+        scores[m] += sum * sum * fg_scales[m] + rest * rest * bg_scales[m];
+      }
+    }
+    int best = 0;
+    for (int m = 1; m < 7; m++)
+    {
+      best = scores[m] > scores[best] ? m : best;
+    }
+    const int mask = masks[best];
+    const int fg_count = 1 + top_right[best] + bottom_left[best] + bottom_right[best];
+    const int bg_count = 4 - fg_count;
+    uint8_t channels[8];
+    for (int c = 0; c < 4; c++)
+    {
+      int fg_sum = 0;
+      int bg_sum = 0;
+      for (int i = 0; i < 4; i++)
+      {
+        const int in_fg = (mask >> i) & 1;
+        fg_sum += in_fg * cell_pixels[i * 4 + c];
+        bg_sum += (1 - in_fg) * cell_pixels[i * 4 + c];
+      }
+      channels[c] = (uint8_t)(((fg_sum + fg_count / 2) * reciprocals[fg_count]) >> 16);
+      channels[4 + c] = (uint8_t)(((bg_sum + bg_count / 2) * reciprocals[bg_count]) >> 16);
+    }
+    fg->r = channels[0];
+    fg->g = channels[1];
+    fg->b = channels[2];
+    fg->a = channels[3];
+    bg->r = channels[4];
+    bg->g = channels[5];
+    bg->b = channels[6];
+    bg->a = channels[7];
+    return mask;
+  }
+
+  rlhresult_t rlhTermPushImage(rlhTerm_h const term, const int grid_x, const int grid_y, const rlhColor8_s *const pixels,
+                               const int width, const int height, const rlhImageMapping_t *const mapping)
+  {
+    if (term == NULL || mapping == NULL || (pixels == NULL && width != 0 && height != 0))
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    if (width < 0 || height < 0 || mapping->mode < 0 || mapping->mode >= RLH_IMAGE_MODE_COUNT)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    const rlhbool_t quadrants = (rlhbool_t)(mapping->mode == RLH_IMAGE_QUADRANTS);
+    const int cells_wide = quadrants ? (width + 1) / 2 : width;
+    const int cells_tall = (height + 1) / 2;
+    // only the cells that are on the terminal are fit
+    const int first_x = MAX(-grid_x, 0);
+    const int first_y = MAX(-grid_y, 0);
+    const int end_x = MIN(cells_wide, (int)term->tiles_wide - grid_x);
+    const int end_y = MIN(cells_tall, (int)term->tiles_tall - grid_y);
+    if (first_x >= end_x || first_y >= end_y)
+    {
+      return RLH_RESULT_OK;
+    }
+    RLH_PROFILE_BEGIN(rlh_push);
+#ifdef RLH_STATS_TIMERS
+    const uint64_t start_ns = _rlhNowNs();
+#endif
+    rlhresult_t result = RLH_RESULT_OK;
+    if (!_rlhTermTryReserveVertexData(term, (size_t)(end_x - first_x) * (size_t)(end_y - first_y)))
+    {
+      result = RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    const uint8_t *const mask = term->visibility_mask;
+    size_t tiles_masked = 0;
+    for (int y = first_y; result == RLH_RESULT_OK && y < end_y; y++)
+    {
+      for (int x = first_x; x < end_x; x++)
+      {
+        if (mask != NULL && _rlhIsCellMasked(mask, term->tiles_wide, term->tiles_tall, grid_x + x, grid_y + y))
+        {
+          tiles_masked++;
+          continue;
+        }
+        uint8_t cell_pixels[16];
+        rlhColor8_s fg;
+        rlhColor8_s bg;
+        int glyph_mask = 3;
+        if (quadrants)
+        {
+          _rlhGetImageCellPixels(pixels, width, height, x * 2, y * 2, cell_pixels);
+          glyph_mask = _rlhFitImageCell(cell_pixels, &fg, &bg);
+        }
+        else
+        {
+          // the top pixel is the foreground of the upper half block and the bottom pixel is the background
+          _rlhGetImageCellPixels(pixels, width, height, x, y * 2, cell_pixels);
+          fg.r = cell_pixels[0];
+          fg.g = cell_pixels[1];
+          fg.b = cell_pixels[2];
+          fg.a = cell_pixels[3];
+          bg.r = cell_pixels[8];
+          bg.g = cell_pixels[9];
+          bg.b = cell_pixels[10];
+          bg.a = cell_pixels[11];
+        }
+        _rlhTermPushReservedGridTile(term, grid_x + x, grid_y + y, mapping->glyphs[glyph_mask], RLH_NO_ANIMATION, fg, bg);
+      }
+    }
+    term->stats.tiles_masked += tiles_masked;
+#ifdef RLH_STATS_TIMERS
+    term->stats.push_cpu_ns += _rlhNowNs() - start_ns;
+#endif
+    RLH_PROFILE_END(rlh_push);
+    return result;
+  }
+
+  rlhresult_t rlhTermGetStats(rlhTerm_h const term, rlhTermStats_t *const stats)
+  {
+    if (term == NULL || stats == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    const rlhTermStats_t *draw_stats = &term->handoff_draw_stats;
+    if (!term->handoff_mode)
+    {
+      _rlhTermReadGpuTimes(term);
+      draw_stats = &term->draw_stats;
+    }
+    const rlhTermStats_t *const base = &term->draw_stats_base;
+    *stats = term->stats;
+    stats->bytes_uploaded = draw_stats->bytes_uploaded - base->bytes_uploaded;
+    stats->draw_calls = draw_stats->draw_calls - base->draw_calls;
+    stats->cached_draws = draw_stats->cached_draws - base->cached_draws;
+    stats->particles_emitted = draw_stats->particles_emitted - base->particles_emitted;
+    stats->draw_cpu_ns = draw_stats->draw_cpu_ns - base->draw_cpu_ns;
+    stats->gpu_ns = draw_stats->gpu_ns - base->gpu_ns;
+    stats->gpu_timed_draws = draw_stats->gpu_timed_draws - base->gpu_timed_draws;
+    stats->gpu_last_draw_ns = stats->gpu_timed_draws > 0 ? draw_stats->gpu_last_draw_ns : 0;
+    return RLH_RESULT_OK;
+  }
+
+  rlhresult_t rlhTermResetStats(rlhTerm_h const term)
+  {
+    if (term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    memset(&term->stats, 0, sizeof(rlhTermStats_t));
+    term->draw_stats_base = term->handoff_mode ? term->handoff_draw_stats : term->draw_stats;
     return RLH_RESULT_OK;
   }
 
@@ -1239,10 +6349,312 @@ extern "C"
     {
       return RLH_RESULT_ERROR_NULL_ARGUMENT;
     }
-
-    rlhTermDrawMatrix(term, RLH_OPENGL_SCREEN_MATRIX);
-
-    return RLH_RESULT_OK;
+
+    return rlhTermDrawMatrix(term, RLH_OPENGL_SCREEN_MATRIX);
+  }
+
+  // Hash the vertex data in four independent lanes, so the multiplies do not wait on each other.
+  static inline uint64_t _rlhHashVertexData(const rlhVertex_s *const vertex_data, const size_t tile_count)
+  {
+    const uint8_t *const bytes = (const uint8_t *)vertex_data;
+    const size_t size = _rlhGetVertexDataSize(tile_count);
+    const uint64_t prime = 0x100000001b3ull;
+    uint64_t lanes[4] = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+      uint64_t words[4];
+      memcpy(words, bytes + i, sizeof(words));
+      lanes[0] = (lanes[0] ^ words[0]) * prime;
+      lanes[1] = (lanes[1] ^ words[1]) * prime;
+      lanes[2] = (lanes[2] ^ words[2]) * prime;
+      lanes[3] = (lanes[3] ^ words[3]) * prime;
+    }
+    for (; i < size; i++)
+    {
+      lanes[0] = (lanes[0] ^ bytes[i]) * prime;
+    }
+    return ((lanes[0] * prime ^ lanes[1]) * prime ^ lanes[2]) * prime ^ lanes[3];
+  }
+
+  // Hand the palette and light map to the backend if they changed, which tiles and particles are
+  // both drawn with. Either one changing means the cached image is out of date.
+  static inline rlhresult_t _rlhTermSendColors(rlhTerm_h const term)
+  {
+    rlhresult_t result = RLH_RESULT_OK;
+    if (term->palette_changed && term->backend->set_palette != NULL)
+    {
+      // The palette only reaches the backend when it is about to be drawn with.
+      result = term->backend->set_palette(term->backend_data, term->palette_mode ? term->palette : NULL);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      if (term->palette_mode)
+      {
+        term->draw_stats.bytes_uploaded += RLH_PALETTE_SIZE * sizeof(rlhColor8_s);
+      }
+      term->palette_changed = RLH_FALSE;
+      term->cache_valid = RLH_FALSE;
+    }
+    if (term->light_map_changed && term->backend->set_light_map != NULL)
+    {
+      // Like the palette, the light map is only uploaded once per draw however often it changed.
+      result = term->backend->set_light_map(
+          term->backend_data,
+          term->light_map,
+          (int)term->tiles_wide,
+          (int)term->tiles_tall,
+          (float)term->unscaled_pixel_width / (float)term->tile_width,
+          (float)term->unscaled_pixel_height / (float)term->tile_height);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      if (term->light_map != NULL)
+      {
+        term->draw_stats.bytes_uploaded += term->tiles_wide * term->tiles_tall * sizeof(rlhColor8_s);
+      }
+      term->light_map_changed = RLH_FALSE;
+      term->cache_valid = RLH_FALSE;
+    }
+    return result;
+  }
+
+  static inline rlhresult_t _rlhTermDrawTiles(rlhTerm_h const term, const float *const matrix_4x4, const rlhScissor_t *const scissor, uint32_t *const texture)
+  {
+    if (term->recorder != NULL)
+    {
+      _rlhRecordTag(term->recorder, RLH_RECORD_FRAME);
+    }
+    // In handoff mode the tiles that are drawn are the latest published frame, not the ones being pushed.
+    const rlhVertex_s *vertex_data;
+    size_t tile_count;
+    rlhbool_t *vertex_data_changed;
+    if (term->handoff_mode)
+    {
+      _rlhTermAcquireFrame(term);
+      vertex_data = term->handoff_buffers[term->handoff_read].vertex_data;
+      tile_count = term->handoff_buffers[term->handoff_read].tile_count;
+      vertex_data_changed = &term->handoff_frame_changed;
+    }
+    else
+    {
+      vertex_data = term->vertex_data;
+      tile_count = term->vertex_data_tile_count;
+      vertex_data_changed = &term->vertex_data_changed;
+    }
+    if (tile_count == 0)
+    {
+      if (term->atlas_upload_state == RLH_ATLAS_UPLOAD_TRANSFERRING)
+      {
+        return _rlhTermStepAtlasUpload(term);
+      }
+      return RLH_RESULT_OK;
+    }
+#ifdef RLH_STATS_TIMERS
+    const uint64_t start_ns = _rlhNowNs();
+    _rlhTermReadGpuTimes(term);
+#endif
+    rlhbool_t redraw = RLH_TRUE;
+    if (term->cache_mode)
+    {
+      if (*vertex_data_changed)
+      {
+        // Tiles pushed again exactly as before do not have to be uploaded or drawn again.
+        RLH_PROFILE_BEGIN(rlh_hash_vertices);
+        const uint64_t hash = _rlhHashVertexData(vertex_data, tile_count);
+        RLH_PROFILE_END(rlh_hash_vertices);
+        if (term->cache_valid && hash == term->cache_hash && tile_count == term->cache_tile_count)
+        {
+          *vertex_data_changed = RLH_FALSE;
+        }
+        term->cache_hash = hash;
+        term->cache_tile_count = tile_count;
+      }
+      redraw = (rlhbool_t)(!term->cache_valid ||
+                           *vertex_data_changed ||
+                           term->palette_changed ||
+                           term->light_map_changed ||
+                           (term->animation_time_changed && term->animations_used) ||
+                           (term->motion_changed && term->motions_used));
+    }
+    // Update vertex buffer and element buffer data.
+    const size_t before_element_glyph_count = term->element_glyph_count;
+    RLH_PROFILE_BEGIN(rlh_append_elements);
+    rlhresult_t result = _rlhTermTryAppendElements(term, tile_count);
+    RLH_PROFILE_END(rlh_append_elements);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    if (*vertex_data_changed)
+    {
+      RLH_PROFILE_BEGIN(rlh_upload_vertices);
+      result = term->backend->upload_vertices(
+          term->backend_data,
+          vertex_data,
+          _rlhGetVertexDataSize(tile_count));
+      RLH_PROFILE_END(rlh_upload_vertices);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      term->draw_stats.bytes_uploaded += _rlhGetVertexDataSize(tile_count);
+      *vertex_data_changed = RLH_FALSE;
+    }
+    result = _rlhTermSendColors(term);
+    if (result != RLH_RESULT_OK)
+    {
+      return result;
+    }
+    if (term->animation_time_changed && term->backend->set_animation_time != NULL)
+    {
+      result = term->backend->set_animation_time(term->backend_data, (float)term->animation_time);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      term->animation_time_changed = RLH_FALSE;
+    }
+    if (term->cells_changed && term->backend->set_cells != NULL)
+    {
+      result = term->backend->set_cells(
+          term->backend_data,
+          (float)term->unscaled_pixel_width / (float)term->tile_width,
+          (float)term->unscaled_pixel_height / (float)term->tile_height);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      term->cells_changed = RLH_FALSE;
+    }
+    if (term->motion_changed && term->backend->set_motion != NULL)
+    {
+      result = term->backend->set_motion(
+          term->backend_data,
+          term->motion_alpha,
+          (float)term->unscaled_pixel_width,
+          (float)term->unscaled_pixel_height);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      term->motion_changed = RLH_FALSE;
+    }
+    if (before_element_glyph_count != term->element_glyph_count)
+    {
+      RLH_PROFILE_BEGIN(rlh_upload_elements);
+      result = term->backend->upload_elements(
+          term->backend_data,
+          term->element_data,
+          _rlhGetElementDataSize(term->element_glyph_count));
+      RLH_PROFILE_END(rlh_upload_elements);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      term->draw_stats.bytes_uploaded += _rlhGetElementDataSize(term->element_glyph_count);
+    }
+    // In low res mode the image of the terminal is not scaled, and is scaled up when it is drawn.
+    const int image_width = (int)(term->low_res_mode ? term->unscaled_pixel_width : term->scaled_pixel_width);
+    const int image_height = (int)(term->low_res_mode ? term->unscaled_pixel_height : term->scaled_pixel_height);
+    RLH_PROFILE_BEGIN(rlh_draw);
+    if (texture != NULL)
+    {
+      const rlhbool_t own_texture = (rlhbool_t)(*texture == 0);
+      if (own_texture && term->cache_mode && !redraw && term->texture != 0)
+      {
+        // the texture of the terminal is the cached image, which is already up to date
+        *texture = term->texture;
+        term->draw_stats.cached_draws++;
+      }
+      else
+      {
+        result = term->backend->draw_to_texture(term->backend_data, _rlhGetElementCount(tile_count), *texture,
+                                                image_width, image_height, texture);
+        if (own_texture)
+        {
+          term->texture = (result == RLH_RESULT_OK) ? *texture : 0;
+          term->cache_valid = (rlhbool_t)(result == RLH_RESULT_OK);
+        }
+        else if (redraw)
+        {
+          // the cached image is no longer what the hash says it is
+          term->cache_valid = RLH_FALSE;
+        }
+      }
+    }
+    else if (term->cache_mode || term->low_res_mode)
+    {
+      result = term->backend->draw_cached(term->backend_data, matrix_4x4, _rlhGetElementCount(tile_count), scissor,
+                                          image_width, image_height, redraw);
+      term->cache_valid = (rlhbool_t)(result == RLH_RESULT_OK);
+      if (!redraw)
+      {
+        term->draw_stats.cached_draws++;
+      }
+    }
+    else
+    {
+      result = term->backend->draw(term->backend_data, matrix_4x4, _rlhGetElementCount(tile_count), scissor);
+    }
+    RLH_PROFILE_END(rlh_draw);
+    term->draw_stats.draw_calls++;
+#ifndef RLH_RETAINED_MODE
+    // a published frame is drawn until the next one, and the pushed tiles are not the drawing thread's to clear
+    if (!term->handoff_mode)
+    {
+      _rlhTermClearTileData(term);
+    }
+#endif
+    // The atlas is only switched after a draw, so the tiles of a frame never mix two atlases.
+    if (result == RLH_RESULT_OK && term->atlas_upload_state == RLH_ATLAS_UPLOAD_TRANSFERRING)
+    {
+      result = _rlhTermStepAtlasUpload(term);
+    }
+#ifdef RLH_STATS_TIMERS
+    term->draw_stats.draw_cpu_ns += _rlhNowNs() - start_ns;
+#endif
+    return result;
+  }
+
+  // Draw to the bound framebuffer, or into the texture that texture points to if it is not NULL,
+  // which is then set to the texture that was drawn into.
+  static inline rlhresult_t _rlhTermDraw(rlhTerm_h const term, const float *const matrix_4x4, const rlhScissor_t *const scissor, uint32_t *const texture)
+  {
+    rlhresult_t result = _rlhTermDrawTiles(term, matrix_4x4, scissor, texture);
+    if (result != RLH_RESULT_OK || term->particle_capacity == 0 ||
+        term->backend->update_particles == NULL || term->backend->draw_particles == NULL)
+    {
+      return result;
+    }
+    // The particles move on the GPU once per draw, however many times they were advanced since.
+    if (term->particle_count > 0 || term->particle_seconds > 0.0f)
+    {
+      result = term->backend->update_particles(term->backend_data, term->particle_seconds, term->particles, term->particle_count);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      term->draw_stats.particles_emitted += term->particle_count;
+      term->draw_stats.bytes_uploaded += term->particle_count * sizeof(rlhParticle_s);
+      term->particle_count = 0;
+      term->particle_seconds = 0.0f;
+    }
+    // Particles are drawn over the tiles, and only to the framebuffer. Without any tiles to draw,
+    // the colors they are drawn with might not have been handed to the backend yet.
+    if (texture == NULL)
+    {
+      result = _rlhTermSendColors(term);
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+      result = term->backend->draw_particles(term->backend_data, matrix_4x4, scissor,
+                                             (float)term->unscaled_pixel_width, (float)term->unscaled_pixel_height);
+    }
+    return result;
   }
 
   // Translate an opengl screen matrix so that a rectangle using it is flat facing the screen and
@@ -1261,29 +6673,6 @@ extern "C"
     matrix[7] -= screenspace_translate_y;
   }
 
-  static void _rlhSetTermScissor(const int translate_x, const int translate_y, const int width,
-                                 const int height, const int viewport_height)
-  {
-    GLD_START();
-    const int actual_translate_y = viewport_height - (translate_x + height);
-    // crop the scissor area so the position is not less than 0 (this causes opengl error)
-    const int cropped_x = MAX(translate_x, 0);
-    const int cropped_y = MAX(actual_translate_y, 0);
-    int cropped_width = width;
-    int cropped_height = height;
-    if (cropped_x != translate_x)
-    {
-      cropped_width += translate_x;
-    }
-    if (cropped_y != actual_translate_y)
-    {
-      cropped_height += actual_translate_y;
-    }
-    // set scissor
-    GLD_CALL(glScissor(cropped_x, cropped_y, cropped_width, cropped_height));
-    GLD_CALL(glEnable(GL_SCISSOR_TEST));
-  }
-
   rlhresult_t rlhTermDrawAligned(rlhTerm_h const term, const int viewport_width, const int viewport_height, rlhtermhalign_t h_align, rlhtermvalign_t v_align)
   {
     if (term == NULL)
@@ -1317,8 +6706,7 @@ extern "C"
     default:
       translate_y = height_difference / 2;
     }
-    rlhTermDrawTranslated(term, translate_x, translate_y, viewport_width, viewport_height);
-    return RLH_RESULT_OK;
+    return rlhTermDrawTranslated(term, translate_x, translate_y, viewport_width, viewport_height);
   }
 
   rlhresult_t rlhTermDrawTranslated(rlhTerm_h const term,
@@ -1333,13 +6721,9 @@ extern "C"
     memcpy(matrix, RLH_OPENGL_SCREEN_MATRIX, sizeof(float) * RLH_MATRIX_FLOAT_COUNT);
     _rlhTransformMatrix(matrix, viewport_width, viewport_height, translate_x, translate_y,
                         term->scaled_pixel_width, term->scaled_pixel_height);
-    _rlhSetTermScissor(translate_x, translate_y, term->scaled_pixel_width, term->scaled_pixel_height, viewport_height);
+    const rlhScissor_t scissor = {translate_x, translate_y, (int)term->scaled_pixel_width, (int)term->scaled_pixel_height, viewport_height};
     // draw
-    rlhTermDrawMatrix(term, matrix);
-    GLD_START();
-    // unset the scissor
-    GLD_CALL(glDisable(GL_SCISSOR_TEST));
-    return RLH_RESULT_OK;
+    return _rlhTermDraw(term, matrix, &scissor, NULL);
   }
 
   rlhresult_t rlhTermDrawTransformed(rlhTerm_h const term,
@@ -1356,14 +6740,10 @@ extern "C"
     memcpy(matrix, RLH_OPENGL_SCREEN_MATRIX, sizeof(float) * RLH_MATRIX_FLOAT_COUNT);
     _rlhTransformMatrix(matrix, viewport_width, viewport_height, translate_x, translate_y,
                         term->scaled_pixel_width * scale_x, term->scaled_pixel_height * scale_y);
-    _rlhSetTermScissor(translate_x, translate_y, term->scaled_pixel_width * scale_x,
-                       term->scaled_pixel_height * scale_y, viewport_height);
+    const rlhScissor_t scissor = {translate_x, translate_y, (int)(term->scaled_pixel_width * scale_x),
+                                  (int)(term->scaled_pixel_height * scale_y), viewport_height};
     // draw
-    rlhTermDrawMatrix(term, matrix);
-    GLD_START();
-    // unset the scissor
-    GLD_CALL(glDisable(GL_SCISSOR_TEST));
-    return RLH_RESULT_OK;
+    return _rlhTermDraw(term, matrix, &scissor, NULL);
   }
 
   rlhresult_t rlhTermDrawMatrix(rlhTerm_h const term,
@@ -1373,79 +6753,623 @@ extern "C"
     {
       return RLH_RESULT_ERROR_NULL_ARGUMENT;
     }
-    if (term->vertex_data_tile_count == 0)
+    return _rlhTermDraw(term, matrix_4x4, NULL, NULL);
+  }
+
+  rlhresult_t rlhTermDrawToTexture(rlhTerm_h const term, const uint32_t texture, uint32_t *const drawn_texture)
+  {
+    if (term == NULL)
     {
-      return RLH_RESULT_OK;
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
     }
-    GLD_START();
-    // Update vertex buffer and element buffer data. Create objects if they don't exist yet.
-    const size_t before_element_glyph_count = term->element_glyph_count;
-    rlhresult_t result = _rlhTermTryAppendElements(term);
+    if (term->backend->draw_to_texture == NULL)
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    uint32_t target = texture;
+    const rlhresult_t result = _rlhTermDraw(term, RLH_OPENGL_SCREEN_MATRIX, NULL, &target);
+    if (drawn_texture != NULL)
+    {
+      // a terminal without tiles is not drawn, and keeps the texture it had
+      *drawn_texture = (target == 0) ? term->texture : target;
+    }
+    return result;
+  }
+
+  typedef struct rlhReplay_s
+  {
+    const uint8_t *data;
+    size_t size;
+    size_t cursor;
+    void *allocator_user_data;
+    // Where the first frame starts, after the size and atlas the recording started with.
+    size_t start;
+    rlhbool_t retained;
+    rlhbool_t state_changed;
+    rlhTermSizeInfo_t size_info;
+    rlhAtlasCreateInfo_t atlas_info;
+    rlhRecordPush_s last_push;
+    // The motion of the next push, from the motion record before it.
+    int64_t motion_x;
+    int64_t motion_y;
+  } rlhReplay_s;
+
+  static inline rlhbool_t _rlhReplayRead(rlhReplay_h const replay, void *const value, const size_t size)
+  {
+    if (replay->size - replay->cursor < size)
+      return RLH_FALSE;
+    memcpy(value, replay->data + replay->cursor, size);
+    replay->cursor += size;
+    return RLH_TRUE;
+  }
+
+  static inline rlhbool_t _rlhReplayAlign(rlhReplay_h const replay, const size_t alignment)
+  {
+    const size_t padding = (alignment - replay->cursor % alignment) % alignment;
+    if (replay->size - replay->cursor < padding)
+      return RLH_FALSE;
+    replay->cursor += padding;
+    return RLH_TRUE;
+  }
+
+  static inline rlhbool_t _rlhReplayReadVarint(rlhReplay_h const replay, int64_t *const value)
+  {
+    uint64_t bits = 0;
+    for (int shift = 0; shift < 64 && replay->cursor < replay->size; shift += 7)
+    {
+      const uint8_t byte = replay->data[replay->cursor++];
+      bits |= (uint64_t)(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+      {
+        *value = (int64_t)(bits >> 1) ^ -(int64_t)(bits & 1);
+        return RLH_TRUE;
+      }
+    }
+    return RLH_FALSE;
+  }
+
+  static inline rlhresult_t _rlhReplayReadSize(rlhReplay_h const replay, rlhTermSizeInfo_t *const size_info)
+  {
+    int32_t values[7];
+    if (!_rlhReplayRead(replay, values, sizeof(values)))
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    size_info->width = values[0];
+    size_info->height = values[1];
+    size_info->size_mode = (rlhsizemode_t)values[2];
+    size_info->floor_pixels_to_tiles = (rlhbool_t)values[3];
+    size_info->pixel_scale = values[4];
+    size_info->tile_width = values[5];
+    size_info->tile_height = values[6];
+    return _rlhSizeInfoCheck(size_info);
+  }
+
+  // The pixels and glyph coordinates of the atlas point into the recording instead of being copied.
+  static inline rlhresult_t _rlhReplayReadAtlas(rlhReplay_h const replay, rlhAtlasCreateInfo_t *const atlas_info)
+  {
+    int32_t values[6];
+    uint64_t pixel_data_size;
+    if (!_rlhReplayRead(replay, values, sizeof(values)) ||
+        !_rlhReplayRead(replay, &pixel_data_size, sizeof(pixel_data_size)) ||
+        !_rlhReplayAlign(replay, 8))
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    atlas_info->width = values[0];
+    atlas_info->height = values[1];
+    atlas_info->pages = values[2];
+    atlas_info->channel_size = values[3];
+    atlas_info->color = (rlhcolortype_t)values[4];
+    atlas_info->glyph_count = values[5];
+    atlas_info->pixel_data = replay->data + replay->cursor;
+    rlhresult_t result = _rlhAtlasInfoCheck(atlas_info);
     if (result != RLH_RESULT_OK)
     {
       return result;
     }
-    rlhbool_t create_vertex_array = term->gl_vertex_array == GL_NONE;
-    if (create_vertex_array)
+    const uint64_t stpqp_size = (uint64_t)atlas_info->glyph_count * RLH_FONTMAP_COORDINATES_PER_GLYPH * sizeof(float);
+    if (pixel_data_size != _rlhGetAtlasPixelDataSize(atlas_info) ||
+        pixel_data_size > replay->size - replay->cursor)
     {
-      GLD_CALL(glGenVertexArrays(1, &term->gl_vertex_array));
-      GLD_CALL(glGenBuffers(1, &term->gl_vertex_buffer));
-      GLD_CALL(glGenBuffers(1, &term->gl_element_buffer));
+      return RLH_RESULT_ERROR_INVALID_VALUE;
     }
-    if (term->vertex_data_changed)
+    replay->cursor += (size_t)pixel_data_size;
+    if (!_rlhReplayAlign(replay, sizeof(float)) ||
+        stpqp_size > replay->size - replay->cursor)
     {
-      GLD_CALL(glBindVertexArray(term->gl_vertex_array));
-      GLD_CALL(glBindBuffer(GL_ARRAY_BUFFER, term->gl_vertex_buffer));
-      GLD_CALL(glBufferData(
-          GL_ARRAY_BUFFER,
-          _rlhGetVertexDataSize(term->vertex_data_tile_count),
-          term->vertex_data,
-          GL_STREAM_DRAW));
-      term->vertex_data_changed = RLH_FALSE;
+      return RLH_RESULT_ERROR_INVALID_VALUE;
     }
-    if (before_element_glyph_count != term->element_glyph_count)
+    atlas_info->glyph_stpqp = (const float *)(replay->data + replay->cursor);
+    replay->cursor += (size_t)stpqp_size;
+    return RLH_RESULT_OK;
+  }
+
+  static inline rlhresult_t _rlhReplayReadPush(rlhReplay_h const replay, const uint8_t tag)
+  {
+    rlhRecordPush_s *const last = &replay->last_push;
+    int64_t delta_x, delta_y, delta_glyph;
+    if (!_rlhReplayReadVarint(replay, &delta_x) ||
+        !_rlhReplayReadVarint(replay, &delta_y) ||
+        !_rlhReplayReadVarint(replay, &delta_glyph))
     {
-      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, term->gl_element_buffer);
-      glBufferData(
-          GL_ELEMENT_ARRAY_BUFFER,
-          _rlhGetElementDataSize(term->element_glyph_count),
-          term->element_data,
-          GL_DYNAMIC_DRAW);
-    }
-    if (create_vertex_array)
-    {
-      const size_t stride = RLH_VERTEX_DATA_ATTRIBUTES_PER_VERTEX * sizeof(float);
-      // position
-      glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *)0);
-      glEnableVertexAttribArray(0);
-      // uvp
-      glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void *)(2 * sizeof(float)));
-      glEnableVertexAttribArray(1);
-      // forground color
-      glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void *)(5 * sizeof(float)));
-      glEnableVertexAttribArray(2);
-      // background color
-      glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void *)(9 * sizeof(float)));
-      glEnableVertexAttribArray(3);
+      return RLH_RESULT_ERROR_INVALID_VALUE;
     }
-    // Bind objects
-    GLD_CALL(glBindVertexArray(term->gl_vertex_array));
-    GLD_CALL(glUseProgram(term->gl_program));
-    // bind the atlas texture
-    GLD_CALL(glActiveTexture(GL_TEXTURE0 + RLH_ATLAS_TEXTURE_SLOT));
-    GLD_CALL(glBindTexture(GL_TEXTURE_2D_ARRAY, term->gl_atlas_texture_2d_array));
-    // set the matrix uniform
-    GLD_CALL(glUniformMatrix4fv(term->gl_matrix_uniform_location, 1, GL_TRUE, matrix_4x4));
-    // set blend mode
-    GLD_CALL(glEnable(GL_BLEND));
-    GLD_CALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-    // DRAW!!!
-    GLD_CALL(glDrawElements(GL_TRIANGLES, _rlhGetElementCount(term->vertex_data_tile_count), GL_UNSIGNED_INT, NULL));
-#ifndef RLH_RETAINED_MODE
-    rlhTermClearTileData(term);
+    last->x += delta_x;
+    last->y += delta_y;
+    last->glyph += delta_glyph;
+    if (tag & RLH_RECORD_PUSH_SIZE_CHANGED)
+    {
+      int64_t delta_width, delta_height;
+      if (!_rlhReplayReadVarint(replay, &delta_width) ||
+          !_rlhReplayReadVarint(replay, &delta_height))
+      {
+        return RLH_RESULT_ERROR_INVALID_VALUE;
+      }
+      last->width += delta_width;
+      last->height += delta_height;
+    }
+    if (tag & RLH_RECORD_PUSH_ANIMATION_CHANGED)
+    {
+      int64_t delta_animation;
+      if (!_rlhReplayReadVarint(replay, &delta_animation))
+      {
+        return RLH_RESULT_ERROR_INVALID_VALUE;
+      }
+      last->animation += delta_animation;
+    }
+    if (((tag & RLH_RECORD_PUSH_FG_CHANGED) && !_rlhReplayRead(replay, &last->fg, sizeof(rlhColor8_s))) ||
+        ((tag & RLH_RECORD_PUSH_BG_CHANGED) && !_rlhReplayRead(replay, &last->bg, sizeof(rlhColor8_s))))
+    {
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    return RLH_RESULT_OK;
+  }
+
+  static inline void _rlhReplayFreeData(const uint8_t *const data, const size_t size, void *const allocator_user_data)
+  {
+    if (data == NULL)
+      return;
+#ifdef RLH_REPLAY_MMAP
+    (void)allocator_user_data;
+    munmap((void *)data, size);
+#else
+    (void)size;
+    RLH_FREE((void *)data, allocator_user_data);
 #endif
+  }
+
+  // Map a whole file into memory, or read it into memory where mapping is not available.
+  static inline rlhresult_t _rlhReplayLoadData(const char *const path, void *const allocator_user_data, const uint8_t **data, size_t *size)
+  {
+#ifdef RLH_REPLAY_MMAP
+    (void)allocator_user_data;
+    const int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+      return RLH_RESULT_ERROR_IO;
+    }
+    struct stat file_stat;
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size <= 0)
+    {
+      close(file);
+      return RLH_RESULT_ERROR_IO;
+    }
+    void *mapping = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+    {
+      return RLH_RESULT_ERROR_IO;
+    }
+    *data = (const uint8_t *)mapping;
+    *size = (size_t)file_stat.st_size;
+    return RLH_RESULT_OK;
+#else
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+      return RLH_RESULT_ERROR_IO;
+    }
+    long file_size = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+      file_size = ftell(file);
+    }
+    if (file_size <= 0 || fseek(file, 0, SEEK_SET) != 0)
+    {
+      fclose(file);
+      return RLH_RESULT_ERROR_IO;
+    }
+    uint8_t *buffer = (uint8_t *)RLH_MALLOC((size_t)file_size, allocator_user_data);
+    if (buffer == NULL)
+    {
+      fclose(file);
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    const size_t read_size = fread(buffer, 1, (size_t)file_size, file);
+    fclose(file);
+    if (read_size != (size_t)file_size)
+    {
+      RLH_FREE(buffer, allocator_user_data);
+      return RLH_RESULT_ERROR_IO;
+    }
+    *data = buffer;
+    *size = (size_t)file_size;
+    return RLH_RESULT_OK;
+#endif
+  }
+
+  rlhresult_t rlhReplayOpen(const char *const path, void *const allocator_user_data, rlhReplay_h *replay)
+  {
+    if (path == NULL || replay == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    rlhReplay_h replay_h = (rlhReplay_h)RLH_MALLOC(sizeof(rlhReplay_s), allocator_user_data);
+    if (replay_h == NULL)
+    {
+      return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+    }
+    memset(replay_h, 0, sizeof(rlhReplay_s));
+    replay_h->allocator_user_data = allocator_user_data;
+    rlhresult_t result = _rlhReplayLoadData(path, allocator_user_data, &replay_h->data, &replay_h->size);
+    if (result != RLH_RESULT_OK)
+    {
+      RLH_FREE(replay_h, allocator_user_data);
+      return result;
+    }
+    char magic[sizeof(RLH_RECORD_MAGIC)];
+    uint32_t header_values[4];
+    uint8_t tag = 0;
+    if (!_rlhReplayRead(replay_h, magic, sizeof(magic)) ||
+        !_rlhReplayRead(replay_h, header_values, sizeof(header_values)) ||
+        memcmp(magic, RLH_RECORD_MAGIC, sizeof(magic)) != 0 ||
+        header_values[0] != RLH_RECORD_VERSION ||
+        header_values[1] != RLH_RECORD_BYTE_ORDER ||
+        !_rlhReplayRead(replay_h, &tag, 1) ||
+        tag != RLH_RECORD_SIZE)
+    {
+      rlhReplayClose(replay_h);
+      return RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    replay_h->retained = (rlhbool_t)((header_values[2] & RLH_RECORD_FLAG_RETAINED) != 0);
+    result = _rlhReplayReadSize(replay_h, &replay_h->size_info);
+    if (result == RLH_RESULT_OK &&
+        (!_rlhReplayRead(replay_h, &tag, 1) || tag != RLH_RECORD_ATLAS))
+    {
+      result = RLH_RESULT_ERROR_INVALID_VALUE;
+    }
+    if (result == RLH_RESULT_OK)
+    {
+      result = _rlhReplayReadAtlas(replay_h, &replay_h->atlas_info);
+    }
+    if (result != RLH_RESULT_OK)
+    {
+      rlhReplayClose(replay_h);
+      return result;
+    }
+    replay_h->start = replay_h->cursor;
+    *replay = replay_h;
+    return RLH_RESULT_OK;
+  }
+
+  void rlhReplayClose(rlhReplay_h const replay)
+  {
+    if (replay == NULL)
+      return;
+    _rlhReplayFreeData(replay->data, replay->size, replay->allocator_user_data);
+    RLH_FREE(replay, replay->allocator_user_data);
+  }
+
+  rlhresult_t rlhReplayCreateTerm(rlhReplay_h const replay, const rlhTermCreateInfo_t *const term_info, rlhTerm_h *term)
+  {
+    if (replay == NULL || term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    rlhTermCreateInfo_t replay_term_info;
+    if (term_info != NULL)
+    {
+      replay_term_info = *term_info;
+    }
+    else
+    {
+      memset(&replay_term_info, 0, sizeof(rlhTermCreateInfo_t));
+      replay_term_info.allocator_user_data = replay->allocator_user_data;
+    }
+    replay_term_info.size_info = &replay->size_info;
+    replay_term_info.atlas_info = &replay->atlas_info;
+    return rlhTermCreate(&replay_term_info, term);
+  }
+
+  rlhresult_t rlhReplayNextFrame(rlhReplay_h const replay, rlhTerm_h const term, rlhbool_t *const has_frame)
+  {
+    if (replay == NULL || term == NULL || has_frame == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    *has_frame = RLH_FALSE;
+    // A terminal that was not in retained mode cleared itself after every draw.
+    if (!replay->retained)
+    {
+      _rlhTermClearTileData(term);
+    }
+    while (replay->cursor < replay->size)
+    {
+      const uint8_t tag = replay->data[replay->cursor++];
+      rlhresult_t result = RLH_RESULT_OK;
+      switch (tag & RLH_RECORD_TAG_MASK)
+      {
+      case RLH_RECORD_PUSH:
+      {
+        result = _rlhReplayReadPush(replay, tag);
+        if (result == RLH_RESULT_OK)
+        {
+          const rlhRecordPush_s *const push = &replay->last_push;
+          result = _rlhTermPushMoving(term, (int)push->x, (int)push->y, (int)push->width, (int)push->height,
+                                      (uint16_t)push->glyph, (uint16_t)push->animation, push->fg, push->bg,
+                                      (int16_t)replay->motion_x, (int16_t)replay->motion_y);
+        }
+        replay->motion_x = 0;
+        replay->motion_y = 0;
+        break;
+      }
+      case RLH_RECORD_MOTION:
+      {
+        if (!_rlhReplayReadVarint(replay, &replay->motion_x) ||
+            !_rlhReplayReadVarint(replay, &replay->motion_y) ||
+            replay->motion_x < -INT16_MAX || replay->motion_x > INT16_MAX ||
+            replay->motion_y < -INT16_MAX || replay->motion_y > INT16_MAX)
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+        }
+        break;
+      }
+      case RLH_RECORD_PARTICLE_CAPACITY:
+      {
+        uint64_t capacity;
+        if (!_rlhReplayRead(replay, &capacity, sizeof(capacity)) || capacity > SIZE_MAX)
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        result = rlhTermSetParticleCapacity(term, (size_t)capacity);
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      case RLH_RECORD_PARTICLES:
+      {
+        uint32_t count;
+        if (!_rlhReplayRead(replay, &count, sizeof(count)) || term->particle_capacity == 0)
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        // The particles in the file might not be aligned, so they are copied out a few at a time.
+        rlhParticle_s particles[64];
+        while (result == RLH_RESULT_OK && count > 0)
+        {
+          const uint32_t batch = MIN(count, (uint32_t)(sizeof(particles) / sizeof(particles[0])));
+          if (!_rlhReplayRead(replay, particles, batch * sizeof(rlhParticle_s)))
+          {
+            result = RLH_RESULT_ERROR_INVALID_VALUE;
+            break;
+          }
+          result = _rlhTermAddParticles(term, particles, batch);
+          count -= batch;
+        }
+        break;
+      }
+      case RLH_RECORD_PARTICLE_TIME:
+      {
+        float seconds;
+        if (!_rlhReplayRead(replay, &seconds, sizeof(seconds)))
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        result = rlhTermAdvanceParticles(term, seconds);
+        break;
+      }
+      case RLH_RECORD_MOTION_ALPHA:
+      {
+        float alpha;
+        if (!_rlhReplayRead(replay, &alpha, sizeof(alpha)))
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        result = rlhTermSetMotionAlpha(term, alpha);
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      case RLH_RECORD_CLEAR:
+        result = rlhTermClearTileData(term);
+        break;
+      case RLH_RECORD_FRAME:
+        *has_frame = RLH_TRUE;
+        return RLH_RESULT_OK;
+      case RLH_RECORD_SIZE:
+      {
+        rlhTermSizeInfo_t size_info;
+        result = _rlhReplayReadSize(replay, &size_info);
+        if (result == RLH_RESULT_OK)
+        {
+          result = rlhTermSetSize(term, &size_info);
+        }
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      case RLH_RECORD_ATLAS:
+      {
+        rlhAtlasCreateInfo_t atlas_info;
+        result = _rlhReplayReadAtlas(replay, &atlas_info);
+        if (result == RLH_RESULT_OK)
+        {
+          result = rlhTermSetAtlas(term, &atlas_info);
+        }
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      case RLH_RECORD_PALETTE:
+      {
+        uint8_t palette_mode = 0;
+        rlhColor8_s palette[RLH_PALETTE_SIZE];
+        if (!_rlhReplayRead(replay, &palette_mode, 1) ||
+            !_rlhReplayRead(replay, palette, sizeof(palette)))
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        result = rlhTermSetPalette(term, 0, RLH_PALETTE_SIZE, palette);
+        if (result == RLH_RESULT_OK)
+        {
+          result = rlhTermSetPaletteMode(term, (rlhbool_t)(palette_mode != 0));
+        }
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      case RLH_RECORD_ANIMATION:
+      {
+        int32_t values[4];
+        rlhAnimationInfo_t animation_info;
+        memset(&animation_info, 0, sizeof(rlhAnimationInfo_t));
+        if (!_rlhReplayRead(replay, values, sizeof(values)))
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        if (values[1] != 0)
+        {
+          float timing[2];
+          if (!_rlhReplayRead(replay, timing, sizeof(timing)) ||
+              !_rlhReplayRead(replay, &animation_info.fg, sizeof(rlhColor8_s)) ||
+              !_rlhReplayRead(replay, &animation_info.bg, sizeof(rlhColor8_s)))
+          {
+            result = RLH_RESULT_ERROR_INVALID_VALUE;
+            break;
+          }
+          animation_info.base_glyph = (rlhglyph_t)values[2];
+          animation_info.frame_count = values[3];
+          animation_info.frame_duration = timing[0];
+          animation_info.color_period = timing[1];
+        }
+        if (values[0] <= RLH_NO_ANIMATION || values[0] >= RLH_ANIMATION_COUNT)
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        result = rlhTermSetAnimation(term, (uint16_t)values[0], values[1] != 0 ? &animation_info : NULL);
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      case RLH_RECORD_ANIMATION_TIME:
+      {
+        double seconds;
+        if (!_rlhReplayRead(replay, &seconds, sizeof(seconds)))
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        result = rlhTermSetAnimationTime(term, seconds);
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      case RLH_RECORD_LIGHT_MAP:
+      {
+        int32_t values[2];
+        if (!_rlhReplayRead(replay, values, sizeof(values)))
+        {
+          result = RLH_RESULT_ERROR_INVALID_VALUE;
+          break;
+        }
+        const rlhColor8_s *light_map = NULL;
+        if (values[0] != 0 || values[1] != 0)
+        {
+          // A light map always covers the tiles of the size recorded before it.
+          const size_t light_map_size = (size_t)term->tiles_wide * term->tiles_tall * sizeof(rlhColor8_s);
+          if ((size_t)values[0] != term->tiles_wide || (size_t)values[1] != term->tiles_tall ||
+              light_map_size > replay->size - replay->cursor)
+          {
+            result = RLH_RESULT_ERROR_INVALID_VALUE;
+            break;
+          }
+          light_map = (const rlhColor8_s *)(replay->data + replay->cursor);
+          replay->cursor += light_map_size;
+        }
+        result = rlhTermSetLightMap(term, light_map);
+        replay->state_changed = RLH_TRUE;
+        break;
+      }
+      default:
+        result = RLH_RESULT_ERROR_INVALID_VALUE;
+        break;
+      }
+      if (result != RLH_RESULT_OK)
+      {
+        return result;
+      }
+    }
     return RLH_RESULT_OK;
   }
+
+  rlhresult_t rlhReplayRewind(rlhReplay_h const replay, rlhTerm_h const term)
+  {
+    if (replay == NULL || term == NULL)
+    {
+      return RLH_RESULT_ERROR_NULL_ARGUMENT;
+    }
+    replay->cursor = replay->start;
+    memset(&replay->last_push, 0, sizeof(rlhRecordPush_s));
+    replay->motion_x = 0;
+    replay->motion_y = 0;
+    rlhresult_t result = rlhTermClearTileData(term);
+    if (result == RLH_RESULT_OK && replay->state_changed)
+    {
+      result = rlhTermSetSize(term, &replay->size_info);
+      if (result == RLH_RESULT_OK)
+      {
+        result = rlhTermSetAtlas(term, &replay->atlas_info);
+      }
+      if (result == RLH_RESULT_OK)
+      {
+        // Recordings start with a zeroed palette and palette mode off.
+        const rlhColor8_s palette[RLH_PALETTE_SIZE] = {{0, 0, 0, 0}};
+        result = rlhTermSetPalette(term, 0, RLH_PALETTE_SIZE, palette);
+      }
+      if (result == RLH_RESULT_OK)
+      {
+        result = rlhTermSetPaletteMode(term, RLH_FALSE);
+      }
+      // Recordings start with no animations, at time 0.
+      for (uint16_t animation = 1; result == RLH_RESULT_OK && animation < RLH_ANIMATION_COUNT; animation++)
+      {
+        if (term->animation_is_set[animation])
+        {
+          result = rlhTermSetAnimation(term, animation, NULL);
+        }
+      }
+      if (result == RLH_RESULT_OK)
+      {
+        result = rlhTermSetAnimationTime(term, 0.0);
+      }
+      if (result == RLH_RESULT_OK && term->light_map != NULL)
+      {
+        result = rlhTermSetLightMap(term, NULL);
+      }
+      // and with moving tiles drawn at their current positions.
+      if (result == RLH_RESULT_OK && term->motion_alpha != 1.0f)
+      {
+        result = rlhTermSetMotionAlpha(term, 1.0f);
+      }
+      if (result == RLH_RESULT_OK && term->particle_capacity != 0)
+      {
+        result = rlhTermSetParticleCapacity(term, 0);
+      }
+      replay->state_changed = RLH_FALSE;
+    }
+    return result;
+  }
 #endif
 #ifdef __cplusplus
 }
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#define RLH_NO_OPENGL
+#define RLH_IMPLEMENTATION
+#include <rlh/rlh.hpp>
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(condition)                                                  \
+  if (!(condition))                                                       \
+  {                                                                       \
+    std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+    return EXIT_FAILURE;                                                  \
+  }
+
+int main()
+{
+  static constexpr auto stpqp = rlh::makeGridStpqp<16, 16>();
+  const std::uint8_t pixels[16 * 16 * 4] = {};
+  rlhAtlasCreateInfo_t atlas_info = {16, 16, 1, 1, RLH_COLOR_RGBA, pixels, rlh::GRID_GLYPH_COUNT<16, 16>, stpqp.data()};
+  rlhTermSizeInfo_t size_info = {20, 10, RLH_SIZE_TILES, RLH_FALSE, 1, 8, 8};
+  rlhTermCreateInfo_t term_info = {};
+  term_info.size_info = &size_info;
+  term_info.atlas_info = &atlas_info;
+  term_info.backend = &RLH_BACKEND_NULL;
+  using Terminal = rlh::Terminal<8, 8, 1>;
+  Terminal term;
+  CHECK(Terminal::create(term_info, term) == RLH_RESULT_OK);
+  const rlhColor8_s white = {255, 255, 255, 255};
+  const rlhColor8_s black = {0, 0, 0, 255};
+  CHECK(term.pushGrid(1, 1, '@', white, black) == RLH_RESULT_OK);
+  rlhTextInfo_t text_info = {};
+  text_info.grid_width = 20;
+  text_info.grid_height = 1;
+  text_info.fg = white;
+  // Pushing the same text twice lays it out once and reuses the run the second time.
+  CHECK(term.pushText(text_info, "hello") == RLH_RESULT_OK);
+  CHECK(term.pushText(text_info, "hello") == RLH_RESULT_OK);
+  rlhTermStats_t stats = {};
+  CHECK(term.getStats(stats) == RLH_RESULT_OK);
+  CHECK(stats.text_cache_hits == 1);
+  CHECK(stats.tiles_pushed == 11);
+  CHECK(term.draw() == RLH_RESULT_OK);
+  return EXIT_SUCCESS;
+}
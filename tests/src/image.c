@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "test.h"
+
+int main(void)
+{
+  rlhTerm_h term = NULL;
+  CHECK(test_create_term(10, 4, &term) == RLH_RESULT_OK);
+  const rlhColor8_s red = {255, 0, 0, 255};
+  const rlhColor8_s blue = {0, 0, 255, 255};
+  rlhImageMapping_t mapping;
+  memset(&mapping, 0, sizeof(mapping));
+  for (int i = 0; i < 16; i++)
+  {
+    mapping.glyphs[i] = (rlhglyph_t)(128 + i);
+  }
+  // In half block mode, each cell is fit to the pixel above and the pixel below.
+  const rlhColor8_s half_pixels[2 * 2] = {red, blue, blue, red};
+  mapping.mode = RLH_IMAGE_HALF_BLOCKS;
+  CHECK(rlhTermPushImage(term, 1, 1, half_pixels, 2, 2, &mapping) == RLH_RESULT_OK);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_glyph_at(term, 1, 1) == 128 + 3);
+  CHECK(test_color_equals(test_vertices[test_find_tile(term, 1, 1) * 4].fg, red));
+  CHECK(test_color_equals(test_vertices[test_find_tile(term, 1, 1) * 4].bg, blue));
+  CHECK(test_color_equals(test_vertices[test_find_tile(term, 2, 1) * 4].fg, blue));
+  CHECK(test_color_equals(test_vertices[test_find_tile(term, 2, 1) * 4].bg, red));
+  // In quadrant mode, the quarters closest to the foreground color get it.
+  const rlhColor8_s quadrant_pixels[2 * 2] = {red, blue, blue, blue};
+  mapping.mode = RLH_IMAGE_QUADRANTS;
+  CHECK(rlhTermPushImage(term, 0, 0, quadrant_pixels, 2, 2, &mapping) == RLH_RESULT_OK);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_tile_count == 1);
+  CHECK(test_glyph_at(term, 0, 0) == 128 + 1);
+  CHECK(test_color_equals(test_vertices[0].fg, red));
+  CHECK(test_color_equals(test_vertices[0].bg, blue));
+  // Cells outside of the terminal are skipped.
+  const rlhColor8_s wide_pixels[4 * 2] = {red, red, blue, blue, red, red, blue, blue};
+  CHECK(rlhTermResetStats(term) == RLH_RESULT_OK);
+  CHECK(rlhTermPushImage(term, 9, 0, wide_pixels, 4, 2, &mapping) == RLH_RESULT_OK);
+  rlhTermStats_t stats;
+  CHECK(rlhTermGetStats(term, &stats) == RLH_RESULT_OK);
+  CHECK(stats.tiles_pushed == 1);
+  mapping.mode = RLH_IMAGE_MODE_COUNT;
+  CHECK(rlhTermPushImage(term, 0, 0, quadrant_pixels, 2, 2, &mapping) == RLH_RESULT_ERROR_INVALID_VALUE);
+  rlhTermDestroy(term);
+  return EXIT_SUCCESS;
+}
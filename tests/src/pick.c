@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "test.h"
+
+int main(void)
+{
+  rlhTerm_h term = NULL;
+  CHECK(test_create_term(10, 4, &term) == RLH_RESULT_OK);
+  const rlhColor8_s white = {255, 255, 255, 255};
+  const rlhColor8_s black = {0, 0, 0, 255};
+  rlhbool_t found = RLH_FALSE;
+  size_t tile_index = 0;
+  uint32_t tag = 0;
+  CHECK(rlhTermPick(term, 0, 0, &found, &tile_index, &tag) == RLH_RESULT_ERROR_INVALID_VALUE);
+  CHECK(rlhTermSetPickMode(term, RLH_TRUE) == RLH_RESULT_OK);
+  CHECK(rlhTermSetPickTag(term, 7) == RLH_RESULT_OK);
+  CHECK(rlhTermPushGrid8(term, 1, 1, 'a', white, black) == RLH_RESULT_OK);
+  CHECK(rlhTermSetPickTag(term, 9) == RLH_RESULT_OK);
+  CHECK(rlhTermPushGrid8(term, 1, 1, 'b', white, black) == RLH_RESULT_OK);
+  CHECK(rlhTermPushGrid8(term, 3, 2, 'c', white, black) == RLH_RESULT_OK);
+  // The last pushed tile that covers a position is the one on top.
+  CHECK(rlhTermPick(term, 1 * TEST_TILE_SIZE + 3, 1 * TEST_TILE_SIZE + 3, &found, &tile_index, &tag) == RLH_RESULT_OK);
+  CHECK(found && tile_index == 1 && tag == 9);
+  CHECK(rlhTermPick(term, 3 * TEST_TILE_SIZE, 2 * TEST_TILE_SIZE, &found, &tile_index, NULL) == RLH_RESULT_OK);
+  CHECK(found && tile_index == 2);
+  CHECK(rlhTermPick(term, 5 * TEST_TILE_SIZE, 0, &found, NULL, NULL) == RLH_RESULT_OK);
+  CHECK(!found);
+  // Until the next push, the tiles that were drawn can still be picked.
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(rlhTermPick(term, 3 * TEST_TILE_SIZE, 2 * TEST_TILE_SIZE, &found, &tile_index, &tag) == RLH_RESULT_OK);
+  CHECK(found && tile_index == 2 && tag == 9);
+  CHECK(rlhTermSetPickTag(term, 1) == RLH_RESULT_OK);
+  CHECK(rlhTermPushGrid8(term, 0, 0, 'd', white, black) == RLH_RESULT_OK);
+  CHECK(rlhTermPick(term, 3 * TEST_TILE_SIZE, 2 * TEST_TILE_SIZE, &found, NULL, NULL) == RLH_RESULT_OK);
+  CHECK(!found);
+  CHECK(rlhTermPick(term, 0, 0, &found, &tile_index, &tag) == RLH_RESULT_OK);
+  CHECK(found && tile_index == 0 && tag == 1);
+  rlhTermDestroy(term);
+  return EXIT_SUCCESS;
+}
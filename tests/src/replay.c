@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "test.h"
+
+#define REPLAY_PATH "rlh_test_replay.rlhrec"
+#define REPLAY_FRAME_COUNT 2
+
+int main(void)
+{
+  const rlhColor8_s white = {255, 255, 255, 255};
+  const rlhColor8_s black = {0, 0, 0, 255};
+  const rlhColor8_s green = {0, 255, 0, 255};
+  rlhTermCreateInfo_t term_info;
+  rlhTermSizeInfo_t size_info;
+  rlhAtlasCreateInfo_t atlas_info;
+  test_term_info(&term_info, &size_info, &atlas_info, 10, 4);
+  term_info.record_path = REPLAY_PATH;
+  rlhTerm_h term = NULL;
+  CHECK(rlhTermCreate(&term_info, &term) == RLH_RESULT_OK);
+  // Remember the tiles of every recorded frame, to compare them to the replayed ones.
+  rlhVertex_s *frames[REPLAY_FRAME_COUNT];
+  size_t frame_tile_counts[REPLAY_FRAME_COUNT];
+  for (int frame = 0; frame < REPLAY_FRAME_COUNT; frame++)
+  {
+    CHECK(rlhTermPushGrid8(term, frame, 1, 'a' + frame, white, black) == RLH_RESULT_OK);
+    CHECK(rlhTermPushFreeSized8(term, 3, 5 + frame, 12, 6, 'z', green, white) == RLH_RESULT_OK);
+    CHECK(test_draw(term) == RLH_RESULT_OK);
+    frame_tile_counts[frame] = test_tile_count;
+    frames[frame] = test_vertices;
+    test_vertices = NULL;
+  }
+  CHECK(rlhTermStopRecording(term) == RLH_RESULT_OK);
+  rlhTermDestroy(term);
+  rlhReplay_h replay = NULL;
+  CHECK(rlhReplayOpen(REPLAY_PATH, NULL, &replay) == RLH_RESULT_OK);
+  // The size and atlas come from the recording.
+  term_info.record_path = NULL;
+  term_info.size_info = NULL;
+  term_info.atlas_info = NULL;
+  CHECK(rlhReplayCreateTerm(replay, &term_info, &term) == RLH_RESULT_OK);
+  rlhbool_t has_frame = RLH_FALSE;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    for (int frame = 0; frame < REPLAY_FRAME_COUNT; frame++)
+    {
+      CHECK(rlhReplayNextFrame(replay, term, &has_frame) == RLH_RESULT_OK);
+      CHECK(has_frame);
+      CHECK(test_draw(term) == RLH_RESULT_OK);
+      CHECK(test_tile_count == frame_tile_counts[frame]);
+      CHECK(memcmp(test_vertices, frames[frame], test_tile_count * 4 * sizeof(rlhVertex_s)) == 0);
+    }
+    CHECK(rlhReplayNextFrame(replay, term, &has_frame) == RLH_RESULT_OK);
+    CHECK(!has_frame);
+    CHECK(rlhReplayRewind(replay, term) == RLH_RESULT_OK);
+  }
+  rlhTermDestroy(term);
+  rlhReplayClose(replay);
+  for (int frame = 0; frame < REPLAY_FRAME_COUNT; frame++)
+  {
+    free(frames[frame]);
+  }
+  remove(REPLAY_PATH);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "test.h"
+
+int main(void)
+{
+  rlhTerm_h term = NULL;
+  CHECK(test_create_term(10, 4, &term) == RLH_RESULT_OK);
+  const rlhColor8_s white = {255, 255, 255, 255};
+  const rlhColor8_s black = {0, 0, 0, 255};
+  rlhScrollbackCreateInfo_t scrollback_info;
+  memset(&scrollback_info, 0, sizeof(scrollback_info));
+  scrollback_info.line_width = 5;
+  scrollback_info.line_capacity = 3;
+  rlhScrollback_h scrollback = NULL;
+  CHECK(rlhScrollbackCreate(&scrollback_info, &scrollback) == RLH_RESULT_OK);
+  CHECK(rlhScrollbackAdd(scrollback, "one", white, black) == RLH_RESULT_OK);
+  CHECK(rlhScrollbackAdd(scrollback, "two", white, black) == RLH_RESULT_OK);
+  // This message wraps onto two lines, which pushes the oldest line out of the scrollback.
+  CHECK(rlhScrollbackAdd(scrollback, "three four", white, black) == RLH_RESULT_OK);
+  size_t line_count = 0;
+  CHECK(rlhScrollbackGetLineCount(scrollback, &line_count) == RLH_RESULT_OK);
+  CHECK(line_count == 3);
+  // The newest line is on the bottom row.
+  CHECK(rlhTermPushScrollback(term, scrollback, 2, 1, 2, 0) == RLH_RESULT_OK);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_glyph_at(term, 2, 1) == 't');
+  CHECK(test_glyph_at(term, 3, 1) == 'h');
+  CHECK(test_glyph_at(term, 2, 2) == 'f');
+  // Scrolling shows older lines, and stops once the oldest line is on the top row.
+  CHECK(rlhTermPushScrollback(term, scrollback, 2, 1, 2, 1) == RLH_RESULT_OK);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_glyph_at(term, 3, 1) == 'w');
+  CHECK(test_glyph_at(term, 3, 2) == 'h');
+  CHECK(rlhTermPushScrollback(term, scrollback, 2, 1, 2, 100) == RLH_RESULT_OK);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_glyph_at(term, 3, 1) == 'w');
+  CHECK(rlhScrollbackClear(scrollback) == RLH_RESULT_OK);
+  CHECK(rlhScrollbackGetLineCount(scrollback, &line_count) == RLH_RESULT_OK);
+  CHECK(line_count == 0);
+  rlhScrollbackDestroy(scrollback);
+  rlhTermDestroy(term);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Shared by the C tests. Terminals use a copy of the null backend that keeps the vertex data of the
+// last upload, so a test can check the tiles that were pushed after it draws. The glyph_stpqp of the
+// atlas has the glyph index in s, so the first vertex of a tile tells its glyph.
+
+#ifndef RLH_TEST_H
+#define RLH_TEST_H
+
+#define RLH_NO_OPENGL
+#define RLH_IMPLEMENTATION
+#include <rlh/roguelike.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(condition)                                             \
+  if (!(condition))                                                  \
+  {                                                                  \
+    fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+    return EXIT_FAILURE;                                             \
+  }
+
+#define TEST_TILE_SIZE 8
+#define TEST_GLYPH_COUNT 256
+
+static rlhBackend_t test_backend;
+static rlhVertex_s *test_vertices = NULL;
+static size_t test_tile_count = 0;
+static float test_stpqp[TEST_GLYPH_COUNT * 5];
+static const uint8_t test_pixels[16 * 16 * 4] = {0};
+
+static inline rlhresult_t test_upload_vertices(void *backend_data, const rlhVertex_s *vertex_data, size_t vertex_data_size)
+{
+  free(test_vertices);
+  test_vertices = (rlhVertex_s *)malloc(vertex_data_size > 0 ? vertex_data_size : 1);
+  if (test_vertices == NULL)
+  {
+    return RLH_RESULT_ERROR_OUT_OF_MEMORY;
+  }
+  memcpy(test_vertices, vertex_data, vertex_data_size);
+  test_tile_count = vertex_data_size / (sizeof(rlhVertex_s) * 4);
+  return RLH_BACKEND_NULL.upload_vertices(backend_data, vertex_data, vertex_data_size);
+}
+
+// Fill term_info with a terminal of tiles_wide by tiles_tall cells on the test backend.
+static inline void test_term_info(rlhTermCreateInfo_t *term_info, rlhTermSizeInfo_t *size_info, rlhAtlasCreateInfo_t *atlas_info,
+                           const int tiles_wide, const int tiles_tall)
+{
+  for (int glyph = 0; glyph < TEST_GLYPH_COUNT; glyph++)
+  {
+    float *const stpqp = test_stpqp + glyph * 5;
+    stpqp[0] = (float)glyph;
+    stpqp[1] = (float)glyph + 1.0f;
+    stpqp[2] = 0.0f;
+    stpqp[3] = 1.0f;
+    stpqp[4] = 0.0f;
+  }
+  test_backend = RLH_BACKEND_NULL;
+  test_backend.upload_vertices = test_upload_vertices;
+  memset(atlas_info, 0, sizeof(rlhAtlasCreateInfo_t));
+  atlas_info->width = 16;
+  atlas_info->height = 16;
+  atlas_info->pages = 1;
+  atlas_info->channel_size = 1;
+  atlas_info->color = RLH_COLOR_RGBA;
+  atlas_info->pixel_data = test_pixels;
+  atlas_info->glyph_count = TEST_GLYPH_COUNT;
+  atlas_info->glyph_stpqp = test_stpqp;
+  memset(size_info, 0, sizeof(rlhTermSizeInfo_t));
+  size_info->width = tiles_wide;
+  size_info->height = tiles_tall;
+  size_info->size_mode = RLH_SIZE_TILES;
+  size_info->pixel_scale = 1;
+  size_info->tile_width = TEST_TILE_SIZE;
+  size_info->tile_height = TEST_TILE_SIZE;
+  memset(term_info, 0, sizeof(rlhTermCreateInfo_t));
+  term_info->size_info = size_info;
+  term_info->atlas_info = atlas_info;
+  term_info->backend = &test_backend;
+}
+
+// Create a terminal of tiles_wide by tiles_tall cells on the test backend.
+static inline rlhresult_t test_create_term(const int tiles_wide, const int tiles_tall, rlhTerm_h *term)
+{
+  rlhTermCreateInfo_t term_info;
+  rlhTermSizeInfo_t size_info;
+  rlhAtlasCreateInfo_t atlas_info;
+  test_term_info(&term_info, &size_info, &atlas_info, tiles_wide, tiles_tall);
+  return rlhTermCreate(&term_info, term);
+}
+
+// Draw a terminal, which uploads the tiles pushed since the last draw to the test backend.
+static inline rlhresult_t test_draw(rlhTerm_h term)
+{
+  test_tile_count = 0;
+  return rlhTermDraw(term);
+}
+
+// Get the index of the last uploaded tile whose top left corner is in a grid cell, or -1 if there
+// is none.
+static inline int test_find_tile(rlhTerm_h term, const int grid_x, const int grid_y)
+{
+  int tile_width, tile_height;
+  rlhTermGetTileSize(term, &tile_width, &tile_height);
+  int pixel_width, pixel_height;
+  rlhTermGetUnscaledPixelSize(term, &pixel_width, &pixel_height);
+  for (int tile = (int)test_tile_count - 1; tile >= 0; tile--)
+  {
+    const rlhVertex_s *const vertex = &test_vertices[tile * 4];
+    const int x = (int)(vertex->x * (float)pixel_width + 0.5f) / tile_width;
+    const int y = (int)(vertex->y * (float)pixel_height + 0.5f) / tile_height;
+    if (x == grid_x && y == grid_y)
+    {
+      return tile;
+    }
+  }
+  return -1;
+}
+
+// Get the glyph of the last uploaded tile in a grid cell, or -1 if there is none.
+static inline int test_glyph_at(rlhTerm_h term, const int grid_x, const int grid_y)
+{
+  const int tile = test_find_tile(term, grid_x, grid_y);
+  return tile < 0 ? -1 : (int)test_vertices[tile * 4].s;
+}
+
+static inline rlhbool_t test_color_equals(const rlhColor8_s a, const rlhColor8_s b)
+{
+  return (rlhbool_t)(a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a);
+}
+
+#endif
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2021-2023 Daniel Aimé Valcour <fosssweeper@gmail.com>
+//
+// SPDX-License-Identifier: MIT
+
+/*
+    Copyright (c) 2021-2023  Daniel Aimé Valcour
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "test.h"
+
+int main(void)
+{
+  rlhTerm_h term = NULL;
+  CHECK(test_create_term(10, 4, &term) == RLH_RESULT_OK);
+  const rlhColor8_s white = {255, 255, 255, 255};
+  const rlhColor8_s black = {0, 0, 0, 255};
+  const rlhColor8_s red = {255, 0, 0, 255};
+  rlhTextInfo_t text_info;
+  memset(&text_info, 0, sizeof(text_info));
+  text_info.grid_x = 1;
+  text_info.grid_y = 1;
+  text_info.grid_width = 5;
+  text_info.grid_height = 3;
+  text_info.wrap = RLH_TRUE;
+  text_info.fg = white;
+  text_info.bg = black;
+  // The second word does not fit on the first line, so it wraps to the next one.
+  CHECK(rlhTermPushText(term, &text_info, "ab {fg=FF0000}cde{/}") == RLH_RESULT_OK);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_glyph_at(term, 1, 1) == 'a');
+  CHECK(test_glyph_at(term, 2, 1) == 'b');
+  CHECK(test_glyph_at(term, 1, 2) == 'c');
+  CHECK(test_glyph_at(term, 3, 2) == 'e');
+  CHECK(test_color_equals(test_vertices[test_find_tile(term, 1, 1) * 4].fg, white));
+  CHECK(test_color_equals(test_vertices[test_find_tile(term, 1, 2) * 4].fg, red));
+  CHECK(test_color_equals(test_vertices[test_find_tile(term, 1, 2) * 4].bg, black));
+  // Lines are aligned inside of the rectangle.
+  text_info.wrap = RLH_FALSE;
+  text_info.grid_height = 1;
+  text_info.halign = RLH_HALIGN_RIGHT;
+  CHECK(rlhTermPushText(term, &text_info, "xy") == RLH_RESULT_OK);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_glyph_at(term, 4, 1) == 'x');
+  CHECK(test_glyph_at(term, 5, 1) == 'y');
+  // Pushing the same text again reuses its layout.
+  CHECK(rlhTermResetStats(term) == RLH_RESULT_OK);
+  CHECK(rlhTermPushText(term, &text_info, "xy") == RLH_RESULT_OK);
+  rlhTermStats_t stats;
+  CHECK(rlhTermGetStats(term, &stats) == RLH_RESULT_OK);
+  CHECK(stats.text_cache_hits == 1);
+  CHECK(test_draw(term) == RLH_RESULT_OK);
+  CHECK(test_glyph_at(term, 4, 1) == 'x');
+  // Markup that is not closed is not valid.
+  CHECK(rlhTermPushText(term, &text_info, "{fg=FF") == RLH_RESULT_ERROR_INVALID_VALUE);
+  rlhTermDestroy(term);
+  return EXIT_SUCCESS;
+}